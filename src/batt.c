@@ -0,0 +1,79 @@
+/**
+ * @file batt.c
+ * @brief Supply recovery detection (see batt.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "batt.h"
+
+#include "hal.h"
+
+#if BATT_SAMPLE_MIN
+
+/* ---------------- Defines ---------------- */
+#if BATT_LOW_MV < 2200u || BATT_RECOVER_MV <= BATT_LOW_MV || BATT_RECOVER_MV > 3000u
+#error "BATT thresholds must satisfy 2200 <= BATT_LOW_MV < BATT_RECOVER_MV <= 3000"
+#endif
+
+/* The average is kept as 4 x code (a 4-sample exponential average); a drop of less than
+ * half a code is noise, not a fall */
+#define BATT_LOW_AVG     (4u * BATT_CODE(BATT_LOW_MV))
+#define BATT_RECOVER_AVG (4u * BATT_CODE(BATT_RECOVER_MV))
+#define BATT_NOISE_AVG   (2u)
+
+/* 1.5 V reference settling time (t_REFON, 30 us) at the 1 MHz DCO */
+#define BATT_REF_CYCLES  (30u)
+
+/* ---------------- Variables ---------------- */
+uint8_t         batt_low;
+
+static uint16_t batt_avg;    /* 4 x code, 0 before the first sample */
+static uint8_t  batt_rising; /* samples in a row without a fall */
+
+/* ---------------- Functions ---------------- */
+
+/**
+ * - The VCC/2 divider is high impedance: 64 ADC10CLK of sample time at ADC10OSC / 4 (~50 us).
+ */
+uint16_t batt_sample(void) {
+    uint16_t code;
+
+    ADC10CTL1 = INCH_11 | ADC10DIV_3;                  /* VCC / 2, ADC10OSC / 4 */
+    ADC10CTL0 = SREF_1 | ADC10SHT_3 | REFON | ADC10ON; /* 1.5 V reference */
+    __delay_cycles(BATT_REF_CYCLES);
+    ADC10CTL0 |= ENC | ADC10SC;
+    while (ADC10CTL1 & ADC10BUSY) {
+    }
+    code = ADC10MEM;
+    ADC10CTL0 &= ~ENC;
+    ADC10CTL0  = 0; /* ADC and reference off */
+    return code;
+}
+
+uint8_t batt_update(uint16_t code) {
+    uint16_t prev = batt_avg;
+
+    if (!prev) {
+        batt_avg = code << 2;
+        batt_low = batt_avg < BATT_RECOVER_AVG;
+        return 0;
+    }
+    batt_avg = batt_avg - (batt_avg >> 2) + code;
+    if (batt_avg + BATT_NOISE_AVG < prev) {
+        batt_rising = 0;
+    } else if (batt_rising < 0xFFu) {
+        batt_rising++;
+    }
+
+    if (!batt_low) {
+        batt_low = batt_avg < BATT_LOW_AVG;
+        return 0;
+    }
+    if (batt_avg >= BATT_RECOVER_AVG && batt_rising >= BATT_RISE_SAMPLES) {
+        batt_low = 0;
+        return 1;
+    }
+    return 0;
+}
+
+#endif /* BATT_SAMPLE_MIN */
@@ -0,0 +1,46 @@
+/**
+ * @file batt.h
+ * @brief Supply recovery detection from the ADC10 VCC/2 channel.
+ *
+ * A node that browned out with the shared battery often stays off the mesh once the battery
+ * has charged again; the press that brings it back is best made soon after the recovery.
+ * Every @ref BATT_SAMPLE_MIN minutes VCC/2 is converted against the 1.5 V reference (on for
+ * ~0.1 ms, as for tempcomp.h) and run through a short moving average. The supply counts as
+ * discharged below @ref BATT_LOW_MV and as recovered at or above @ref BATT_RECOVER_MV, once it
+ * has not fallen for @ref BATT_RISE_SAMPLES samples in a row: the jump of a battery whose load
+ * just dropped out relaxes again and is not taken for a charge.
+ *
+ * The 1.5 V reference reads VCC up to 3.0 V; anything above reads as 3.0 V. The ADC10 is
+ * specified from 2.2 V, so thresholds below that are rejected at build time.
+ */
+
+#ifndef BATT_H
+#define BATT_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+/** ADC10 code of VCC/2 against the 1.5 V reference for @p mv millivolts of VCC, rounded. */
+#define BATT_CODE(mv) ((uint16_t)(((mv) * 1023UL + 1500u) / 3000u))
+
+/** 1 while the supply counts as discharged. */
+extern uint8_t batt_low;
+
+/**
+ * @brief Convert VCC/2 once.
+ * - Powers the ADC10 and its reference up, converts in active mode, and powers both down.
+ * @return ADC10 code (INCH_11, 1.5 V reference)
+ */
+uint16_t batt_sample(void);
+
+/**
+ * @brief Run a sample through the filter and the hysteresis.
+ * - The first sample after boot sets the filter; a supply below @ref BATT_RECOVER_MV at boot
+ *   counts as discharged (the MCU may itself have come back from a brown-out).
+ * @param code ADC10 code from batt_sample()
+ * @return 1 on the sample that finds the supply recovered, 0 otherwise
+ */
+uint8_t batt_update(uint16_t code);
+
+#endif /* BATT_H */
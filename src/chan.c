@@ -0,0 +1,129 @@
+/**
+ * @file chan.c
+ * @brief Pulse channels (see chan.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "chan.h"
+
+#include "gesture.h"
+#include "hal.h"
+#include "sched.h"
+#include "timebase.h"
+
+/* ---------------- Defines ---------------- */
+/* Interval in nominal counts; the base interval keeps the whole ticks of the fixed tick mode */
+#define CHAN_COUNTS(min)                                                                          \
+    ((min) == PULSE_INTERVAL_MIN ? TB_INTERVAL_COUNTS : TB_SECONDS((min) * 60UL))
+
+#define CHAN_CFG(pin, min, phase, pattern)                                                        \
+    {CHAN_COUNTS(min), TB_SECONDS((phase) * 60UL), (pattern), (pin)},
+
+/* Checks of the list */
+#define CHAN_BAD_TIME(pin, min, phase, pattern)    || (min) < 1 || (min) > PULSE_INTERVAL_MIN     \
+                                                   || (phase) < 0 || (phase) >= (min)
+#define CHAN_BAD_PATTERN(pin, min, phase, pattern)                                                \
+    || ((pattern) <= 0xFF && !((pattern) & 1)) || (pattern) >= GESTURE(GESTURE_COUNT)
+
+#if CHAN_COUNT < 1
+#error "PULSE_CHANNELS lists no channel"
+#endif
+#if 0 PULSE_CHANNELS(CHAN_BAD_TIME)
+#error "PULSE_CHANNELS intervals must be 1..PULSE_INTERVAL_MIN minutes, phases below them"
+#endif
+#if 0 PULSE_CHANNELS(CHAN_BAD_PATTERN)
+#error "PULSE_CHANNELS patterns must fit a byte and start with a LOW slot (bit 0), or be a GESTURE"
+#endif
+#if CHAN_COUNT > 127
+#error "PULSE_CHANNELS lists more than 127 channels"
+#endif
+#if PULSE_OUT == PULSE_OUT_GPIO
+#if (0 PULSE_CHANNELS(CHAN_PIN_ADD)) != CHAN_PINS
+#error "PULSE_CHANNELS has two channels on one pin"
+#endif
+#else
+/* Lines 0..63 as two 32 bit masks (#if arithmetic is at least 64 bits wide) */
+#define CHAN_BAD_LINE(pin, min, phase, pattern) || (pin) < 0 || (pin) >= EXP_COUNT * 8
+#define CHAN_LO_OR(pin, min, phase, pattern)    | (((pin) < 32) << ((pin) & 31))
+#define CHAN_LO_ADD(pin, min, phase, pattern)   + (((pin) < 32) << ((pin) & 31))
+#define CHAN_HI_OR(pin, min, phase, pattern)    | (((pin) >= 32) << ((pin) & 31))
+#define CHAN_HI_ADD(pin, min, phase, pattern)   + (((pin) >= 32) << ((pin) & 31))
+#if EXP_COUNT < 1 || EXP_COUNT > 8
+#error "EXP_COUNT must be 1..8"
+#endif
+#if 0 PULSE_CHANNELS(CHAN_BAD_LINE)
+#error "PULSE_CHANNELS lines must be 0..EXP_COUNT * 8 - 1 with an expander"
+#endif
+#if (0 PULSE_CHANNELS(CHAN_LO_ADD)) != (0 PULSE_CHANNELS(CHAN_LO_OR))                          \
+        || (0 PULSE_CHANNELS(CHAN_HI_ADD)) != (0 PULSE_CHANNELS(CHAN_HI_OR))
+#error "PULSE_CHANNELS has two channels on one line"
+#endif
+#endif
+
+/* ---------------- Variables ---------------- */
+const chan_cfg_t    chan_cfg[CHAN_COUNT] = {PULSE_CHANNELS(CHAN_CFG)};
+static uint32_t     chan_next[CHAN_COUNT]; /* deadline per channel, nominal counts */
+static uint8_t      chan_heap[CHAN_COUNT]; /* channels; each deadline not before its parent's */
+
+/* ---------------- Functions ---------------- */
+
+/** Heap order: earlier deadline first, then lower index. */
+static int chan_before(uint8_t a, uint8_t b) {
+    return chan_next[a] == chan_next[b] ? a < b : SCHED_BEFORE(chan_next[a], chan_next[b]);
+}
+
+/** Move the channel at heap position @p i down below its earlier children. */
+static void chan_sift(unsigned int i) {
+    uint8_t      c = chan_heap[i];
+    unsigned int k;
+
+    while ((k = 2u * i + 1u) < CHAN_COUNT) {
+        if (k + 1u < CHAN_COUNT && chan_before(chan_heap[k + 1u], chan_heap[k])) {
+            k++;
+        }
+        if (!chan_before(chan_heap[k], c)) {
+            break;
+        }
+        chan_heap[i] = chan_heap[k];
+        i            = k;
+    }
+    chan_heap[i] = c;
+}
+
+/** Order the whole heap. */
+static void chan_heapify(void) {
+    unsigned int i;
+    for (i = CHAN_COUNT / 2u; i-- > 0;) {
+        chan_sift(i);
+    }
+}
+
+void chan_init(void) {
+    unsigned int c;
+    for (c = 0; c < CHAN_COUNT; c++) {
+        chan_next[c] = chan_cfg[c].phase + chan_cfg[c].wait;
+        chan_heap[c] = (uint8_t)c;
+    }
+    chan_heapify();
+}
+
+void chan_resume(uint8_t c, uint32_t due) {
+    chan_next[c] = due;
+    chan_heapify();
+}
+
+uint8_t chan_first(void) {
+    return chan_heap[0];
+}
+
+uint32_t chan_due(uint8_t c) {
+    return chan_next[c];
+}
+
+/**
+ * - An earlier deadline keeps the channel first; a later one sifts it down the heap.
+ */
+void chan_set_first(uint32_t due) {
+    chan_next[chan_heap[0]] = due;
+    chan_sift(0);
+}
@@ -0,0 +1,80 @@
+/**
+ * @file chan.h
+ * @brief Pulse channels: one node button each, with its own pin, interval, phase and pattern.
+ *
+ * The channels are listed in @ref PULSE_CHANNELS. Each keeps its next deadline in nominal timer
+ * counts (the counts of a VLO at exactly ACLK_VLO_HZ, see main.c), so the deadlines do not move
+ * when the VLO estimate changes. chan_first() gives the earliest one: all channels share the
+ * one scheduler slot, and a single timer wake source, for their pulses. The channels are kept
+ * in a binary heap on their deadlines, so that costs O(1), and moving a deadline O(log n), for
+ * racks of dozens of channels (@ref PULSE_OUT).
+ *
+ * A pattern is a byte of @ref PULSE_MS slots, the first in bit 0: a set bit holds the pin LOW
+ * for that slot. 0x01 is a single press, 0x05 a double press, 0x0F one press four slots long.
+ * Or it is @ref GESTURE (n), a list of press and release durations (gesture.h).
+ *
+ * The pin is a P1 pin bit with @ref PULSE_OUT_GPIO, else the expander line (see out.h).
+ *
+ * RAM is 5 bytes per channel, its deadline and heap entry; the table itself is in flash.
+ */
+
+#ifndef CHAN_H
+#define CHAN_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+/* Expansions of the PULSE_CHANNELS list */
+#define CHAN_ONE(pin, min, phase, pattern)     +1
+#define CHAN_PIN_OR(pin, min, phase, pattern)  | (pin)
+#define CHAN_PIN_ADD(pin, min, phase, pattern) +(pin)
+
+/** Number of channels. */
+#define CHAN_COUNT (0 PULSE_CHANNELS(CHAN_ONE))
+
+/** P1 pins of all channels; none with an expander. */
+#if PULSE_OUT == PULSE_OUT_GPIO
+#define CHAN_PINS  (0 PULSE_CHANNELS(CHAN_PIN_OR))
+#else
+#define CHAN_PINS  (0)
+#endif
+
+/** Constant part of a channel. */
+typedef struct {
+    uint32_t wait;    /* interval, nominal counts */
+    uint32_t phase;   /* offset of the first deadline, nominal counts */
+    uint16_t pattern; /* PULSE_MS slots, first in bit 0, a set bit drives the pin LOW; GESTURE(n) */
+    uint8_t  pin;     /* P1 pin bit, or expander line */
+} chan_cfg_t;
+
+/** The channels of @ref PULSE_CHANNELS, in that order. */
+extern const chan_cfg_t chan_cfg[CHAN_COUNT];
+
+/**
+ * @brief First deadline of every channel: phase plus one interval after nominal time 0.
+ */
+void chan_init(void);
+
+/**
+ * @brief Set the deadline of channel @p c to @p due, e.g. from a checkpoint at boot (ckpt.h).
+ * - Rebuilds the heap: O(n) per call.
+ */
+void chan_resume(uint8_t c, uint32_t due);
+
+/**
+ * @brief Channel with the earliest deadline; the lowest index among equal ones.
+ */
+uint8_t chan_first(void);
+
+/**
+ * @brief Deadline of channel @p c, nominal counts (wraps; compare with @ref SCHED_BEFORE).
+ */
+uint32_t chan_due(uint8_t c);
+
+/**
+ * @brief Move the deadline of the chan_first() channel to @p due, earlier or later.
+ */
+void chan_set_first(uint32_t due);
+
+#endif /* CHAN_H */
@@ -0,0 +1,124 @@
+/**
+ * @file ckpt.c
+ * @brief Schedule checkpoints in .noinit RAM and Info flash (see ckpt.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "ckpt.h"
+
+#include "flash.h"
+#include "hal.h"
+
+#if CKPT_MIN
+
+/* ---------------- Defines ---------------- */
+#if CKPT_WORDS * 2u > FLASH_SEG_SIZE
+#error "CKPT_MIN keeps at most 30 channels: a record must fit an Info segment"
+#endif
+#if CKPT_MIN < 1 || CKPT_FLASH_MIN < 1 || CKPT_FLASH_N > 255
+#error "CKPT_MIN and CKPT_FLASH_MIN must be at least 1, at most 255 checkpoints per flash write"
+#endif
+/* Each segment is erased once per 2 * CKPT_SLOTS flash writes; 10^4 erases (the datasheet
+ * minimum) must last ten years */
+#if 10000ULL * 2u * CKPT_SLOTS * CKPT_FLASH_N * CKPT_MIN < 3652ULL * 1440u
+#error "CKPT_FLASH_MIN wears Info segments B and C out within ten years; raise it"
+#endif
+
+/* The two segments in the order they are filled */
+#define CKPT_SEG(i)  ((i) ? FLASH_INFO_B : FLASH_INFO_C)
+#define CKPT_REC(a)  ((const uint16_t *)HAL_FLASH_PTR(a))
+
+/* ---------------- Variables ---------------- */
+/* Last record taken; kept over a reset as long as the RAM keeps its contents */
+static HAL_NOINIT uint16_t ckpt_ram[CKPT_WORDS];
+static uint16_t ckpt_next; /* flash slot of the next record; at a segment start: erase first */
+
+/* ---------------- Functions ---------------- */
+
+/** Flash slot after the one at @p a: the next one in its segment, or the start of the other. */
+static uint16_t ckpt_after(uint16_t a) {
+    uint16_t seg = a < CKPT_SEG(1) ? CKPT_SEG(0) : CKPT_SEG(1);
+
+    a += CKPT_WORDS * 2u;
+    if ((uint16_t)(a - seg) > FLASH_SEG_SIZE - CKPT_WORDS * 2u) {
+        a = seg == CKPT_SEG(0) ? CKPT_SEG(1) : CKPT_SEG(0);
+    }
+    return a;
+}
+
+/** Record @p r holds a checkpoint: its CRC matches, and it is not blank. */
+static uint8_t ckpt_valid(const uint16_t *r) {
+    return r[0] != 0xFFFFu && r[CKPT_WORDS - 1u] == flash_crc(r, CKPT_WORDS - 1u);
+}
+
+/**
+ * - Scans both segments; of the valid flash records the one with the newest sequence number
+ *   (wrapping) wins, and the next slot after it is where the next record goes.
+ * - The RAM record is taken over the flash one unless it is older.
+ */
+uint8_t ckpt_load(void) {
+    const uint16_t *best = 0;
+    uint16_t        a;
+    uint8_t         s, k, i;
+
+    ckpt_next = CKPT_SEG(0);
+    for (s = 0; s < 2u; s++) {
+        for (k = 0; k < CKPT_SLOTS; k++) {
+            a = CKPT_SEG(s) + k * CKPT_WORDS * 2u;
+            if (ckpt_valid(CKPT_REC(a)) && (!best || (int16_t)(CKPT_REC(a)[0] - best[0]) > 0)) {
+                best      = CKPT_REC(a);
+                ckpt_next = ckpt_after(a);
+            }
+        }
+    }
+    if (ckpt_valid(ckpt_ram) && (!best || (int16_t)(ckpt_ram[0] - best[0]) >= 0)) {
+        return 1;
+    }
+    if (!best) {
+        ckpt_ram[0] = 0;
+        return 0;
+    }
+    for (i = 0; i < CKPT_WORDS; i++) {
+        ckpt_ram[i] = best[i];
+    }
+    return 1;
+}
+
+uint16_t ckpt_left(uint8_t c) {
+    return ckpt_ram[1u + c];
+}
+
+void ckpt_set(uint8_t c, uint16_t left) {
+    ckpt_ram[1u + c] = left;
+}
+
+/**
+ * - A slot that is not blank (a write torn by a power loss) is passed over; the end of a
+ *   segment moves on to the other one, erased first.
+ */
+void ckpt_save(uint8_t flash) {
+    const uint16_t *r;
+    uint8_t         i;
+
+    ckpt_ram[0]              = ckpt_ram[0] == 0xFFFEu ? 0u : ckpt_ram[0] + 1u; /* never blank */
+    ckpt_ram[CKPT_WORDS - 1u] = flash_crc(ckpt_ram, CKPT_WORDS - 1u);
+    if (!flash) {
+        return;
+    }
+    for (;;) {
+        if (ckpt_next == CKPT_SEG(0) || ckpt_next == CKPT_SEG(1)) {
+            flash_erase(ckpt_next);
+        }
+        r = CKPT_REC(ckpt_next);
+        for (i = 0; i < CKPT_WORDS && r[i] == 0xFFFFu; i++) {
+        }
+        if (i == CKPT_WORDS) {
+            break;
+        }
+        ckpt_next = ckpt_after(ckpt_next); /* torn */
+    }
+    flash_write(ckpt_next, ckpt_ram, CKPT_WORDS);
+    ckpt_next = ckpt_after(ckpt_next);
+}
+
+#endif /* CKPT_MIN */
@@ -0,0 +1,68 @@
+/**
+ * @file ckpt.h
+ * @brief Schedule checkpoints that survive resets and power losses.
+ *
+ * Time starts at 0 on every reset, and with it every channel's interval: a watcher that browns
+ * out on a weak solar supply more often than it pulses never pulses at all. A checkpoint keeps
+ * the time left to each channel's deadline. It is taken into a record in RAM that the startup
+ * code leaves alone (@ref HAL_NOINIT) every @ref CKPT_MIN minutes and after every pulse, and
+ * goes to Info flash every @ref CKPT_FLASH_MIN minutes. At boot the newer of a surviving RAM
+ * record (a reset without a power loss) and the newest flash record resumes the schedule; the
+ * time the MCU was off is lost.
+ *
+ * Flash records are written one after the other through segment C, then B, then C again
+ * (wear-leveling); the segment moved to is erased first, so the newest record in the other one
+ * survives a power loss during the erase. Each record carries a sequence number and a CRC-16,
+ * so a torn write only loses that record. Segment D holds the temperature table (tempcomp.h).
+ */
+
+#ifndef CKPT_H
+#define CKPT_H
+
+#include <stdint.h>
+
+#include "chan.h"
+#include "config.h"
+#include "flash.h"
+#include "timebase.h"
+
+/** Words of a record: sequence number, a time per channel, CRC. */
+#define CKPT_WORDS   (CHAN_COUNT + 2u)
+
+/** Records per flash segment. */
+#define CKPT_SLOTS   (FLASH_SEG_SIZE / (CKPT_WORDS * 2u))
+
+/** Checkpoints per flash write. */
+#define CKPT_FLASH_N ((CKPT_FLASH_MIN + CKPT_MIN - 1) / CKPT_MIN)
+
+/* Time left in units of 2^CKPT_SHIFT nominal counts, so that a full interval plus its phase
+ * fits 16 bits (1.4 s with the 12 h default) */
+#define CKPT_FITS(s) ((2ULL * TB_INTERVAL_COUNTS) >> (s) <= 0xFFFFULL)
+#define CKPT_SHIFT                                                                                \
+    (CKPT_FITS(0) ? 0 : CKPT_FITS(2) ? 2 : CKPT_FITS(4) ? 4 : CKPT_FITS(6) ? 6                     \
+     : CKPT_FITS(8) ? 8 : CKPT_FITS(10) ? 10 : CKPT_FITS(12) ? 12 : CKPT_FITS(14) ? 14 : 16)
+
+/**
+ * @brief Find the newest valid record, in RAM or flash, and the next free flash slot.
+ * @return 1 if there is one (ckpt_left() then gives its times), 0 after a first power-up
+ */
+uint8_t ckpt_load(void);
+
+/**
+ * @brief Time left to channel @p c's deadline in the record, 2^CKPT_SHIFT nominal counts.
+ */
+uint16_t ckpt_left(uint8_t c);
+
+/**
+ * @brief Set channel @p c's time left in the RAM record; the record reads invalid until
+ *        ckpt_save().
+ */
+void ckpt_set(uint8_t c, uint16_t left);
+
+/**
+ * @brief Seal the RAM record with the next sequence number and its CRC.
+ * @param flash 1 to write it to the next flash slot as well
+ */
+void ckpt_save(uint8_t flash);
+
+#endif /* CKPT_H */
@@ -0,0 +1,137 @@
+/**
+ * @file conf.c
+ * @brief Run-time settings (see conf.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "conf.h"
+
+#if CONF_USED
+
+#include "chan.h"
+#include "fixed.h"
+#include "flash.h"
+#include "hal.h"
+#include "timebase.h"
+
+/* ---------------- Defines ---------------- */
+#define CONF_TABLE ((const struct conf_block *)HAL_FLASH_PTR(CONF_BLOCK_ADDR))
+
+/* Nominal counts of a pattern slot of ms milliseconds, as conf_slot() */
+#define CONF_SLOT_COUNTS(ms) (((ms) * ACLK_VLO_HZ + 500L * TB_DIV) / (1000L * TB_DIV))
+
+#if STRAP_INTERVAL_BIT
+#if !CONF_INTERVAL
+#error "STRAP_INTERVAL_BIT needs a fixed interval: no SENSE_TIMEOUT_MIN, ADAPT_MIN_MIN, EVENT_ONLY"
+#endif
+#if STRAP_INTERVAL_GND_MIN < 1 || STRAP_INTERVAL_GND_MIN > PULSE_INTERVAL_MIN                     \
+        || STRAP_INTERVAL_VCC_MIN < 1 || STRAP_INTERVAL_VCC_MIN > PULSE_INTERVAL_MIN
+#error "STRAP_INTERVAL_GND_MIN and STRAP_INTERVAL_VCC_MIN must be 1..PULSE_INTERVAL_MIN"
+#endif
+#endif
+#if STRAP_WIDTH_BIT
+#if STRAP_WIDTH_GND_MS > 60000 || CONF_SLOT_COUNTS(STRAP_WIDTH_GND_MS) < 2                        \
+        || CONF_SLOT_COUNTS(STRAP_WIDTH_GND_MS) > 0x3FFF || STRAP_WIDTH_VCC_MS > 60000            \
+        || CONF_SLOT_COUNTS(STRAP_WIDTH_VCC_MS) < 2 || CONF_SLOT_COUNTS(STRAP_WIDTH_VCC_MS) > 0x3FFF
+#error "STRAP_WIDTH_GND_MS and STRAP_WIDTH_VCC_MS must be 2 to 0x3FFF timer counts"
+#endif
+#if EVENT_ONLY && (STRAP_WIDTH_GND_MS * 8L >= EVENT_HOLDOFF_S * 1000L                            \
+                   || STRAP_WIDTH_VCC_MS * 8L >= EVENT_HOLDOFF_S * 1000L)
+#error "EVENT_HOLDOFF_S must be longer than 8 slots of STRAP_WIDTH_GND_MS and STRAP_WIDTH_VCC_MS"
+#endif
+#endif
+
+/* ---------------- Variables ---------------- */
+struct conf conf = {TB_INTERVAL_COUNTS, PULSE_INTERVAL_MIN, PULSE_MS, TB_PULSE_TICKS, FX_ONE};
+
+/* ---------------- Functions ---------------- */
+
+/**
+ * - The base interval keeps the whole ticks of the fixed tick mode.
+ */
+uint32_t conf_interval(uint32_t min) {
+    if (min < 1u || min > PULSE_INTERVAL_MIN) {
+        return 0;
+    }
+    return min == PULSE_INTERVAL_MIN ? TB_INTERVAL_COUNTS
+                                     : (min * (60UL * ACLK_VLO_HZ) + TB_DIV / 2u) / TB_DIV;
+}
+
+/**
+ * - Up to 0x3FFF counts: the slot in timer counts (pulse_ticks) fits at 4x the rate.
+ */
+uint16_t conf_slot(uint32_t ms) {
+    uint32_t counts;
+
+    if (ms > 60000u) {
+        return 0;
+    }
+#if EVENT_ONLY
+    if (8u * ms >= EVENT_HOLDOFF_S * 1000UL) {
+        return 0;
+    }
+#endif
+    counts = CONF_SLOT_COUNTS(ms);
+    return counts < 2u || counts > 0x3FFFu ? 0u : (uint16_t)counts;
+}
+
+#if CONF_BLOCK
+/**
+ * - All fields are checked before any is taken.
+ */
+void conf_load(void) {
+    const struct conf_block *b        = CONF_TABLE;
+    uint32_t                 interval = TB_INTERVAL_COUNTS;
+    uint16_t                 slot     = TB_PULSE_TICKS;
+
+    if (b->magic != CONF_MAGIC || b->version != CONF_VERSION || b->pins != CHAN_PINS
+        || b->crc != flash_crc((const uint16_t *)b, CONF_BLOCK_WORDS - 1u)) {
+        return;
+    }
+    if ((b->interval_min && !(interval = conf_interval(b->interval_min)))
+        || (b->slot_ms && !(slot = conf_slot(b->slot_ms)))
+        || (b->vlo_hz && (b->vlo_hz < CONF_VLO_HZ_MIN || b->vlo_hz > CONF_VLO_HZ_MAX))) {
+        return;
+    }
+    conf.interval = interval;
+    if (b->interval_min) {
+        conf.interval_min = b->interval_min;
+    }
+    conf.slot_counts = slot;
+    if (b->slot_ms) {
+        conf.slot_ms = b->slot_ms;
+    }
+    if (b->vlo_hz) {
+        conf.vlo_rate = (uint16_t)((((uint32_t)b->vlo_hz << 14) + ACLK_VLO_HZ / 2u) / ACLK_VLO_HZ);
+    }
+}
+#endif
+
+#if STRAP_P2_BITS
+/**
+ * - The values were checked at build time.
+ */
+void conf_strap(void) {
+    uint8_t  high;
+    uint8_t  tied = strap_read(STRAP_P2_BITS, &high);
+    uint16_t v;
+
+#if STRAP_INTERVAL_BIT
+    if (tied & STRAP_INTERVAL_BIT) {
+        v                 = high & STRAP_INTERVAL_BIT ? STRAP_INTERVAL_VCC_MIN
+                                                      : STRAP_INTERVAL_GND_MIN;
+        conf.interval     = conf_interval(v);
+        conf.interval_min = v;
+    }
+#endif
+#if STRAP_WIDTH_BIT
+    if (tied & STRAP_WIDTH_BIT) {
+        v                = high & STRAP_WIDTH_BIT ? STRAP_WIDTH_VCC_MS : STRAP_WIDTH_GND_MS;
+        conf.slot_counts = conf_slot(v);
+        conf.slot_ms     = v;
+    }
+#endif
+}
+#endif
+
+#endif /* CONF_USED */
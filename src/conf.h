@@ -0,0 +1,106 @@
+/**
+ * @file conf.h
+ * @brief Settings that change without a new build: the site block in Info flash, resistor
+ *        straps, the console.
+ *
+ * With @ref CONF_BLOCK, conf_load() reads a block of 12 bytes at @ref CONF_BLOCK_ADDR, in Info
+ * segment D after the temperature table (tempcomp.h), once at boot: the interval of the channels
+ * at @ref PULSE_INTERVAL_MIN, the pattern slot (@ref PULSE_MS) and the VLO frequency
+ * (@ref ACLK_VLO_HZ), so one build serves sites that differ only in these. A field of 0 keeps the
+ * compiled value. A block with the wrong magic, version or CRC, made for other pins, or with any
+ * field out of range is ignored as a whole, as is blank flash: the compiled values hold.
+ *
+ * The pins stay compiled in: their conflict checks against the debug, sense and console pins,
+ * the low-leakage port setup and the OUTMOD pin are resolved at build time. The block names the
+ * P1 pins of the build it was made for (@ref CHAN_PINS), so one for other wiring is not applied.
+ *
+ * With @ref STRAP_INTERVAL_BIT or @ref STRAP_WIDTH_BIT, conf_strap() then reads those P2 pins
+ * (strap.h): a pin tied to GND or VCC sets its setting to one of two compiled values, over the
+ * block's; an open pin leaves it.
+ *
+ * The settings are kept in @ref conf with their nominal counts worked out once, at boot or when
+ * the console changes them; the pulse path only reads the counts. tools/conf_block.py writes the
+ * block as Intel HEX.
+ */
+
+#ifndef CONF_H
+#define CONF_H
+
+#include <stdint.h>
+
+#include "config.h"
+#include "strap.h"
+
+#define CONF_BLOCK_ADDR  (0x1030u) /* Info segment D, after the temperature table */
+#define CONF_MAGIC       (0x4643u) /* "CF" */
+#define CONF_VERSION     (1u)
+#define CONF_BLOCK_WORDS (6u)
+#define CONF_VLO_HZ_MIN  (4000u)   /* the VLO's datasheet range */
+#define CONF_VLO_HZ_MAX  (20000u)
+
+/** The settings are kept at run time. */
+#define CONF_USED        (CONF_BLOCK || CONSOLE_BAUD || STRAP_P2_BITS)
+
+/** The interval can be set: only where it is fixed. */
+#define CONF_INTERVAL    (CONF_USED && !SENSE_TIMEOUT_MIN && !ADAPT_MIN_MIN && !EVENT_ONLY)
+
+/**
+ * @brief Site block layout in Info flash (12 bytes); a field of 0 keeps the compiled value.
+ */
+struct conf_block {
+    uint16_t magic;        /* CONF_MAGIC */
+    uint8_t  version;      /* CONF_VERSION */
+    uint8_t  pins;         /* P1 pins of the channels (CHAN_PINS); 0 with expanders */
+    uint16_t interval_min; /* interval of the channels at PULSE_INTERVAL_MIN, 1 up to that */
+    uint16_t slot_ms;      /* pattern slot, ms; 2 to 0x3FFF nominal counts */
+    uint16_t vlo_hz;       /* VLO frequency, CONF_VLO_HZ_MIN..CONF_VLO_HZ_MAX */
+    uint16_t crc;          /* flash_crc() of the words before */
+};
+
+#if CONF_USED
+
+/**
+ * @brief Settings in use. No padding: each member sits at its natural alignment.
+ */
+struct conf {
+    uint32_t interval;     /* interval of the channels at PULSE_INTERVAL_MIN, nominal counts */
+    uint16_t interval_min; /* ... in minutes */
+    uint16_t slot_ms;      /* pattern slot, ms */
+    uint16_t slot_counts;  /* ... in nominal counts */
+    uint16_t vlo_rate;     /* VLO frequency / ACLK_VLO_HZ, Q14, until a calibration */
+};
+
+extern struct conf conf;
+
+#if CONF_BLOCK
+/**
+ * @brief Take the settings from the site block, or keep the compiled ones if it is not valid.
+ * - Call once at boot, before the schedule starts.
+ */
+void conf_load(void);
+#endif
+
+#if STRAP_P2_BITS
+/**
+ * @brief Take the settings picked by the straps (strap_read()); open pins leave them.
+ * - Call once at boot, after conf_load(), with interrupts disabled.
+ */
+void conf_strap(void);
+#endif
+
+/**
+ * @brief Nominal counts of an interval of @p min minutes.
+ * @return 0 unless 1 <= @p min <= @ref PULSE_INTERVAL_MIN
+ */
+uint32_t conf_interval(uint32_t min);
+
+/**
+ * @brief Nominal counts of a pattern slot of @p ms milliseconds.
+ * @return 0 unless that is 2 to 0x3FFF counts (and, with @ref EVENT_ONLY, 8 slots fit in
+ *         @ref EVENT_HOLDOFF_S)
+ */
+uint16_t conf_slot(uint32_t ms);
+
+#endif /* CONF_USED */
+
+#endif /* CONF_H */
@@ -0,0 +1,299 @@
+/**
+ * @file config.h
+ * @brief Build-time configuration for the Meshtastic Watcher.
+ *
+ * Every value can be overridden from platformio.ini, e.g.
+ * `build_flags = -Os -DPULSE_INTERVAL_MIN=360`.
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+/* ---------------- Schedule & pulse ---------------- */
+#ifndef PULSE_INTERVAL_MIN
+#define PULSE_INTERVAL_MIN (60 * 12) /* minutes between pulses */
+#endif
+#ifndef PULSE_MS
+#define PULSE_MS           (500u) /* pulse duration in ms */
+#endif
+#ifndef PULSE_PIN_BIT
+#define PULSE_PIN_BIT      (BIT4) /* output pin: P1.4 */
+#endif
+#ifndef DBG_PIN_BIT
+#define DBG_PIN_BIT        (BIT3) /* output pin: P1.3 */
+#endif
+#ifndef PULSE_PATTERN
+#define PULSE_PATTERN      (0x01) /* PULSE_MS slots, first in bit 0, a set bit LOW; or GESTURE(n) */
+#endif
+
+/*
+ * Gestures, G(LOW, Hi-Z, LOW, ...) each: up to 16 durations of 1..255 GESTURE_MS units, LOW
+ * first. A channel (or PULSE_PATTERN) plays the n-th of the list as GESTURE(n), e.g.
+ * -DPULSE_PATTERN=GESTURE_LONG. The names below refer to the default list.
+ */
+#ifndef GESTURE_MS
+#define GESTURE_MS         (50u) /* gesture duration unit, ms */
+#endif
+#ifndef PULSE_GESTURES
+#define PULSE_GESTURES(G)                                                                         \
+    G(3)             /* click: 150 ms */                                                          \
+    G(3, 4, 3)       /* double click, 200 ms apart */                                             \
+    G(3, 4, 3, 4, 3) /* triple click */                                                           \
+    G(100)           /* long press: 5 s */
+#endif
+#define GESTURE(n)         (0x100 + (n)) /* pattern value of the n-th gesture, 0-based */
+#define GESTURE_CLICK      GESTURE(0)
+#define GESTURE_DOUBLE     GESTURE(1)
+#define GESTURE_TRIPLE     GESTURE(2)
+#define GESTURE_LONG       GESTURE(3)
+
+/*
+ * Channels, one node button each: X(pin, interval min, phase min, pattern) per channel; the pin
+ * is a P1 pin bit, or the line number with an expander (PULSE_OUT), and the pattern as for
+ * PULSE_PATTERN, slots or a gesture. Channel n pulses at
+ * phase + k * interval (k >= 1); of the pulses due together, up to PULSE_BATCH start at once and
+ * the rest go after them. PULSE_INTERVAL_MIN sizes the timebase and must be the longest
+ * interval. For example -D'PULSE_CHANNELS(X)=X(BIT4, 720, 0, 1) X(BIT5, 720, 360, 5)' presses
+ * P1.5 twice, half a period after P1.4.
+ */
+#ifndef PULSE_CHANNELS
+#define PULSE_CHANNELS(X)  X(PULSE_PIN_BIT, PULSE_INTERVAL_MIN, 0, PULSE_PATTERN)
+#endif
+
+/* Pulse timing modes */
+#define PULSE_MODE_DELAY   (0) /* busy-wait delay_ms() on the 1 MHz DCO inside the ISR */
+#define PULSE_MODE_TIMER   (1) /* TACCR1 ends the pulse from its own ISR; CPU stays in LPM3 */
+#define PULSE_MODE_OUTMOD  (2) /* pin on TA0.1 held at OUT = 0, released by CCR1 (P1.2/P1.6) */
+
+#ifndef PULSE_MODE
+#define PULSE_MODE PULSE_MODE_TIMER
+#endif
+
+/* Button line outputs */
+#define PULSE_OUT_GPIO     (0) /* one P1 pin per channel, open-drain style */
+#define PULSE_OUT_595      (1) /* 74HC595 chain on P2, bit-banged; a set output pulls a line LOW */
+#define PULSE_OUT_PCF8574  (2) /* PCF8574 expanders on USCI_B0 I2C: P1.6 SCL, P1.7 SDA (G2553) */
+
+#ifndef PULSE_OUT
+#define PULSE_OUT PULSE_OUT_GPIO
+#endif
+#ifndef PULSE_BATCH
+#define PULSE_BATCH        (PULSE_OUT == PULSE_OUT_GPIO ? 1 : 8) /* patterns started together */
+#endif
+#ifndef EXP_COUNT
+#define EXP_COUNT          (1) /* expander chips of 8 lines: line n is output n % 8 of chip n / 8 */
+#endif
+#ifndef EXP_SER_BIT
+#define EXP_SER_BIT        (BIT0) /* 595 serial data: P2.0 */
+#endif
+#ifndef EXP_SCK_BIT
+#define EXP_SCK_BIT        (BIT1) /* 595 shift clock: P2.1 */
+#endif
+#ifndef EXP_RCK_BIT
+#define EXP_RCK_BIT        (BIT2) /* 595 latch clock: P2.2 */
+#endif
+#ifndef EXP_I2C_ADDR
+#define EXP_I2C_ADDR       (0x20) /* PCF8574 of chip 0 (A2..A0 LOW); chip n answers at + n */
+#endif
+#ifndef EXP_I2C_KHZ
+#define EXP_I2C_KHZ        (100u) /* I2C clock from the 1 MHz SMCLK */
+#endif
+
+/* ---------------- Timebase ---------------- */
+#ifndef ACLK_VLO_HZ
+#define ACLK_VLO_HZ        (11805u) /* VLO is ~12 kHz, measured to be 11.8 kHz */
+#endif
+#ifndef TIMEBASE_ERR_PPM
+#define TIMEBASE_ERR_PPM   (100u) /* max interval error from timer rounding, in ppm */
+#endif
+
+#ifndef SCHED_TICKLESS
+#define SCHED_TICKLESS     (1) /* 1: continuous timer, one compare per event; 0: fixed tick */
+#endif
+
+/* ---------------- Event-only mode (LPM4) ---------------- */
+/* Wake sources without a schedule */
+#define EVENT_SENSE        (1) /* SENSE_EDGE on the sense pin */
+#define EVENT_PGOOD        (2) /* the node's rail coming back (PGOOD_DELAY_S) */
+
+#ifndef EVENT_ONLY
+#define EVENT_ONLY         (0) /* EVENT_SENSE / EVENT_PGOOD: no schedule, LPM4 between events */
+#endif
+#ifndef EVENT_DELAY_S
+#define EVENT_DELAY_S      (2) /* sense edge to pulse, s (EVENT_SENSE) */
+#endif
+#ifndef EVENT_HOLDOFF_S
+#define EVENT_HOLDOFF_S    (60) /* events are ignored this long after a pulse, s */
+#endif
+
+#ifndef VLO_CAL_HOURS
+#define VLO_CAL_HOURS      (6) /* re-measure the VLO every N hours (EVENT_ONLY: every event) */
+#endif
+
+#ifndef TEMPCOMP_MIN
+#define TEMPCOMP_MIN       (EVENT_ONLY ? 0 : 15) /* sample the die temperature every N min */
+#endif
+
+/* ---------------- Liveness sensing ---------------- */
+#ifndef SENSE_TIMEOUT_MIN
+#define SENSE_TIMEOUT_MIN  (0) /* pulse only after N minutes without activity; 0 = pulse blindly */
+#endif
+#ifndef SENSE_PORT
+#define SENSE_PORT         (1) /* sense input port: 1 = P1, 2 = P2 */
+#endif
+#ifndef SENSE_PIN_BIT
+#define SENSE_PIN_BIT      (BIT5) /* sense input pin: P1.5 */
+#endif
+
+/* Sense pin edge that counts as activity */
+#define SENSE_EDGE_RISING  (0)
+#define SENSE_EDGE_FALLING (1)
+
+#ifndef SENSE_EDGE
+#define SENSE_EDGE SENSE_EDGE_RISING
+#endif
+
+/* Internal resistor on the sense pin; keeps it from floating while the node is unpowered */
+#define SENSE_PULL_NONE    (0)
+#define SENSE_PULL_DOWN    (1)
+#define SENSE_PULL_UP      (2)
+
+#ifndef SENSE_PULL
+#define SENSE_PULL SENSE_PULL_DOWN
+#endif
+
+/*
+ * Escalation while the node stays silent (SENSE_TIMEOUT_MIN): the first press is the channel's
+ * pattern, the next ones ESCALATE_PATTERN, ESCALATE_GAP_MIN after it, then twice, four times ...
+ * that long apart up to ESCALATE_MAX_MIN. Activity on the sense pin starts the timeout over.
+ */
+#ifndef ESCALATE_GAP_MIN
+#define ESCALATE_GAP_MIN   (10) /* first press to the second, min; 0 = a press every timeout */
+#endif
+#ifndef ESCALATE_MAX_MIN
+#define ESCALATE_MAX_MIN   (PULSE_INTERVAL_MIN) /* longest gap between presses, min */
+#endif
+#ifndef ESCALATE_PATTERN
+#define ESCALATE_PATTERN   GESTURE_LONG /* second and later presses */
+#endif
+
+/* ---------------- Learned interval ---------------- */
+/*
+ * With ADAPT_MIN_MIN the sense pin only watches the node, and a single channel's interval is
+ * learned from it: a node silent for ADAPT_QUIET_MIN minutes at its press had hung, and the time
+ * it had stayed up since the press before that brought it back is a sample. The interval is
+ * half the typical up time, between ADAPT_MIN_MIN and PULSE_INTERVAL_MIN.
+ */
+#ifndef ADAPT_MIN_MIN
+#define ADAPT_MIN_MIN      (0) /* shortest learned interval, min; 0 = PULSE_INTERVAL_MIN fixed */
+#endif
+#ifndef ADAPT_QUIET_MIN
+#define ADAPT_QUIET_MIN    (10) /* silence on the sense pin that counts as a hang, min */
+#endif
+
+/* ---------------- Checkpoints ---------------- */
+/*
+ * With CKPT_MIN the time left to every channel's deadline is kept over resets (in RAM) and power
+ * losses (in Info flash segments B and C), and the schedule resumes from it at boot.
+ */
+#ifndef CKPT_MIN
+#define CKPT_MIN           (0) /* checkpoint to RAM every N minutes and after a pulse; 0 = off */
+#endif
+#ifndef CKPT_FLASH_MIN
+#define CKPT_FLASH_MIN     (60) /* ... and to flash every N minutes (rounded up to CKPT_MIN) */
+#endif
+
+/* ---------------- Event log ---------------- */
+/*
+ * With LOG_SEGS boots, pulses, sense pin wakes, calibrations and supply lows are logged to a
+ * ring of main flash segments, to be read out after the fact (tools/log_decode.py).
+ */
+#ifndef LOG_SEGS
+#define LOG_SEGS           (0) /* main flash segments (512 bytes) of the log, 2..4; 0 = off */
+#endif
+#ifndef LOG_BATCH
+#define LOG_BATCH          (4) /* records collected in RAM per flash write */
+#endif
+
+/* ---------------- Console ---------------- */
+/*
+ * With CONSOLE_BAUD a serial console on P1.1 (RX) and P1.2 (TX) shows the counters, dumps the
+ * event log and sets the interval and pulse width until the next reset (console.h). Nothing is
+ * clocked while no one types: the first key wakes it, and it sleeps again CONSOLE_IDLE_S after
+ * the last one.
+ */
+#ifndef CONSOLE_BAUD
+#define CONSOLE_BAUD       (0) /* bit/s, 8N1, e.g. 9600; 0 = no console */
+#endif
+#ifndef CONSOLE_IDLE_S
+#define CONSOLE_IDLE_S     (60) /* USCI_A0 off this long after the last key, s */
+#endif
+
+/* ---------------- Site block ---------------- */
+/*
+ * With CONF_BLOCK the interval, pulse width and VLO frequency of the site are read at boot from
+ * a block in Info flash segment D (conf.h, tools/conf_block.py). The values above are the
+ * defaults for a field left at 0, and for all of them while the block is blank or not valid.
+ */
+#ifndef CONF_BLOCK
+#define CONF_BLOCK         (0) /* 1: read the site block at boot; 0 = compiled values only */
+#endif
+
+/* ---------------- Resistor straps ---------------- */
+/*
+ * A P2 pin tied to GND or VCC (0 to 4.7 kOhm), or left open, picks one of three values of a
+ * setting at boot (strap.h): open keeps the value above, or the site block's. The pins are read
+ * once with the internal pulls, then driven to the level they are tied to, so no current flows
+ * through a strap after boot.
+ */
+#ifndef STRAP_INTERVAL_BIT
+#define STRAP_INTERVAL_BIT (0) /* P2 pin picking the interval, e.g. BIT3; 0 = none */
+#endif
+#ifndef STRAP_INTERVAL_GND_MIN
+#define STRAP_INTERVAL_GND_MIN (60 * 2) /* interval with that pin tied to GND, min */
+#endif
+#ifndef STRAP_INTERVAL_VCC_MIN
+#define STRAP_INTERVAL_VCC_MIN (60 * 6) /* ... tied to VCC, min */
+#endif
+#ifndef STRAP_WIDTH_BIT
+#define STRAP_WIDTH_BIT    (0) /* P2 pin picking the pattern slot (PULSE_MS); 0 = none */
+#endif
+#ifndef STRAP_WIDTH_GND_MS
+#define STRAP_WIDTH_GND_MS (250u) /* slot with that pin tied to GND, ms */
+#endif
+#ifndef STRAP_WIDTH_VCC_MS
+#define STRAP_WIDTH_VCC_MS (1000u) /* ... tied to VCC, ms */
+#endif
+
+/* ---------------- Battery recovery ---------------- */
+#ifndef BATT_SAMPLE_MIN
+#define BATT_SAMPLE_MIN    (0) /* sample VCC every N minutes for the recovery pulse; 0 = never */
+#endif
+#ifndef BATT_LOW_MV
+#define BATT_LOW_MV        (2300u) /* below this the supply counts as discharged */
+#endif
+#ifndef BATT_RECOVER_MV
+#define BATT_RECOVER_MV    (2800u) /* ... and recovered again at or above this, while rising */
+#endif
+#ifndef BATT_RISE_SAMPLES
+#define BATT_RISE_SAMPLES  (3u) /* samples in a row without a fall before a recovery counts */
+#endif
+#ifndef BATT_DELAY_MIN
+#define BATT_DELAY_MIN     (10) /* pulse this many minutes after the recovery */
+#endif
+
+/* ---------------- Power-good (Comparator_A+) ---------------- */
+#ifndef PGOOD_DELAY_S
+#define PGOOD_DELAY_S      (0) /* pulse N s after the watched rail comes back; 0 = not watched */
+#endif
+#ifndef PGOOD_POLL_S
+#define PGOOD_POLL_S       (EVENT_ONLY ? 0 : 4) /* compare every N s; 0 = always on, edge IRQ */
+#endif
+#ifndef PGOOD_CA
+#define PGOOD_CA           (7) /* comparator input CA1..CA7 (P1.1..P1.7) with the divided rail */
+#endif
+#ifndef PGOOD_REF
+#define PGOOD_REF          (CAREF_1) /* CAREF_1 0.25 VCC, CAREF_2 0.5 VCC, CAREF_3 diode */
+#endif
+
+#endif /* CONFIG_H */
@@ -0,0 +1,300 @@
+/**
+ * @file console.c
+ * @brief Serial console (see console.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "console.h"
+
+#if CONSOLE_BAUD
+
+/* ---------------- Defines ---------------- */
+#if CONSOLE_BAUD < 1200 || CONSOLE_BAUD > 115200
+#error "CONSOLE_BAUD must be 1200..115200"
+#endif
+#if CONSOLE_RX_SIZE & (CONSOLE_RX_SIZE - 1u)
+#error "CONSOLE_RX_SIZE must be a power of two"
+#endif
+
+#define CONSOLE_PINS (CONSOLE_RX_BIT | CONSOLE_TX_BIT)
+#define CONSOLE_CR   ('\r')
+
+#if CONSOLE_SOFT
+#if CONSOLE_BAUD > 9600
+#error "CONSOLE_SOFT runs up to 9600 bit/s: a bit must last some 100 DCO cycles"
+#endif
+/* One bit in DCO cycles (1 MHz) */
+#define CONSOLE_BIT          ((1000000UL + CONSOLE_BAUD / 2u) / CONSOLE_BAUD)
+/* CPU cycles the bit loops take besides their delays, and from the start bit's edge into
+ * console_edge() (the DCO start-up from LPM3 included): msp430-gcc -Os on the device; the host
+ * model charges the register accesses only */
+#if defined(__MSP430__)
+#define CONSOLE_LOOP_CYCLES  (11u)
+#define CONSOLE_ENTRY_CYCLES (30u)
+#else
+#define CONSOLE_LOOP_CYCLES  (3u)
+#define CONSOLE_ENTRY_CYCLES (12u)
+#endif
+#else
+#if defined(__MSP430__) && !defined(__MSP430_HAS_USCI__)
+#error "The console needs USCI_A0 (MSP430G2553); set CONSOLE_SOFT on the G2452"
+#endif
+/* SMCLK (1 MHz) per bit in eighths: UCA0BR and the UCBRS modulation */
+#define CONSOLE_BR8 ((8000000UL + CONSOLE_BAUD / 2u) / CONSOLE_BAUD)
+#endif
+
+/* ---------------- Variables ---------------- */
+static volatile uint8_t console_ring[CONSOLE_RX_SIZE]; /* received, parsed in place */
+static volatile uint8_t console_head;                  /* next slot the ISR fills */
+static uint8_t          console_tail;                  /* next character to parse */
+#if !CONSOLE_SOFT
+static volatile uint8_t console_open; /* session open: USCI_A0 out of reset */
+#endif
+static char             console_cmd;  /* command of the line so far, 0 = none yet */
+static uint32_t         console_arg;
+static uint8_t          console_has_arg;
+static uint8_t          console_bad;  /* the line is not a command */
+
+/* ---------------- Functions ---------------- */
+
+/** Queue @p c for console_run(); dropped if the ring is full. */
+static void console_queue(uint8_t c) {
+    uint8_t h = console_head;
+
+    if ((uint8_t)(h - console_tail) < CONSOLE_RX_SIZE) {
+        console_ring[h & (CONSOLE_RX_SIZE - 1u)] = c;
+        console_head                            = (uint8_t)(h + 1u);
+    }
+}
+
+/** Wait for the first key: RX a GPIO input with pull-up and falling edge interrupt. */
+static void console_wait(void) {
+    P1SEL  &= ~CONSOLE_PINS;
+    P1SEL2 &= ~CONSOLE_PINS;
+    P1DIR  &= ~CONSOLE_RX_BIT;
+    P1OUT  |= CONSOLE_PINS; /* RX pull-up, TX HIGH */
+    P1REN  |= CONSOLE_RX_BIT;
+    P1DIR  |= CONSOLE_TX_BIT;
+    P1IES  |= CONSOLE_RX_BIT;
+    P1IFG  &= ~CONSOLE_RX_BIT; /* writing IES may set the flag */
+    P1IE   |= CONSOLE_RX_BIT;
+}
+
+void console_init(void) {
+#if !CONSOLE_SOFT
+    UCA0CTL1 = UCSWRST;
+    UCA0CTL0 = 0;                   /* UART, 8N1, LSB first */
+    UCA0CTL1 = UCSSEL_2 | UCSWRST;  /* SMCLK, held in reset until a session */
+    UCA0BR0  = (uint8_t)(CONSOLE_BR8 >> 3);
+    UCA0BR1  = (uint8_t)(CONSOLE_BR8 >> 11);
+    UCA0MCTL = (uint8_t)((CONSOLE_BR8 & 7u) << 1); /* UCBRSx */
+#endif
+    console_wait();
+}
+
+#if CONSOLE_SOFT
+/**
+ * - Samples each data bit in its middle, counting cycles from the start bit's edge; returns in
+ *   the middle of the stop bit. A LOW stop bit drops the character.
+ * - The data bits' falling edges set the pin's flag again; cleared at the end.
+ */
+uint8_t console_edge(void) {
+    uint8_t b = 0;
+    uint8_t i;
+
+    __delay_cycles(CONSOLE_BIT + CONSOLE_BIT / 2u - CONSOLE_ENTRY_CYCLES); /* data bit 0 */
+    for (i = 8u; i; i--) {
+        b >>= 1;
+        if (P1IN & CONSOLE_RX_BIT) {
+            b |= 0x80u;
+        }
+        __delay_cycles(CONSOLE_BIT - CONSOLE_LOOP_CYCLES);
+    }
+    if (!(P1IN & CONSOLE_RX_BIT)) {
+        P1IFG &= ~CONSOLE_RX_BIT;
+        return 0;
+    }
+    P1IFG &= ~CONSOLE_RX_BIT;
+    console_queue(b);
+    return 1;
+}
+
+/**
+ * - Interrupts are off for the character (~1 ms at 9600 bit/s): a timer ISR comes that late.
+ */
+void console_put(char c) {
+    uint16_t f = (uint16_t)(((uint8_t)c | 0x100u) << 1); /* start, 8 data, stop bit */
+    uint8_t  i;
+
+    __disable_interrupt();
+    for (i = 10u; i; i--) {
+        if (f & 1u) {
+            P1OUT |= CONSOLE_TX_BIT;
+        } else {
+            P1OUT &= ~CONSOLE_TX_BIT;
+        }
+        f >>= 1;
+        __delay_cycles(CONSOLE_BIT - CONSOLE_LOOP_CYCLES);
+    }
+    __enable_interrupt();
+}
+
+uint8_t console_active(void) {
+    return 0;
+}
+#else
+/**
+ * - The edge interrupt stays masked for the session; the USCI takes the line from the next
+ *   start bit on.
+ */
+uint8_t console_edge(void) {
+    P1IE     &= ~CONSOLE_RX_BIT;
+    P1IFG    &= ~CONSOLE_RX_BIT;
+    P1SEL    |= CONSOLE_PINS;
+    P1SEL2   |= CONSOLE_PINS;
+    UCA0CTL1 &= ~UCSWRST;
+    IE2      |= UCA0RXIE;
+    console_open = 1;
+    return 1;
+}
+
+void console_rx(void) {
+    console_queue(UCA0RXBUF); /* reading it clears UCA0RXIFG */
+}
+
+void console_close(void) {
+    IE2      &= ~UCA0RXIE;
+    UCA0CTL1 |= UCSWRST; /* clears the flags; SMCLK no longer clocks the USCI */
+    console_open = 0;
+    console_wait();
+}
+
+void console_put(char c) {
+    if (!console_open) {
+        return; /* closed while writing: nobody is listening */
+    }
+    while (!(IFG2 & UCA0TXIFG)) {
+    }
+    UCA0TXBUF = (uint8_t)c;
+}
+
+uint8_t console_active(void) {
+    return console_open;
+}
+#endif
+
+uint8_t console_pending(void) {
+    return console_head != console_tail;
+}
+
+void console_puts(const char *s) {
+    while (*s) {
+        console_put(*s++);
+    }
+}
+
+void console_putu(uint32_t v) {
+    char    d[10];
+    uint8_t n = 0;
+
+    do {
+        d[n++] = (char)('0' + v % 10u);
+        v     /= 10u;
+    } while (v);
+    while (n) {
+        console_put(d[--n]);
+    }
+}
+
+void console_line(const char *label, uint32_t value, const char *unit) {
+    console_puts(label);
+    console_put(' ');
+    console_putu(value);
+    if (*unit) {
+        console_put(' ');
+        console_puts(unit);
+    }
+    console_puts("\r\n");
+}
+
+/** Write @p b as two hex digits; add it to @p sum. */
+static void console_hex8(uint8_t b, uint8_t *sum) {
+    static const char digits[] = "0123456789ABCDEF";
+
+    console_put(digits[b >> 4]);
+    console_put(digits[b & 0x0Fu]);
+    *sum = (uint8_t)(*sum + b);
+}
+
+void console_hex(uint16_t addr, uint16_t n) {
+    const volatile uint8_t *p;
+    uint8_t                 i, sum, used;
+
+    for (; n >= 16u; n -= 16u, addr += 16u) {
+        p = (const volatile uint8_t *)HAL_FLASH_PTR(addr);
+        for (i = 0, used = 0; i < 16u; i++) {
+            used |= (uint8_t)~p[i];
+        }
+        if (!used) {
+            continue;
+        }
+        sum = 0;
+        console_put(':');
+        console_hex8(16u, &sum);
+        console_hex8((uint8_t)(addr >> 8), &sum);
+        console_hex8((uint8_t)addr, &sum);
+        console_hex8(0, &sum); /* data record */
+        for (i = 0; i < 16u; i++) {
+            console_hex8(p[i], &sum);
+        }
+        console_hex8((uint8_t)-sum, &sum);
+        console_puts("\r\n");
+    }
+    console_puts(":00000001FF\r\n");
+}
+
+/**
+ * - Reads each character in its ring slot; the slot is only given back to the ISR once it is
+ *   parsed. A line feed is ignored, so CR LF line ends work too.
+ */
+void console_run(void) {
+    uint8_t c;
+
+    while (console_pending()) {
+        c = console_ring[console_tail & (CONSOLE_RX_SIZE - 1u)];
+        console_tail++;
+        if (c == '\n') {
+            continue;
+        }
+        if (c == CONSOLE_CR) {
+            console_puts("\r\n");
+            if (console_bad) {
+                console_puts("?\r\n");
+            } else if (console_cmd) {
+                console_on_command(console_cmd, console_arg, console_has_arg);
+            }
+            console_puts("> ");
+            console_cmd     = 0;
+            console_arg     = 0;
+            console_has_arg = 0;
+            console_bad     = 0;
+            continue;
+        }
+        if (c < ' ' || c > '~') {
+            continue; /* not echoed */
+        }
+        console_put((char)c);
+        if (c == ' ') {
+            /* separates the number */
+        } else if (!console_cmd) {
+            console_cmd = (char)c;
+        } else if (c >= '0' && c <= '9' && console_arg < 100000000UL) {
+            console_arg     = 10u * console_arg + (uint32_t)(c - '0');
+            console_has_arg = 1;
+        } else {
+            console_bad = 1;
+        }
+    }
+}
+
+#endif /* CONSOLE_BAUD */
@@ -0,0 +1,130 @@
+/**
+ * @file console.h
+ * @brief Serial console: one-line commands in, text out, at @ref CONSOLE_BAUD 8N1.
+ *
+ * RX is P1.1 and TX P1.2 (UCA0RXD and UCA0TXD, the LaunchPad's backchannel UART with its RXD and
+ * TXD jumpers set for the hardware UART). While no one types, RX is a GPIO input with its
+ * pull-up and a falling edge interrupt, TX an output resting HIGH, and no UART clock runs; the
+ * MCU sleeps in LPM3 as without a console. Two backends sit behind the same calls:
+ * - USCI_A0 (G2553): the first start bit opens a session. Both pins go to the USCI, clocked
+ *   from SMCLK (the 1 MHz DCO), and the CPU waits in LPM0 instead of LPM3 while it lasts. That
+ *   character is lost: a session starts with Enter. @ref CONSOLE_IDLE_S after the last
+ *   character the application closes it again with console_close().
+ * - Software (@ref CONSOLE_SOFT, the default on the G2452, which has no USCI): the port ISR
+ *   receives each character whole, sampling RX at DCO cycle counts from its start bit, and
+ *   TX is bit-banged the same way with interrupts off for one character at a time. Timer_A
+ *   cannot time the bits, it counts the VLO (~12 kHz). Up to 9600 bit/s; half duplex, so
+ *   keys typed while the console writes are garbled.
+ *
+ * Received characters go to a ring of @ref CONSOLE_RX_SIZE bytes, which console_run() parses
+ * in place: a command is a character, an optional unsigned decimal number, then CR. Each
+ * character is echoed; there is no line editing. Every complete line goes to
+ * console_on_command(), which the application implements, and is answered with a "> "
+ * prompt. Output busy-waits on the UART, with interrupts on.
+ */
+
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include <stdint.h>
+
+#include "config.h"
+#include "hal.h"
+
+#if CONSOLE_BAUD
+
+#ifndef CONSOLE_SOFT
+#if defined(__MSP430__) && !defined(__MSP430_HAS_USCI__)
+#define CONSOLE_SOFT (1)
+#else
+#define CONSOLE_SOFT (0) /* USCI_A0 */
+#endif
+#endif
+
+#define CONSOLE_RX_BIT  (BIT1) /* P1.1, UCA0RXD */
+#define CONSOLE_TX_BIT  (BIT2) /* P1.2, UCA0TXD */
+#define CONSOLE_RX_SIZE (16u)  /* receive ring, a power of two */
+
+/**
+ * @brief Set up the pins to wait for the first key: RX with its pull-up and edge interrupt,
+ *        TX HIGH.
+ * - Call after the port defaults are set up (all pins are outputs there).
+ */
+void console_init(void);
+
+/**
+ * @brief Port 1 ISR body for @ref CONSOLE_RX_BIT: a start bit.
+ * - USCI_A0: opens the session. Software: receives the character.
+ * @return 1 if main() has to run: console_run(), or a new sleep mode
+ */
+uint8_t console_edge(void);
+
+#if !CONSOLE_SOFT
+/**
+ * @brief USCI_A0 receive ISR body: queues the character for console_run().
+ */
+void console_rx(void);
+
+/**
+ * @brief End the session: USCI_A0 back into reset, the pins back to waiting for a key.
+ */
+void console_close(void);
+#endif
+
+/**
+ * @brief Whether a session is open: USCI_A0 needs SMCLK, so the CPU may only sleep in LPM0.
+ *        Always 0 for the software UART.
+ */
+uint8_t console_active(void);
+
+/**
+ * @brief Whether received characters wait for console_run(); check with interrupts disabled
+ *        before going to sleep.
+ */
+uint8_t console_pending(void);
+
+/**
+ * @brief Parse the characters received since the last call, from main() with interrupts
+ *        enabled; calls console_on_command() for every complete line.
+ */
+void console_run(void);
+
+/**
+ * @brief Write character @p c; busy-waits until it is out (software) or buffered (USCI).
+ */
+void console_put(char c);
+
+/**
+ * @brief Write the string @p s.
+ */
+void console_puts(const char *s);
+
+/**
+ * @brief Write @p v in decimal.
+ */
+void console_putu(uint32_t v);
+
+/**
+ * @brief Write "<label> <value> <unit>" and a line end, e.g. "interval 720 min"; @p unit may
+ *        be empty.
+ */
+void console_line(const char *label, uint32_t value, const char *unit);
+
+/**
+ * @brief Dump @p n bytes of flash from @p addr as Intel HEX data records, 16 bytes each, and
+ *        an end record; erased lines (all 0xFF) are left out.
+ */
+void console_hex(uint16_t addr, uint16_t n);
+
+/**
+ * @brief Command handler, implemented by the application; runs in main() with interrupts
+ *        enabled.
+ * @param cmd     first character of the line
+ * @param arg     the number after it
+ * @param has_arg 1 if there was one
+ */
+void console_on_command(char cmd, uint32_t arg, uint8_t has_arg);
+
+#endif /* CONSOLE_BAUD */
+
+#endif /* CONSOLE_H */
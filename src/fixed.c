@@ -0,0 +1,39 @@
+/**
+ * @file fixed.c
+ * @brief Q14 fixed-point helpers (see fixed.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "fixed.h"
+
+/* ---------------- Functions ---------------- */
+
+uint32_t fx_mul_q14(uint32_t a, uint16_t s) {
+    /* split so every product is 16x16 */
+    return (((uint32_t)(uint16_t)(a >> 16) * s) << 2) + (((uint32_t)(uint16_t)a * s) >> 14);
+}
+
+/**
+ * - y' = y (2 - m y) from the linear guess 48/17 - 32/17 m (error < 1/17); three steps reach
+ *   the Q14 resolution.
+ */
+uint16_t fx_recip_mant(uint16_t m) {
+    uint16_t      y = (uint16_t)(46261u - (uint16_t)(((uint32_t)30840u * m) >> 16));
+    unsigned char i;
+    for (i = 0; i < 3; i++) {
+        uint16_t my = (uint16_t)(((uint32_t)m * y) >> 16); /* ~1.0 in Q14 */
+        y           = (uint16_t)(((uint32_t)y * (32768u - my)) >> 14);
+    }
+    return y;
+}
+
+uint16_t fx_recip_q14(uint16_t s) {
+    unsigned char k = 0;
+    uint32_t      r;
+    while (!(s & 0x8000u)) {
+        s <<= 1;
+        k++;
+    }
+    r = ((uint32_t)fx_recip_mant(s) << k) >> 2; /* 1/s = 2^(k-2) / m */
+    return r > 0xFFFFu ? 0xFFFFu : (uint16_t)r;
+}
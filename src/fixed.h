@@ -0,0 +1,34 @@
+/**
+ * @file fixed.h
+ * @brief Q14 fixed-point helpers for parts without a hardware multiplier.
+ *
+ * Only 16x16 -> 32 bit multiplies and shifts; no division.
+ */
+
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <stdint.h>
+
+#define FX_ONE (16384u) /* 1.0 in Q14 */
+
+/**
+ * @brief a * s with s in Q14.
+ */
+uint32_t fx_mul_q14(uint32_t a, uint16_t s);
+
+/**
+ * @brief Reciprocal of a normalized mantissa (Newton-Raphson).
+ * @param m mantissa in [0.5, 1), Q16 (bit 15 set)
+ * @return 1/m in (1, 2], Q14
+ */
+uint16_t fx_recip_mant(uint16_t m);
+
+/**
+ * @brief Reciprocal of a Q14 value.
+ * @param s value in [0.25, 4), Q14
+ * @return 1/s in Q14, saturated to 0xFFFF
+ */
+uint16_t fx_recip_q14(uint16_t s);
+
+#endif /* FIXED_H */
@@ -0,0 +1,68 @@
+/**
+ * @file flash.c
+ * @brief Flash erase and writes (see flash.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "flash.h"
+
+#include "hal.h"
+
+#if FLASH_USED
+
+/* ---------------- Defines ---------------- */
+/* Timing generator: MCLK / 3 */
+#define FLASH_CLOCK (FSSEL_1 | FN1)
+
+/* ---------------- Functions ---------------- */
+
+/** Unlock the controller for @p mode (ERASE or WRT); LOCKA keeps segment A locked. */
+static void flash_unlock(uint16_t mode) {
+    FCTL2 = FWKEY | FLASH_CLOCK;
+    FCTL3 = FWKEY; /* clears LOCK; a 0 leaves LOCKA as it is */
+    FCTL1 = FWKEY | mode;
+}
+
+/** End the operation and lock the controller again. */
+static void flash_lock(void) {
+    while (FCTL3 & BUSY) {
+    }
+    FCTL1 = FWKEY;
+    FCTL3 = FWKEY | LOCK;
+}
+
+void flash_erase(uint16_t addr) {
+    flash_unlock(ERASE);
+    HAL_FLASH_WRITE(addr, 0u); /* a dummy write starts the erase; the CPU is held until done */
+    flash_lock();
+}
+
+void flash_write(uint16_t addr, const uint16_t *w, uint8_t n) {
+    flash_unlock(WRT);
+    for (; n; n--, addr += 2u) {
+        HAL_FLASH_WRITE(addr, *w++);
+    }
+    flash_lock();
+}
+
+#endif /* FLASH_USED */
+
+#if FLASH_USED || CONF_BLOCK
+
+/**
+ * - Bitwise, ~100 cycles per byte: records are a few words, written minutes apart.
+ */
+uint16_t flash_crc(const uint16_t *w, uint8_t n) {
+    uint16_t crc = 0xFFFFu;
+    uint8_t  i, k;
+
+    for (i = 0; i < 2u * n; i++) {
+        crc ^= i & 1u ? w[i / 2u] & 0xFF00u : (uint16_t)(w[i / 2u] << 8);
+        for (k = 0; k < 8u; k++) {
+            crc = crc & 0x8000u ? (uint16_t)(crc << 1) ^ 0x1021u : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+#endif /* FLASH_USED || CONF_BLOCK */
@@ -0,0 +1,52 @@
+/**
+ * @file flash.h
+ * @brief Flash segment erase and word writes through the flash controller.
+ *
+ * The timing generator runs from MCLK (the 1 MHz DCO) divided by 3, ~333 kHz, within the
+ * 257..476 kHz the flash needs. A segment erase then takes ~14.5 ms and a word ~90 us, with the
+ * CPU held and ~1 mA (typical) drawn from VCC, which must be at least 2.2 V. Segment A, with the
+ * DCO calibration, stays locked (LOCKA is never written). Main flash segments are only written
+ * in areas reserved with @ref HAL_MAIN_FLASH; an erase there takes as long.
+ *
+ * All functions must run with interrupts disabled and the watchdog held.
+ */
+
+#ifndef FLASH_H
+#define FLASH_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+/* Info flash segments, 64 bytes each */
+#define FLASH_SEG_SIZE    (64u)
+#define FLASH_INFO_D      (0x1000u) /* temperature table (tempcomp.h), site block (conf.h) */
+#define FLASH_INFO_C      (0x1040u)
+#define FLASH_INFO_B      (0x1080u)
+
+/** Main flash segment size. */
+#define FLASH_MAIN_SEG_SIZE (512u)
+
+/** The flash is written at run time: schedule checkpoints, event log. */
+#define FLASH_USED        (CKPT_MIN || LOG_SEGS)
+
+/**
+ * @brief Erase the segment at @p addr to 0xFF.
+ * @param addr first byte of Info segment B, C or D, or of a main flash segment of a
+ *        @ref HAL_MAIN_FLASH area
+ */
+void flash_erase(uint16_t addr);
+
+/**
+ * @brief Program @p n words from @p w to flash at @p addr.
+ * - Programming only clears bits: the words must be erased (0xFFFF) first.
+ */
+void flash_write(uint16_t addr, const uint16_t *w, uint8_t n);
+
+/**
+ * @brief CRC-16/CCITT (0x1021, from 0xFFFF) of @p n words, low byte first.
+ * - Also built without @ref FLASH_USED for the site block (@ref CONF_BLOCK).
+ */
+uint16_t flash_crc(const uint16_t *w, uint8_t n);
+
+#endif /* FLASH_H */
@@ -0,0 +1,35 @@
+/**
+ * @file gesture.c
+ * @brief Button gestures (see gesture.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "gesture.h"
+
+/* ---------------- Defines ---------------- */
+#define GESTURE_CODE(...) __VA_ARGS__, 0,
+
+#if 0 PULSE_GESTURES(GESTURE_OVER16)
+#error "PULSE_GESTURES: a gesture has more than 16 durations"
+#endif
+#if GESTURE_COUNT > 0xFF
+#error "PULSE_GESTURES lists more than 255 gestures"
+#endif
+#if GESTURE_MS < 1 || GESTURE_MS > 1000
+#error "GESTURE_MS must be 1..1000"
+#endif
+
+/* ---------------- Variables ---------------- */
+static const uint8_t gesture_codes[] = {PULSE_GESTURES(GESTURE_CODE) 0};
+
+/* ---------------- Functions ---------------- */
+
+const uint8_t *gesture_code(uint8_t g) {
+    const uint8_t *p = gesture_codes;
+
+    while (g--) {
+        while (*p++) {
+        }
+    }
+    return p;
+}
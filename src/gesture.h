@@ -0,0 +1,44 @@
+/**
+ * @file gesture.h
+ * @brief Button gestures: press and release durations played on a channel's line.
+ *
+ * A slot pattern (chan.h) only times presses on a grid of @ref PULSE_MS slots, which is enough
+ * for one press or a few equal ones. Meshtastic tells single, double and triple clicks and long
+ * presses apart by their timing, so a gesture lists the durations themselves: LOW, Hi-Z, LOW, ...
+ * in @ref GESTURE_MS units, 1..255 each, up to 16 of them. The list of @ref PULSE_GESTURES is
+ * kept in flash as one byte string, each gesture ending in a 0, and a channel refers to the
+ * n-th of them as @ref GESTURE (n) in place of a slot pattern (0x01..0xFF).
+ *
+ * main.c plays a gesture step by step from TACCR1 like a slot pattern, with the CPU in LPM3
+ * throughout. A trailing Hi-Z duration keeps the line released for that long before the next
+ * pattern starts.
+ */
+
+#ifndef GESTURE_H
+#define GESTURE_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+/* Expansions of the PULSE_GESTURES list */
+#define GESTURE_ONE(...) +1
+#define GESTURE_ADD(...) +GESTURE_SUM_(__VA_ARGS__, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+#define GESTURE_OVER16(...)                                                                       \
+    || GESTURE_17TH_(__VA_ARGS__, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0)
+#define GESTURE_SUM_(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p, ...)                         \
+    ((a) + (b) + (c) + (d) + (e) + (f) + (g) + (h) + (i) + (j) + (k) + (l) + (m) + (n) + (o) + (p))
+#define GESTURE_17TH_(a, b, c, d, e, f, g, h, i, j, k, l, m, n, o, p, q, ...) (q)
+
+/** Number of gestures. */
+#define GESTURE_COUNT    (0 PULSE_GESTURES(GESTURE_ONE))
+
+/** All gestures back to back, ms; bounds the longest one. */
+#define GESTURE_TOTAL_MS ((0 PULSE_GESTURES(GESTURE_ADD)) * GESTURE_MS)
+
+/**
+ * @brief Durations of gesture @p g (0-based): LOW first, then alternating, up to a 0.
+ */
+const uint8_t *gesture_code(uint8_t g);
+
+#endif /* GESTURE_H */
@@ -0,0 +1,64 @@
+/**
+ * @file hal.h
+ * @brief Hardware abstraction: MSP430 registers on target, a software model on the host.
+ *
+ * The firmware talks to the peripherals through the usual msp430.h register names and
+ * intrinsics. On target (__MSP430__) this is <msp430.h> itself, so the generated code is
+ * unchanged. Any other compiler gets host/hal_host.h, where each register name expands to an
+ * access through a model of the G2553 peripherals the firmware uses (BCS+, Timer_A, Port 1/2,
+ * ADC10, Comparator_A+, USCI_B0 in I2C mode, the flash controller) that runs on virtual time;
+ * see host/hal_host.c.
+ *
+ * Memory-mapped data outside the register file (Info flash, main flash areas reserved with
+ * @ref HAL_MAIN_FLASH) is read through @ref HAL_FLASH_PTR and programmed through
+ * @ref HAL_FLASH_WRITE (flash.h sets up the controller).
+ * Variables that must keep their value over a reset are marked @ref HAL_NOINIT.
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#if defined(__MSP430__)
+
+#include <msp430.h>
+#include <stdint.h>
+
+/** Pointer to flash at address @p addr. */
+#define HAL_FLASH_PTR(addr) ((void *)(addr))
+
+/** Word write to flash at @p addr: programs or erases, as the flash controller is set. */
+#define HAL_FLASH_WRITE(addr, w) (*(volatile uint16_t *)(addr) = (w))
+
+/**
+ * Reserve @p n bytes of main flash as @p name, in whole 512-byte segments of their own; the
+ * programmer leaves them erased. @ref HAL_MAIN_ADDR gives their address.
+ * - Not a const object: the flash controller erases and programs it, so the compiler must not
+ *   fold reads to the 0xFF image. A .text.* section puts it in flash with either linker script
+ *   (mspgcc, msp430-elf), and it is only read through @ref HAL_FLASH_PTR.
+ */
+#define HAL_MAIN_FLASH(name, n)                                                                   \
+    static volatile uint8_t name[n]                                                               \
+        __attribute__((section(".text.hal_main_" #name), aligned(512))) = {[0 ...(n) - 1] = 0xFF}
+#define HAL_MAIN_ADDR(name) ((uint16_t)(uintptr_t)(name))
+
+/** Left out of the startup zeroing: RAM keeps it over a reset, not over a power loss. */
+#define HAL_NOINIT          __attribute__((section(".noinit")))
+
+#else
+
+#include "host/hal_host.h"
+
+#define HAL_FLASH_PTR(addr)      ((void *)host_flash(addr))
+
+#define HAL_FLASH_WRITE(addr, w) host_flash_write((addr), (w))
+
+/* One area, at the modelled main flash segments */
+#define HAL_MAIN_FLASH(name, n)                                                                   \
+    _Static_assert((n) <= HOST_MAIN_SIZE, "main flash area " #name " outside the model")
+#define HAL_MAIN_ADDR(name)      (HOST_MAIN_BASE)
+
+#define HAL_NOINIT /* the model has no reset: zeroed like a power-up that reads invalid */
+
+#endif
+
+#endif /* HAL_H */
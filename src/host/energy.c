@@ -0,0 +1,291 @@
+/**
+ * @file energy.c
+ * @brief Charge accounting of the host build.
+ *
+ * The peripheral model reports how long it spends in each power mode, when the ADC10 and the
+ * reference switch, every wake-up from a low-power mode and the channel pins. At the end of
+ * the run the times are weighted with typical datasheet currents (25 degC, interpolated
+ * between the 2.2 V and 3 V columns) for each supported MCU:
+ * - active at 1 MHz, LPM0 at 1 MHz, LPM3 with the VLO, LPM4;
+ * - ADC10 core and 1.5 V reference plus temperature sensor, Comparator_A+ and its reference,
+ *   the flash while it erases or programs (IERASE, IPGM), added while they are on;
+ * - DCO start-up on every wake, charged at the active current;
+ * - the target's pull-up, sunk by each channel line while it is LOW (HOST_PULLUP_OHM, default
+ *   10 kOhm; 0 if the pull-up runs from the target's own supply). The pulse window runs while
+ *   any line is LOW; "per pulse" is per window, i.e. per LOW run or batch of them;
+ * - with expanders (PULSE_OUT), their standby current after boot: HOST_EXP_UA per chip,
+ *   default 2.5 uA for a PCF8574 and 0.1 uA for a 74HC595 (typical, not from the datasheets,
+ *   which give maxima only). Transfers are charged as active time of the MCU;
+ * - with resistor straps (HOST_STRAPS), VCC / HOST_STRAP_OHM through each strap whose pin is
+ *   driven against it, less through the REN pull; the row is printed only then.
+ *
+ * Boot (up to the first sleep: calibration, debug burst) is reported once; the rest is
+ * averaged per day and projected onto a battery of HOST_BATTERY_MAH (default 220, a CR2032)
+ * without self-discharge.
+ */
+
+/* ---------------- Includes ---------------- */
+#include "energy.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../chan.h"
+#include "../config.h"
+#include "hal_host.h"
+
+/* ---------------- Defines ---------------- */
+#define ENERGY_WAKE_S (1.5e-6) /* DCO start-up from LPM3/4, t(DCO,LPM3/4) */
+#if PULSE_OUT == PULSE_OUT_GPIO
+#define ENERGY_LINE(port, bit) ((port) == 0 && ((1u << (bit)) & (CHAN_PINS)) ? (int)(bit) : -1)
+#define ENERGY_EXP_UA          (0.0)
+#else
+#define ENERGY_LINE(port, bit) ((port) >= 2 ? (int)(((port) - 2u) * 8u + (bit)) : -1)
+#define ENERGY_EXP_UA          (PULSE_OUT == PULSE_OUT_PCF8574 ? 2.5 : 0.1)
+#endif
+
+/* ---------------- Types ---------------- */
+
+/** Accounted states: the power modes, then the additions. */
+enum energy_state {
+    ENERGY_S_ADC = ENERGY_MODES,
+    ENERGY_S_REF,
+    ENERGY_S_CA,
+    ENERGY_S_CAREF,
+    ENERGY_S_FLASH,
+    ENERGY_S_PIN,
+    ENERGY_S_EXP,
+    ENERGY_S_STRAP,
+    ENERGY_STATES
+};
+
+/** Phase of operation the time is booked to. */
+enum energy_phase {
+    ENERGY_P_BOOT,  /* power-up to the first sleep */
+    ENERGY_P_PULSE, /* a channel line LOW */
+    ENERGY_P_IDLE,  /* everything else */
+    ENERGY_PHASES
+};
+
+/** Typical currents in uA at 2.2 V and 3 V. */
+struct energy_mcu {
+    const char *name;
+    double      i[ENERGY_S_PIN][2]; /* per state up to the pin, which depends on the pull-up */
+};
+
+/* ---------------- Variables ---------------- */
+
+/* MSP430G2x53 (SLAS735) and MSP430G2x52 (SLAS722), typical at 25 degC; the two datasheets
+ * list the same figures */
+static const struct energy_mcu energy_mcus[] = {
+    {"MSP430G2553",
+     {{230.0, 330.0}, {56.0, 65.0}, {0.5, 0.5}, {0.1, 0.1}, {520.0, 600.0}, {310.0, 310.0},
+      {25.0, 45.0}, {30.0, 45.0}, {1000.0, 1000.0}}},
+    {"MSP430G2452",
+     {{230.0, 330.0}, {56.0, 65.0}, {0.5, 0.5}, {0.1, 0.1}, {520.0, 600.0}, {310.0, 310.0},
+      {25.0, 45.0}, {30.0, 45.0}, {1000.0, 1000.0}}},
+};
+
+static double            energy_t[ENERGY_PHASES][ENERGY_STATES]; /* s */
+static unsigned long     energy_wakes[ENERGY_PHASES];
+static unsigned long     energy_pulses;
+static enum energy_phase energy_phase = ENERGY_P_BOOT; /* boot, then idle */
+static double            energy_pulse_lo = -HUGE_VAL;  /* last pulse window, [lo, hi); */
+static double            energy_pulse_hi = -HUGE_VAL;  /* hi = HUGE_VAL while LOW */
+static uint64_t          energy_low;       /* channel lines LOW */
+static unsigned int      energy_low_n;     /* ... their number */
+static double            energy_low_t;     /* since */
+static unsigned int      energy_analog_on; /* ENERGY_ADC ... ENERGY_FLASH */
+static double            energy_analog_t;  /* since */
+static double            energy_strap_n = -1.0; /* straps conducting, -1 = none fitted */
+static double            energy_strap_t;   /* since */
+
+/* ---------------- Functions ---------------- */
+
+void energy_strap(double n, double t) {
+    if (energy_strap_n > 0.0) {
+        energy_t[energy_phase][ENERGY_S_STRAP] += (t - energy_strap_t) * energy_strap_n;
+    }
+    energy_strap_n = n;
+    energy_strap_t = t;
+}
+
+void energy_run(enum energy_mode mode, double t, double dt) {
+    double lo = t > energy_pulse_lo ? t : energy_pulse_lo;
+    double hi = t + dt < energy_pulse_hi ? t + dt : energy_pulse_hi;
+    double in = hi > lo ? hi - lo : 0.0; /* overlap with the pulse */
+
+    if (mode != ENERGY_AM && energy_phase == ENERGY_P_BOOT) {
+        if (energy_strap_n >= 0.0) {
+            energy_strap(energy_strap_n, t); /* boot's share */
+        }
+        energy_phase = ENERGY_P_IDLE;
+    }
+    if (energy_phase == ENERGY_P_BOOT) {
+        energy_t[ENERGY_P_BOOT][mode] += dt;
+        return;
+    }
+    energy_t[ENERGY_P_PULSE][mode] += in;
+    energy_t[ENERGY_P_IDLE][mode]  += dt - in;
+    if (PULSE_OUT != PULSE_OUT_GPIO) {
+        energy_t[ENERGY_P_PULSE][ENERGY_S_EXP] += in;
+        energy_t[ENERGY_P_IDLE][ENERGY_S_EXP]  += dt - in;
+    }
+}
+
+void energy_analog(unsigned int analog, double t) {
+    unsigned int s;
+
+    for (s = ENERGY_S_ADC; s < ENERGY_S_PIN; s++) {
+        if (energy_analog_on & (1u << (s - ENERGY_S_ADC))) {
+            energy_t[energy_phase][s] += t - energy_analog_t;
+        }
+    }
+    energy_analog_on = analog;
+    energy_analog_t  = t;
+}
+
+void energy_wake(void) {
+    energy_wakes[energy_pulse_hi == HUGE_VAL ? ENERGY_P_PULSE : energy_phase]++;
+}
+
+void energy_pin(unsigned int port, unsigned int bit, char level, double t) {
+    int      line = ENERGY_LINE(port, bit);
+    uint64_t m;
+
+    if (line < 0 || energy_phase == ENERGY_P_BOOT) {
+        return;
+    }
+    m = (uint64_t)1 << line;
+    if ((level == 'L') == !!(energy_low & m)) {
+        return;
+    }
+    /* the pull-up current of every line LOW so far */
+    energy_t[ENERGY_P_PULSE][ENERGY_S_PIN] += (t - energy_low_t) * energy_low_n;
+    energy_low_t                             = t;
+    energy_low                              ^= m;
+    if (level == 'L' && !energy_low_n++) {
+        energy_pulse_lo = t;
+        energy_pulse_hi = HUGE_VAL;
+        energy_pulses++;
+    } else if (level != 'L' && !--energy_low_n) {
+        energy_pulse_hi = t;
+    }
+}
+
+static double env_num(const char *name, double def) {
+    const char *v = getenv(name);
+    return v ? atof(v) : def;
+}
+
+/** Current in state @p s at @p vcc, uA. */
+static double energy_current(const struct energy_mcu *m, unsigned int s, double vcc, double pull) {
+    if (s == ENERGY_S_PIN) {
+        return pull;
+    }
+    if (s == ENERGY_S_EXP) {
+        return env_num("HOST_EXP_UA", ENERGY_EXP_UA) * EXP_COUNT;
+    }
+    if (s == ENERGY_S_STRAP) {
+        return vcc / env_num("HOST_STRAP_OHM", ENERGY_STRAP_OHM) * 1e6;
+    }
+    return m->i[s][0] + (m->i[s][1] - m->i[s][0]) * (vcc - 2.2) / 0.8;
+}
+
+/** Charge of phase(s) @p p0..p1 on @p m, uC. */
+static double energy_charge(const struct energy_mcu *m, unsigned int p0, unsigned int p1,
+                            double vcc, double pull) {
+    double       q = 0.0;
+    unsigned int p, s;
+
+    for (p = p0; p <= p1; p++) {
+        for (s = 0; s < ENERGY_STATES; s++) {
+            q += energy_t[p][s] * energy_current(m, s, vcc, pull);
+        }
+        q += (double)energy_wakes[p] * ENERGY_WAKE_S * energy_current(m, ENERGY_AM, vcc, pull);
+    }
+    return q;
+}
+
+void energy_report(double t, double vcc) {
+    static const char *const names[ENERGY_STATES] = {"active", "LPM0", "LPM3", "LPM4",
+                                                     "ADC10", "ref+sensor", "comparator",
+                                                     "comp. ref", "flash", "pulse pin",
+                                                     "expanders", "straps"};
+    const unsigned int n    = sizeof energy_mcus / sizeof energy_mcus[0];
+    double             ohm  = env_num("HOST_PULLUP_OHM", 10000.0);
+    double             mah  = env_num("HOST_BATTERY_MAH", 220.0);
+    double             pull = ohm > 0.0 ? vcc / ohm * 1e6 : 0.0;
+    double             days, boot = 0.0;
+    unsigned int       s, x;
+
+    energy_analog(energy_analog_on, t); /* book the blocks still on */
+    if (energy_strap_n >= 0.0) {
+        energy_strap(energy_strap_n, t); /* ... and the straps */
+    }
+    for (s = 0; s < ENERGY_MODES; s++) {
+        boot += energy_t[ENERGY_P_BOOT][s];
+    }
+    days = (t - boot) / 86400.0;
+    if (days <= 0.0) {
+        return;
+    }
+
+    printf("energy   typical currents at %.2f V, 25 degC; pull-up %.0f ohm; per day after boot\n",
+           vcc, ohm);
+    printf("  %-14s %14s", "state", "time/day");
+    for (x = 0; x < n; x++) {
+        printf(" %14s", energy_mcus[x].name);
+    }
+    printf("\n");
+    for (s = 0; s < ENERGY_STATES; s++) {
+        double ts = (energy_t[ENERGY_P_PULSE][s] + energy_t[ENERGY_P_IDLE][s]) / days;
+        if ((s == ENERGY_S_EXP && PULSE_OUT == PULSE_OUT_GPIO)
+            || (s == ENERGY_S_STRAP && energy_strap_n < 0.0)) {
+            continue;
+        }
+        printf("  %-14s %12.6f s", names[s], ts);
+        for (x = 0; x < n; x++) {
+            printf(" %11.3f uC", ts * energy_current(&energy_mcus[x], s, vcc, pull));
+        }
+        printf("\n");
+    }
+    printf("  %-14s %10.1f /day", "wake-ups",
+           (double)(energy_wakes[ENERGY_P_PULSE] + energy_wakes[ENERGY_P_IDLE]) / days);
+    for (x = 0; x < n; x++) {
+        printf(" %11.3f uC", (double)(energy_wakes[ENERGY_P_PULSE] + energy_wakes[ENERGY_P_IDLE])
+                                 / days * ENERGY_WAKE_S
+                                 * energy_current(&energy_mcus[x], ENERGY_AM, vcc, pull));
+    }
+    printf("\n  %-14s %16s", "total", "uAh/day");
+    for (x = 0; x < n; x++) {
+        printf(" %14.4f", energy_charge(&energy_mcus[x], ENERGY_P_PULSE, ENERGY_P_IDLE, vcc, pull)
+                              / days / 3600.0);
+    }
+    printf("\n  %-14s %16s", "", "average uA");
+    for (x = 0; x < n; x++) {
+        printf(" %14.4f", energy_charge(&energy_mcus[x], ENERGY_P_PULSE, ENERGY_P_IDLE, vcc, pull)
+                              / (days * 86400.0));
+    }
+    printf("\n  %-14s %16s", "per pulse", "uC");
+    for (x = 0; x < n; x++) {
+        printf(" %14.3f", energy_pulses ? energy_charge(&energy_mcus[x], ENERGY_P_PULSE,
+                                                        ENERGY_P_PULSE, vcc, pull)
+                                              / (double)energy_pulses
+                                        : 0.0);
+    }
+    printf("\n  %-14s %16s", "boot (once)", "uC");
+    for (x = 0; x < n; x++) {
+        printf(" %14.3f",
+               energy_charge(&energy_mcus[x], ENERGY_P_BOOT, ENERGY_P_BOOT, vcc, pull));
+    }
+    printf("\n  %-14s %16s", "battery", "years");
+    for (x = 0; x < n; x++) {
+        double uah = energy_charge(&energy_mcus[x], ENERGY_P_PULSE, ENERGY_P_IDLE, vcc, pull)
+                     / days / 3600.0;
+        printf(" %14.1f", mah * 1000.0 / uah / 365.25);
+    }
+    printf(" (%.0f mAh)\n", mah);
+}
@@ -0,0 +1,70 @@
+/**
+ * @file energy.h
+ * @brief Charge accounting of the host build (see energy.c); fed by the peripheral model.
+ */
+
+#ifndef ENERGY_H
+#define ENERGY_H
+
+/** Power mode, from the status register. */
+enum energy_mode {
+    ENERGY_AM,   /* CPU on; LPM1-2 are charged as active too (the firmware does not use them) */
+    ENERGY_LPM0, /* CPU off, DCO and SMCLK running (the console's USCI_A0) */
+    ENERGY_LPM3, /* DCO off, ACLK running */
+    ENERGY_LPM4, /* all clocks off */
+    ENERGY_MODES
+};
+
+/* Analog blocks that add to the mode current */
+#define ENERGY_ADC   (0x01u) /* ADC10 core on (ADC10ON) */
+#define ENERGY_REF   (0x02u) /* reference and temperature sensor on (REFON) */
+#define ENERGY_CA    (0x04u) /* Comparator_A+ on (CAON) */
+#define ENERGY_CAREF (0x08u) /* its reference ladder or diode on (CAON with CAREF) */
+#define ENERGY_FLASH (0x10u) /* flash erase or program running */
+
+#define ENERGY_STRAP_OHM (4700.0) /* resistor strap, HOST_STRAP_OHM default */
+
+/**
+ * @brief Account the virtual time from @p t to @p t + @p dt.
+ * - May come late (CPU time is run through the model lazily); pin and analog changes carry
+ *   their own time stamps and are matched against @p t.
+ * @param mode power mode throughout
+ * @param t    start, s
+ * @param dt   duration, s
+ */
+void energy_run(enum energy_mode mode, double t, double dt);
+
+/**
+ * @brief The analog blocks switched.
+ * @param analog ENERGY_ADC ... ENERGY_FLASH mask now on
+ * @param t      virtual time, s
+ */
+void energy_analog(unsigned int analog, double t);
+
+/** @brief An interrupt woke the CPU from a low-power mode (DCO start-up). */
+void energy_wake(void);
+
+/**
+ * @brief A port pin changed level.
+ * @param port 0 for P1, 1 for P2
+ * @param bit  pin number
+ * @param level 'L', 'H' or 'Z'
+ * @param t    virtual time, s
+ */
+void energy_pin(unsigned int port, unsigned int bit, char level, double t);
+
+/**
+ * @brief The current through the resistor straps (HOST_STRAPS) changed.
+ * @param n straps conducting, in units of VCC / HOST_STRAP_OHM
+ * @param t virtual time, s
+ */
+void energy_strap(double n, double t);
+
+/**
+ * @brief End of the run: print charge per state, per day and the projected battery life.
+ * @param t   virtual time, s
+ * @param vcc supply voltage, V
+ */
+void energy_report(double t, double vcc);
+
+#endif /* ENERGY_H */
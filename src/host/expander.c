@@ -0,0 +1,140 @@
+/**
+ * @file expander.c
+ * @brief Expander chips on the outputs of the host build (PULSE_OUT).
+ *
+ * Modelled, for EXP_COUNT chips:
+ * - PULSE_OUT_595: a 74HC595 daisy chain on the P2 pins EXP_SER_BIT, EXP_SCK_BIT and
+ *   EXP_RCK_BIT. SRCLK rising edges shift SER into chip 0, chip n's QH' feeding chip n + 1;
+ *   an RCLK rising edge moves the whole chain to the outputs. A set output holds its line LOW
+ *   (through the N-MOSFET), a clear one leaves it Hi-Z. The chain powers up cleared.
+ * - PULSE_OUT_PCF8574: PCF8574s answering at EXP_I2C_ADDR + n; other addresses are not
+ *   acknowledged. Each data byte goes to the port at once: a 0 holds the line LOW, a 1 is the
+ *   weak pull-up (HIGH), as at power-up.
+ *
+ * Line changes go to sim.c and energy.c as port 2 + chip, pin = line % 8.
+ */
+
+/* ---------------- Includes ---------------- */
+#include "expander.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../config.h"
+#include "energy.h"
+#include "hal_host.h"
+#include "sim.h"
+
+/* ---------------- Defines ---------------- */
+#define EXP_TRACE_BIT (0x10000ul) /* HOST_TRACE bit of the expander lines */
+
+/* ---------------- Variables ---------------- */
+#if PULSE_OUT != PULSE_OUT_GPIO
+static char exp_line[EXP_COUNT][8]; /* level per line: 'L', 'H' or 'Z'; 0 before the first */
+static int  exp_trace = -1;
+#endif
+#if PULSE_OUT == PULSE_OUT_595
+static char     exp_ser = 'L', exp_sck = 'L', exp_rck = 'L'; /* control pin levels */
+static uint64_t exp_shift; /* chip n in bits 8n..8n+7, QA in the lowest */
+#elif PULSE_OUT == PULSE_OUT_PCF8574
+static int      exp_chip = -1; /* addressed chip, -1 = none */
+#endif
+
+/* ---------------- Functions ---------------- */
+
+#if PULSE_OUT != PULSE_OUT_GPIO
+/** Line @p bit of chip @p chip is at @p level from @p t on. */
+static void exp_set(unsigned int chip, unsigned int bit, char level, double t) {
+    char was = exp_line[chip][bit];
+
+    if (was == level) {
+        return;
+    }
+    exp_line[chip][bit] = level;
+    if (!was && level != 'L') {
+        return; /* power-up state, not a change */
+    }
+    if (level == 'L') {
+        host_press(t);
+    }
+    sim_pin(2u + chip, bit, level, t);
+    energy_pin(2u + chip, bit, level, t);
+    if (exp_trace < 0) {
+        const char *trace = getenv("HOST_TRACE");
+        exp_trace         = trace && (strtoul(trace, NULL, 16) & EXP_TRACE_BIT);
+    }
+    if (exp_trace) {
+        printf("%14.6f X%u.%u %c\n", t, chip, bit, level);
+    }
+}
+#endif
+
+void expander_pin(unsigned int port, unsigned int bit, char level, double t) {
+#if PULSE_OUT == PULSE_OUT_595
+    unsigned int m = 1u << bit;
+    unsigned int c, b;
+
+    if (port != 1) {
+        return;
+    }
+    if (m == (EXP_SER_BIT)) {
+        exp_ser = level;
+    }
+    if (m == (EXP_SCK_BIT)) {
+        if (level == 'H' && exp_sck != 'H') {
+            exp_shift = exp_shift << 1 | (exp_ser == 'H');
+        }
+        exp_sck = level;
+    }
+    if (m == (EXP_RCK_BIT)) {
+        if (level == 'H' && exp_rck != 'H') {
+            for (c = 0; c < EXP_COUNT; c++) {
+                for (b = 0; b < 8; b++) {
+                    exp_set(c, b, (exp_shift >> (8u * c + b)) & 1u ? 'L' : 'Z', t);
+                }
+            }
+        }
+        exp_rck = level;
+    }
+#else
+    (void)port;
+    (void)bit;
+    (void)level;
+    (void)t;
+#endif
+}
+
+int expander_i2c_start(unsigned int addr, double t) {
+    (void)t;
+#if PULSE_OUT == PULSE_OUT_PCF8574
+    exp_chip = addr >= EXP_I2C_ADDR && addr < EXP_I2C_ADDR + EXP_COUNT ? (int)(addr - EXP_I2C_ADDR)
+                                                                       : -1;
+    return exp_chip >= 0;
+#else
+    (void)addr;
+    return 0;
+#endif
+}
+
+void expander_i2c_byte(uint8_t v, double t) {
+#if PULSE_OUT == PULSE_OUT_PCF8574
+    unsigned int b;
+
+    if (exp_chip < 0) {
+        return;
+    }
+    for (b = 0; b < 8; b++) {
+        exp_set((unsigned int)exp_chip, b, (v >> b) & 1u ? 'H' : 'L', t);
+    }
+#else
+    (void)v;
+    (void)t;
+#endif
+}
+
+void expander_i2c_stop(double t) {
+    (void)t;
+#if PULSE_OUT == PULSE_OUT_PCF8574
+    exp_chip = -1;
+#endif
+}
@@ -0,0 +1,40 @@
+/**
+ * @file expander.h
+ * @brief Expander chips on the outputs of the host build (see expander.c); driven by the
+ *        peripheral model.
+ */
+
+#ifndef EXPANDER_H
+#define EXPANDER_H
+
+#include <stdint.h>
+
+/**
+ * @brief An MCU port pin changed level (the 74HC595 control pins).
+ * @param port 0 for P1, 1 for P2
+ * @param bit  pin number
+ * @param level 'L', 'H' or 'Z'
+ * @param t    virtual time, s
+ */
+void expander_pin(unsigned int port, unsigned int bit, char level, double t);
+
+/**
+ * @brief I2C START (or repeated START) with a write to 7-bit address @p addr.
+ * @param t virtual time, s
+ * @return 1 if a PCF8574 acknowledges it
+ */
+int expander_i2c_start(unsigned int addr, double t);
+
+/**
+ * @brief Data byte @p v to the addressed PCF8574; its port follows at once.
+ * @param t virtual time, s
+ */
+void expander_i2c_byte(uint8_t v, double t);
+
+/**
+ * @brief I2C STOP.
+ * @param t virtual time, s
+ */
+void expander_i2c_stop(double t);
+
+#endif /* EXPANDER_H */
@@ -0,0 +1,1440 @@
+/**
+ * @file hal_host.c
+ * @brief Peripheral model behind host/hal_host.h.
+ *
+ * Virtual time only moves when the firmware spends it: a few MCLK cycles per register access,
+ * __delay_cycles(), interrupt entry and return, and sleep. Sleep jumps straight to the next
+ * timer event, counting past compare matches that only set a flag, so a day in LPM3 costs a
+ * few hundred model steps. Active time is kept as a debt and run through the peripherals in
+ * one step once it can show: at a timer event or capture edge, a TAR read a count on, a clock
+ * or timer mode change, and sleep. A flash erase or write, an ADC conversion and an I2C or UART
+ * transfer complete at once and add their whole time to it, so a busy-wait on their flag ends
+ * at the first read and a whole wake usually costs one step. A polling loop (one or two
+ * registers read in turn while the register file stays unchanged, @ref HOST_SPIN_ACCESSES
+ * times) jumps ahead to the next event; loops that count their own iterations see fewer of them.
+ *
+ * Modelled:
+ * - BCS+: DCO (1 MHz when loaded with the TLV calibration, ~1.1 MHz otherwise), VLO as ACLK
+ *   with DIVA, MCLK/SMCLK dividers; SMCLK stops with SCG1, ACLK with OSCOFF.
+ * - Timer_A: stop/up/continuous modes, ID, TACLR, compare flags, TAIFG, TAIV, captures of ACLK
+ *   (CCI0B, CCI2B), output modes 0, 1, 4 and 5.
+ * - Port 1/2: pin levels from DIR/OUT/SEL, TA0.0/TA0.1 outputs; inputs read the external drive,
+ *   else a resistor strap, else the REN pull, else HIGH (target pull-ups); edge flags (IES/IFG)
+ *   and port interrupts. A strap draws current while its pin is driven or pulled the other way.
+ * - ADC10: single conversions of the temperature sensor and VCC/2, completed at once.
+ * - Comparator_A+: CAOUT of the node's divided rail (HOST_RAIL, on every CAx input) against
+ *   the CAREF reference on the other terminal (CARSEL); CAIFG on the CAIES edge while CAON.
+ *   CAOUT reads 0 while off; CAEX, CASHORT and the filter delay are not modelled.
+ * - USCI_B0 as I2C master transmitter: START with the address, data bytes and STOP go to the
+ *   chips of expander.c whole, each byte taking its 9 SCL periods (SMCLK / UCB0BR) of CPU time
+ *   at once; UCB0TXIFG is set on START and after each byte, UCNACKIFG if the address is not
+ *   acknowledged. UCB0TXBUF is write-only to the firmware: any access to it counts as a write.
+ * - USCI_A0 as UART 8N1 on SMCLK, at SMCLK / (UCA0BR + UCBRS / 8): a UCA0TXBUF write goes to
+ *   the terminal of term.c whole if P1.2 is selected for it, taking 10 bit times of CPU time at
+ *   once (access counts as a write, as for USCI_B0); UCA0TXIFG is set in reset and after each
+ *   character. A character from the terminal lands in UCA0RXBUF with UCA0RXIFG if the USCI was
+ *   out of reset, P1.1 selected and SMCLK running at its start bit; reading UCA0RXBUF clears
+ *   the flag. Errors and overruns are not modelled.
+ * - Flash controller: segment erase and word programming through HAL_FLASH_WRITE, of Info
+ *   flash (64-byte segments) and of four main flash segments (512 bytes, at HOST_MAIN_BASE) for
+ *   a HAL_MAIN_FLASH area, with the FCTL key, LOCK and LOCKA; each takes 4819 or 30 cycles of
+ *   the timing generator (FSSEL clock / (FN + 1), which must be 257..476 kHz) with the CPU held
+ *   and the flash current on. A write while locked sets ACCVIFG and changes nothing; a key
+ *   violation ends the run (a PUC on the device). Writes below the 2.2 V minimum are counted.
+ *
+ * Settings (environment):
+ * - HOST_DAYS   : virtual days to run, then exit (default 3)
+ * - HOST_VLO_HZ : actual VLO frequency at 25 degC (default 11805)
+ * - HOST_VLO_TC : VLO temperature coefficient in ppm/degC (default 0)
+ * - HOST_TEMP_C : mean die temperature (default 25)
+ * - HOST_TEMP_SWING : amplitude of a daily sine around HOST_TEMP_C, degC (default 0)
+ * - HOST_VCC    : supply voltage (default 3.0)
+ * - HOST_DISCHARGE : deep discharges of the supply, "<every days>:<lowest V>:<hours>"; VCC falls
+ *   linearly to the lowest voltage and back within the hours, once every <every days>
+ * - HOST_NOCAL  : blank TLV calibration (CALBC1_1MHZ = 0xFF)
+ * - HOST_INFO   : Intel HEX file loaded into Info flash and the main flash area (e.g.
+ *   tools/tempcomp_table.py output)
+ * - HOST_INFO_OUT : Intel HEX file both are saved to at the end; loaded again with HOST_INFO,
+ *   the next run starts from it like a watcher powered up again
+ * - HOST_TRACE  : pins to trace as a hex mask, P1 in bits 0-7, P2 in bits 8-15, all expander
+ *   lines in bit 16 (default 0)
+ * - HOST_PULSES : 0 prints only the summary of the pulse report (sim.c)
+ * - HOST_HEARTBEAT : a node driving an input pin,
+ *   "<port>.<bit>:<period s>[:<hang days>[:<presses>]]"; the pin toggles every half period, stops
+ *   <hang days> after the node started (it hangs) and starts again at the <presses>-th (default
+ *   1) Hi-Z to LOW edge of an MCU pin after that (the reset pulse)
+ * - HOST_RAIL  : the node's rail on the comparator inputs, "<every days>:<off hours>[:<V>]"; the
+ *   divided rail reads <V> (default 1.65), and 0 for <off hours> once every <every days>
+ * - HOST_STRAPS : resistor straps, "<port>.<bit>:<L|H>[,...]", each pin tied to GND (L) or VCC
+ *   (H) through HOST_STRAP_OHM (default 4.7 kOhm), against the ~35 kOhm REN pull
+ * - HOST_CONSOLE, HOST_CONSOLE_BAUD, HOST_CONSOLE_OUT : a serial terminal on P1.1 and P1.2
+ *   (term.c), the lines it types and where its output goes
+ * - HOST_PULLUP_OHM, HOST_BATTERY_MAH, HOST_EXP_UA : load, cell and expander standby current of
+ *   the energy report (energy.c)
+ *
+ * expander.c models the 74HC595 chain or PCF8574s on the outputs (PULSE_OUT), term.c the
+ * terminal on the console pins (CONSOLE_BAUD).
+ * sim.c watches the pulse pin and prints the pulse report; the exit status is its verdict.
+ * energy.c books the time per power mode and prints the charge report after it.
+ */
+
+/* ---------------- Includes ---------------- */
+#include "hal_host.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "energy.h"
+#include "expander.h"
+#include "sim.h"
+#include "term.h"
+
+/* ---------------- Defines ---------------- */
+#define HOST_IO_CYCLES    (3u) /* MCLK cycles per register access */
+#define HOST_IRQ_CYCLES   (6u) /* interrupt entry */
+#define HOST_RETI_CYCLES  (5u) /* RETI */
+#define HOST_SPIN_ACCESSES (4u) /* unchanged accesses before a polling loop is skipped ahead */
+#define HOST_NEVER        (0xFFFFFFFFul)
+#define HOST_2PI          (6.283185307179586)
+#define HOST_SEG_ERASE    (4819.0) /* flash timing generator cycles per segment erase */
+#define HOST_WORD_WRITE   (30.0)   /* ... per word written */
+#define HOST_PULL_OHM     (35000.0) /* REN pull resistor, typical */
+/* 8-bit register file padded to 16-byte words: apply() compares it inline at every access */
+#define HOST_REG8_SIZE    ((HOST_REG8_COUNT + 15) & ~15)
+
+/* ---------------- ISRs (main.c) ---------------- */
+void TIMER0_A0_ISR(void) __attribute__((weak));
+void TIMER0_A1_ISR(void) __attribute__((weak));
+void ADC10_ISR(void) __attribute__((weak));
+void PORT1_ISR(void) __attribute__((weak));
+void PORT2_ISR(void) __attribute__((weak));
+void USCIAB0RX_ISR(void) __attribute__((weak));
+void COMPARATORA_ISR(void) __attribute__((weak));
+
+/* ---------------- Variables ---------------- */
+uint8_t host_info[HOST_INFO_SIZE];
+uint8_t host_main[HOST_MAIN_SIZE];
+
+static uint8_t      r8[HOST_REG8_SIZE];
+static uint16_t     r16[HOST_REG16_COUNT];
+
+static double       t_now;        /* virtual time, s */
+static double       t_debt;       /* CPU time not yet run through the peripherals, s */
+static double       t_end;        /* exit at this time */
+static double       t_active;     /* time with the CPU on, s */
+static double       cycle_s;      /* MCLK period, s */
+static double       vlo_hz;       /* actual VLO frequency at 25 degC */
+static double       vlo_tc;       /* VLO temperature coefficient, 1/degC */
+static double       temp_c;       /* mean die temperature */
+static double       temp_swing;   /* daily temperature swing amplitude */
+static uint64_t     ta_aclk;      /* Timer_A counts from ACLK since power-up */
+static double       vcc;          /* supply voltage */
+static double       dis_every;    /* discharge period, s; 0 = none */
+static double       dis_min;      /* lowest VCC of a discharge */
+static double       dis_len;      /* discharge duration, s */
+static double       ta_frac;      /* progress towards the next timer count */
+static double       aclk_frac;    /* ACLK phase: rising edge at 0, falling edge at 0.5 */
+static unsigned int sr;           /* status register */
+static unsigned int sr_exit_clear; /* bits cleared from the stacked SR by the running ISR */
+static uint8_t      ta_out[3];    /* output unit per capture/compare channel */
+static char         pin[2][8];    /* last traced level per pin: 'L', 'H' or 'Z' */
+static char         strap[2][8];  /* HOST_STRAPS tie per pin: 'L', 'H' or 0 for none */
+static double       strap_ohm;    /* ... through this */
+static double       strap_n = -1.0; /* straps conducting, in VCC / strap_ohm; -1 = not yet */
+static unsigned int trace_mask;
+
+static int          hb_port = -1; /* HOST_HEARTBEAT pin, -1 = none */
+static unsigned int hb_bit;
+static double       hb_half;      /* half period, s */
+static double       hb_hang;      /* hang interval, s; 0 = never */
+static double       hb_next;      /* next toggle, HUGE_VAL while hung */
+static double       hb_hang_next; /* next hang, <hang days> after the last start */
+static unsigned int hb_presses = 1; /* presses a hung node needs */
+static unsigned int hb_pressed;     /* ... and has had */
+static char         hb_level = 'L';
+
+static double       rail_v;       /* HOST_RAIL comparator input while the rail is up */
+static double       rail_every;   /* rail drop period, s; 0 = never */
+static double       rail_off;     /* drop duration, s */
+static double       rail_next = HUGE_VAL; /* next drop or return */
+static int          rail_up = 1;
+
+static uint8_t      spin8[HOST_REG8_SIZE];    /* register file at the previous access */
+static uint16_t     spin16[HOST_REG16_COUNT];
+static unsigned int spins;                     /* polling accesses without a change */
+static int          spin_break;                /* register file changed since the last access */
+static int          spin_id[2];                /* last two registers accessed */
+
+static int          ev_ok;        /* ev_* still describe the peripherals */
+static double       ev_n;         /* timer counts to the next timer event */
+static double       ev_edge;      /* ACLK phase of the next capture edge */
+static double       ev_ta_hz;     /* timer count rate */
+static double       ev_aclk_hz;   /* ACLK rate */
+static int          ev_alive;     /* step() result */
+static double       ev_count;     /* t_now + t_debt short of this shows nothing (observe()) */
+static double       ev_event;     /* ... nothing but TAR */
+static uint16_t     ev_tar;       /* TAR as the model left it */
+
+static int          i2c_on;       /* USCI_B0 out of reset */
+static int          i2c_busy;     /* between START and STOP */
+static int          i2c_tx;       /* UCB0TXBUF written, not yet sent */
+
+static int          term_on;      /* a terminal on P1.1 and P1.2 (HOST_CONSOLE) */
+static int          uart_on;      /* USCI_A0 out of reset */
+static int          uart_tx;      /* UCA0TXBUF written, not yet sent */
+static int          uart_rx;      /* USCI_A0 receives the character on P1.1 */
+static double       uart_rx_baud; /* at its bit rate then, bit/s */
+
+static unsigned long flash_erases[HOST_INFO_SIZE / 64u + HOST_MAIN_SIZE / 512u]; /* per segment */
+static unsigned long flash_words;                                               /* programmed */
+static unsigned long flash_low;  /* erases and words below 2.2 V */
+
+static const enum host_reg16 cctl[3] = {HOST_TACCTL0, HOST_TACCTL1, HOST_TACCTL2};
+static const enum host_reg16 ccr[3]  = {HOST_TACCR0, HOST_TACCR1, HOST_TACCR2};
+
+static void pins_update(void);
+static void observe(int counts);
+static void settle(void);
+static void spend(double dt);
+
+/* ---------------- Environment ---------------- */
+
+static double temp_now(void) {
+    return temp_swing == 0.0 ? temp_c : temp_c + temp_swing * sin(HOST_2PI * t_now / 86400.0);
+}
+
+static double vcc_now(void) {
+    double x;
+
+    if (dis_every <= 0.0 || t_now < dis_every || fmod(t_now, dis_every) >= dis_len) {
+        return vcc;
+    }
+    x = fmod(t_now, dis_every) / dis_len;
+    return vcc - (vcc - dis_min) * (1.0 - fabs(2.0 * x - 1.0));
+}
+
+/* ---------------- Clocks ---------------- */
+
+static double dco_hz(void) {
+    if (r8[HOST_CALBC1_1MHZ] != 0xFF && (r8[HOST_BCSCTL1] & 0x0F) == (r8[HOST_CALBC1_1MHZ] & 0x0F)
+        && r8[HOST_DCOCTL] == r8[HOST_CALDCO_1MHZ]) {
+        return 1e6;
+    }
+    return 1.1e6; /* reset setting */
+}
+
+static double mclk_hz(void) {
+    return dco_hz() / (1u << ((r8[HOST_BCSCTL2] >> 4) & 3u));
+}
+
+static double smclk_hz(void) {
+    return (sr & SCG1) ? 0.0 : dco_hz() / (1u << ((r8[HOST_BCSCTL2] >> 1) & 3u));
+}
+
+static double aclk_hz(void) {
+    if ((sr & OSCOFF) || (r8[HOST_BCSCTL3] & LFXT1S_3) != LFXT1S_2) {
+        return 0.0; /* no crystal fitted: only the VLO runs */
+    }
+    return vlo_hz * (1.0 + vlo_tc * (temp_now() - 25.0)) / (1u << ((r8[HOST_BCSCTL1] >> 4) & 3u));
+}
+
+/* ---------------- Timer_A ---------------- */
+
+static double ta_hz(void) {
+    double src;
+    switch (r16[HOST_TACTL] & MC_3) {
+    case MC_0:
+        return 0.0;
+    case MC_3:
+        fprintf(stderr, "host: Timer_A up/down mode is not modelled\n");
+        exit(2);
+    default:
+        break;
+    }
+    switch (r16[HOST_TACTL] & TASSEL_3) {
+    case TASSEL_1:
+        src = aclk_hz();
+        break;
+    case TASSEL_2:
+        src = smclk_hz();
+        break;
+    default:
+        src = 0.0;
+        break;
+    }
+    return src / (1u << ((r16[HOST_TACTL] >> 6) & 3u));
+}
+
+/**
+ * @brief Timer_A sets @p mask bits of register @p r to @p v by itself: a flag, a capture, TAIV.
+ *        Not a write for apply() to act on, but a change that breaks a polling spin.
+ */
+static void ta_set(unsigned int r, uint16_t mask, uint16_t v) {
+    r16[r]     = (uint16_t)((r16[r] & ~mask) | (v & mask));
+    spin16[r]  = (uint16_t)((spin16[r] & ~mask) | (v & mask));
+    spin_break = 1;
+}
+
+/** Counts until TAR next becomes @p target (0 for the rollover). */
+static uint32_t ta_dist(uint16_t target) {
+    uint16_t tar  = r16[HOST_TAR];
+    uint16_t ccr0 = r16[HOST_TACCR0];
+
+    if ((r16[HOST_TACTL] & MC_3) == MC_2) {
+        return target > tar ? (uint32_t)(target - tar) : 0x10000ul - tar + target;
+    }
+    if (target > ccr0) {
+        return HOST_NEVER;
+    }
+    if (tar > ccr0) {
+        return 1ul + target; /* period shortened below TAR: rolls to zero */
+    }
+    return target > tar ? (uint32_t)(target - tar) : (uint32_t)(ccr0 - tar) + 1ul + target;
+}
+
+/**
+ * @brief True if a compare match of channel control @p c only sets CCIFG: no interrupt, no
+ *        output change. Asleep, nothing polls the flag and TAR counts past such matches.
+ */
+static int ta_silent(uint16_t c) {
+    return (sr & CPUOFF) && !(c & (CAP | CCIE)) && (c & OUTMOD_7) == OUTMOD_0;
+}
+
+/** Counts until the next compare match or rollover. */
+static uint32_t ta_next(void) {
+    uint32_t     n = ta_dist(0);
+    unsigned int x;
+
+    for (x = 0; x < 3; x++) {
+        if (!(r16[cctl[x]] & CAP) && !ta_silent(r16[cctl[x]])) {
+            uint32_t d = ta_dist(r16[ccr[x]]);
+            n          = d < n ? d : n;
+        }
+    }
+    return n;
+}
+
+static void ta_output(unsigned int x) {
+    switch (r16[cctl[x]] & OUTMOD_7) {
+    case OUTMOD_1:
+        ta_out[x] = 1;
+        break;
+    case OUTMOD_4:
+        ta_out[x] ^= 1;
+        break;
+    case OUTMOD_5:
+        ta_out[x] = 0;
+        break;
+    default:
+        break;
+    }
+}
+
+/** Count @p n times; never past ta_next(), but past silent matches (flagged on the way). */
+static void ta_count(uint32_t n) {
+    uint32_t     from = r16[HOST_TAR];
+    uint32_t     v    = from + n;
+    uint32_t     top;
+    unsigned int x;
+
+    if (n == 0) {
+        return;
+    }
+    if ((r16[HOST_TACTL] & TASSEL_3) == TASSEL_1) {
+        if ((ta_aclk >> 32) != ((ta_aclk + n) >> 32)) {
+            /* the count that wraps sched_time_t, within a sleep counted at once */
+            uint32_t k = (uint32_t)(0x100000000ull - (ta_aclk & 0xFFFFFFFFull));
+            sim_wrap(t_now - (double)(n - k) / ta_hz());
+        }
+        ta_aclk += n;
+    }
+    top = (r16[HOST_TACTL] & MC_3) == MC_2 ? 0xFFFFul : r16[HOST_TACCR0];
+    if (from > top || v > top) {
+        ta_set(HOST_TACTL, TAIFG, TAIFG);
+        r16[HOST_TAR] = 0;
+    } else {
+        r16[HOST_TAR] = (uint16_t)v;
+    }
+    for (x = 0; x < 3; x++) {
+        uint32_t c = r16[ccr[x]];
+        if (ta_silent(r16[cctl[x]]) && c > from && c < v && c <= top) {
+            ta_set(cctl[x], CCIFG, CCIFG);
+        } else if (!(r16[cctl[x]] & CAP) && c == r16[HOST_TAR]) {
+            ta_set(cctl[x], CCIFG, CCIFG);
+            ta_output(x);
+            pins_update(); /* output unit edges land on the match */
+        }
+    }
+}
+
+/** True if channel control @p c captures ACLK (CCIxB of CCR0 and CCR2). */
+static int captures_aclk(uint16_t c) {
+    return (c & CAP) && (c & CCIS_3) == CCIS_1 && (c & CM_3);
+}
+
+static void ta_capture(int rising) {
+    unsigned int x;
+
+    for (x = 0; x < 3; x += 2) {
+        uint16_t c = r16[cctl[x]];
+        uint16_t f = (c & CCIFG) ? COV : CCIFG;
+        if (captures_aclk(c) && (c & (rising ? CM_1 : CM_2))) {
+            ta_set(ccr[x], 0xFFFFu, r16[HOST_TAR]);
+            ta_set(cctl[x], f, f);
+        }
+    }
+}
+
+/* ---------------- Ports ---------------- */
+
+static char pin_level(unsigned int port, unsigned int bit) {
+    uint8_t m   = (uint8_t)(1u << bit);
+    uint8_t dir = r8[port ? HOST_P2DIR : HOST_P1DIR];
+    uint8_t out = r8[port ? HOST_P2OUT : HOST_P1OUT];
+    uint8_t sel = r8[port ? HOST_P2SEL : HOST_P1SEL] & ~r8[port ? HOST_P2SEL2 : HOST_P1SEL2];
+
+    if (!(dir & m)) {
+        return 'Z';
+    }
+    if (port == 0 && (sel & m)) {
+        if (m == BIT1 || m == BIT5) {
+            return ta_out[0] ? 'H' : 'L';
+        }
+        if (m == BIT2 || m == BIT6) {
+            return ta_out[1] ? 'H' : 'L';
+        }
+    }
+    return (out & m) ? 'H' : 'L';
+}
+
+static uint8_t port_in(unsigned int port) {
+    uint8_t      ren = r8[port ? HOST_P2REN : HOST_P1REN];
+    uint8_t      out = r8[port ? HOST_P2OUT : HOST_P1OUT];
+    uint8_t      v   = 0;
+    unsigned int bit;
+    for (bit = 0; bit < 8; bit++) {
+        char l = pin_level(port, bit);
+        if (l == 'Z' && (int)port == hb_port && bit == hb_bit) {
+            l = hb_level;
+        } else if (l == 'Z' && term_on && port == 0 && bit == 1u) {
+            l = term_level();
+        } else if (l == 'Z' && strap[port][bit]) {
+            l = strap[port][bit]; /* the tie wins over the pull */
+        } else if (l == 'Z' && (ren & (1u << bit))) {
+            l = (out & (1u << bit)) ? 'H' : 'L';
+        }
+        v |= (uint8_t)((l != 'L') << bit); /* Hi-Z reads the target pull-up */
+    }
+    return v;
+}
+
+static void pins_update(void) {
+    static uint8_t last[10];
+    uint8_t        now[10] = {r8[HOST_P1DIR], r8[HOST_P1OUT], r8[HOST_P1SEL], r8[HOST_P1SEL2],
+                              r8[HOST_P2DIR], r8[HOST_P2OUT], r8[HOST_P2SEL], r8[HOST_P2SEL2],
+                              ta_out[0],      ta_out[1]};
+    unsigned int   port, bit;
+
+    if (!memcmp(now, last, sizeof now) && t_now > 0.0) {
+        return;
+    }
+    memcpy(last, now, sizeof now);
+    for (port = 0; port < 2; port++) {
+        for (bit = 0; bit < 8; bit++) {
+            char l = pin_level(port, bit);
+            if (l != pin[port][bit]) {
+                if (pin[port][bit] == 'Z' && l == 'L') {
+                    host_press(t_now + t_debt);
+                }
+                pin[port][bit] = l;
+                sim_pin(port, bit, l, t_now + t_debt);
+                energy_pin(port, bit, l, t_now + t_debt);
+                expander_pin(port, bit, l, t_now + t_debt);
+                term_pin(port, bit, l, t_now + t_debt);
+                ev_ok = 0; /* the terminal may start reading a character */
+                if (trace_mask & (1u << (port * 8u + bit))) {
+                    printf("%14.6f P%u.%u %c\n", t_now + t_debt, port + 1u, bit, l);
+                }
+            }
+        }
+    }
+}
+
+/** Book the current through the straps: a pin driven against its tie, or pulled against it. */
+static void straps_update(void) {
+    double       n = 0.0;
+    unsigned int port, bit;
+
+    for (port = 0; port < 2; port++) {
+        uint8_t ren = r8[port ? HOST_P2REN : HOST_P1REN];
+        uint8_t out = r8[port ? HOST_P2OUT : HOST_P1OUT];
+        for (bit = 0; bit < 8; bit++) {
+            char l = pin_level(port, bit);
+            if (!strap[port][bit]) {
+                continue;
+            }
+            if (l == 'Z' && (ren & (1u << bit))) {
+                l  = (out & (1u << bit)) ? 'H' : 'L';
+                n += l != strap[port][bit] ? strap_ohm / (strap_ohm + HOST_PULL_OHM) : 0.0;
+            } else if (l != 'Z' && l != strap[port][bit]) {
+                n += 1.0;
+            }
+        }
+    }
+    if (n != strap_n) {
+        strap_n = n;
+        energy_strap(n, t_now + t_debt);
+    }
+}
+
+/** The node toggles the heartbeat pin at hb_next. */
+static void heartbeat(void) {
+    uint8_t m   = (uint8_t)(1u << hb_bit);
+    uint8_t ies = r8[hb_port ? HOST_P2IES : HOST_P1IES];
+
+    hb_level = hb_level == 'L' ? 'H' : 'L';
+    if (pin_level((unsigned int)hb_port, hb_bit) == 'Z' && ((hb_level == 'H') == !(ies & m))) {
+        r8[hb_port ? HOST_P2IFG : HOST_P1IFG] |= m;
+    }
+    sim_input((unsigned int)hb_port, hb_bit, hb_level, hb_next);
+    if (trace_mask & (1u << (hb_port * 8u + hb_bit))) {
+        printf("%14.6f P%u.%u %c (node)\n", hb_next, hb_port + 1u, hb_bit, hb_level);
+    }
+    hb_next += hb_half;
+    if (hb_hang > 0.0 && hb_next >= hb_hang_next) {
+        hb_next = HUGE_VAL;
+    }
+}
+
+/** SMCLK cycles per bit of USCI_A0: UCA0BR and the UCBRS modulation. */
+static double uart_div(void) {
+    return (r8[HOST_UCA0BR0] | r8[HOST_UCA0BR1] << 8) + ((r8[HOST_UCA0MCTL] >> 1) & 7u) / 8.0;
+}
+
+/** The terminal's event at term_next(): the line into P1.1 changes, or a character ends. */
+static void terminal(void) {
+    uint8_t b;
+    char    was = term_level();
+
+    switch (term_step(&b)) {
+    case TERM_START:
+        uart_rx = uart_on && (r8[HOST_P1SEL] & r8[HOST_P1SEL2] & BIT1) && smclk_hz() > 0.0;
+        uart_rx_baud = uart_rx ? smclk_hz() / uart_div() : 0.0;
+        break;
+    case TERM_BYTE:
+        if (uart_rx) {
+            r8[HOST_UCA0RXBUF]  = fabs(uart_rx_baud / term_baud() - 1.0) > 0.04 ? (uint8_t)~b : b;
+            r8[HOST_IFG2]      |= UCA0RXIFG;
+            uart_rx             = 0;
+        }
+        break;
+    default:
+        break;
+    }
+    if (was == 'H' && term_level() == 'L' && pin_level(0, 1) == 'Z' && !(r8[HOST_P1SEL] & BIT1)
+        && (r8[HOST_P1IES] & BIT1)) {
+        r8[HOST_P1IFG] |= BIT1;
+    }
+}
+
+/* ---------------- USCI_A0 (UART) ---------------- */
+
+/** Carry out what the firmware asked of the UART since the last access. */
+static void uart_update(void) {
+    uint8_t ctl1 = r8[HOST_UCA0CTL1];
+    double  baud;
+
+    if (ctl1 & UCSWRST) {
+        uart_on = uart_tx = uart_rx = 0;
+        r8[HOST_IFG2] = (uint8_t)((r8[HOST_IFG2] & ~UCA0RXIFG) | UCA0TXIFG);
+        return;
+    }
+    if (!uart_on) {
+        uart_on = 1;
+        if (r8[HOST_UCA0CTL0] != 0 || (ctl1 & UCSSEL_3) != UCSSEL_2
+            || !(r8[HOST_UCA0BR0] | r8[HOST_UCA0BR1])) {
+            fprintf(stderr, "host: only the UART 8N1 on SMCLK is modelled for USCI_A0\n");
+            exit(2);
+        }
+    }
+    if (!uart_tx) {
+        return;
+    }
+    uart_tx    = 0;
+    spin_break = 1; /* a character went out, even if the registers read the same */
+    baud       = smclk_hz() / uart_div(); /* CPU active */
+    spend(10.0 / baud);
+    if (term_on && (r8[HOST_P1SEL] & r8[HOST_P1SEL2] & BIT2)) {
+        term_byte(r8[HOST_UCA0TXBUF], baud, t_now + t_debt);
+    }
+    r8[HOST_IFG2] |= UCA0TXIFG;
+}
+
+/* ---------------- USCI_B0 (I2C) ---------------- */
+
+/** Carry out what the firmware asked of the I2C master since the last access. */
+static void i2c_update(void) {
+    uint8_t ctl1 = r8[HOST_UCB0CTL1];
+    double  t    = t_now + t_debt;
+    double  scl;
+
+    if (ctl1 & UCSWRST) {
+        if (i2c_busy) {
+            expander_i2c_stop(t); /* reset in the middle of a transfer */
+        }
+        i2c_on = i2c_busy = i2c_tx  = 0;
+        r8[HOST_IFG2]              &= ~(UCB0TXIFG | UCB0RXIFG);
+        r8[HOST_UCB0STAT]           = 0;
+        r8[HOST_UCB0CTL1]          &= ~(UCTXSTT | UCTXSTP);
+        return;
+    }
+    if (!i2c_on) {
+        i2c_on = 1;
+        if ((r8[HOST_UCB0CTL0] & (UCMST | UCMODE_3 | UCSYNC)) != (UCMST | UCMODE_3 | UCSYNC)
+            || (ctl1 & UCSSEL_3) != UCSSEL_2) {
+            fprintf(stderr, "host: only the I2C master on SMCLK is modelled for USCI_B0\n");
+            exit(2);
+        }
+    }
+    if (!i2c_tx && !(ctl1 & (UCTXSTT | UCTXSTP))) {
+        return;
+    }
+    scl = (r8[HOST_UCB0BR0] | r8[HOST_UCB0BR1] << 8) / dco_hz(); /* SMCLK runs: CPU active */
+    if (ctl1 & UCTXSTT) {
+        if (!(ctl1 & UCTR)) {
+            fprintf(stderr, "host: I2C receive is not modelled\n");
+            exit(2);
+        }
+        i2c_busy           = 1;
+        r8[HOST_IFG2]     |= UCB0TXIFG;
+        r8[HOST_UCB0CTL1] &= ~UCTXSTT;
+        if (!expander_i2c_start(r16[HOST_UCB0I2CSA] & 0x7Fu, t)) {
+            r8[HOST_UCB0STAT] |= UCNACKIFG;
+        }
+        spend(10.0 * scl); /* START, address, acknowledge */
+    }
+    if (i2c_tx) {
+        i2c_tx = 0;
+        if (i2c_busy && !(r8[HOST_UCB0STAT] & UCNACKIFG)) {
+            expander_i2c_byte(r8[HOST_UCB0TXBUF], t);
+            spend(9.0 * scl);
+        }
+        r8[HOST_IFG2] |= UCB0TXIFG;
+    }
+    if (ctl1 & UCTXSTP) {
+        if (i2c_busy) {
+            expander_i2c_stop(t);
+            spend(scl);
+        }
+        i2c_busy           = 0;
+        r8[HOST_UCB0CTL1] &= ~UCTXSTP;
+    }
+}
+
+/* ---------------- ADC10 ---------------- */
+
+static uint16_t adc_convert(void) {
+    uint16_t ctl0 = r16[HOST_ADC10CTL0];
+    double   vref = vcc_now();
+    double   v;
+    long     code;
+
+    switch (r16[HOST_ADC10CTL1] >> 12) {
+    case 10:
+        v = 0.00355 * temp_now() + 0.986;
+        break;
+    case 11:
+        v = vcc_now() / 2.0;
+        sim_supply(vcc_now(), t_now + t_debt);
+        break;
+    default:
+        v = 0.0;
+        break;
+    }
+    if ((ctl0 & SREF_3) == SREF_1) {
+        vref = !(ctl0 & REFON) ? 0.0 : (ctl0 & REF2_5V) ? 2.5 : 1.5;
+    }
+    if (vref <= 0.0) {
+        return 0x3FF;
+    }
+    code = lround(v / vref * 1023.0);
+    return (uint16_t)(code < 0 ? 0 : code > 1023 ? 1023 : code);
+}
+
+/* ---------------- Comparator_A+ ---------------- */
+
+/** Update CAOUT from the terminals; latch CAIFG on the CAIES edge. */
+static void ca_update(void) {
+    static const double caref[4] = {0.0, 0.25, 0.5, 0.0};
+    uint8_t ctl1 = r8[HOST_CACTL1];
+    double  vin  = rail_up ? rail_v : 0.0;
+    double  vref = caref[(ctl1 >> 4) & 3u] * vcc_now();
+    uint8_t out  = 0;
+    uint8_t was  = r8[HOST_CACTL2] & CAOUT;
+
+    if ((ctl1 & CAREF_3) == CAREF_3) {
+        vref = 0.55; /* diode */
+    }
+    if (ctl1 & CAON) {
+        out = (ctl1 & CARSEL) ? vin > vref : vref > vin;
+    }
+    r8[HOST_CACTL2] = (uint8_t)((r8[HOST_CACTL2] & ~CAOUT) | out);
+    if ((ctl1 & CAON) && out != was && (out != 0) == !(ctl1 & CAIES)) {
+        r8[HOST_CACTL1] |= CAIFG;
+    }
+}
+
+/** The node's rail drops or returns at rail_next. */
+static void rail(void) {
+    rail_up    = !rail_up;
+    sim_rail(rail_up, rail_next);
+    rail_next += rail_up ? rail_every - rail_off : rail_off;
+    ca_update();
+}
+
+/* ---------------- Flash ---------------- */
+
+/** Analog blocks on, as energy.c counts them. */
+static unsigned int analog_on(void) {
+    uint8_t ca = r8[HOST_CACTL1];
+
+    return ((r16[HOST_ADC10CTL0] & ADC10ON) ? ENERGY_ADC : 0u)
+           | ((r16[HOST_ADC10CTL0] & REFON) ? ENERGY_REF : 0u) | ((ca & CAON) ? ENERGY_CA : 0u)
+           | ((ca & CAON) && (ca & CAREF_3) ? ENERGY_CAREF : 0u);
+}
+
+/** Check the key of FCTL writes; FCTL3 toggles LOCKA where a 1 is written. */
+static void flash_keys(void) {
+    unsigned int r;
+
+    for (r = HOST_FCTL1; r <= HOST_FCTL3; r++) {
+        if (r16[r] == spin16[r]) {
+            continue;
+        }
+        if ((r16[r] & 0xFF00u) != FWKEY) {
+            fprintf(stderr, "host: %.6f: flash controller written without FWKEY\n", t_now);
+            exit(2);
+        }
+        if (r == HOST_FCTL3) {
+            r16[r] = (uint16_t)((r16[r] & ~LOCKA) | ((spin16[r] ^ r16[r]) & LOCKA));
+        }
+        r16[r] = (uint16_t)((r16[r] & 0x00FFu) | FRKEY);
+    }
+}
+
+/** Timing generator frequency of the flash controller, Hz. */
+static double flash_hz(void) {
+    uint16_t f2 = r16[HOST_FCTL2];
+    double   clk;
+
+    switch (f2 & FSSEL_3) {
+    case FSSEL_0:
+        clk = aclk_hz();
+        break;
+    case FSSEL_1:
+        clk = mclk_hz();
+        break;
+    default:
+        clk = smclk_hz();
+        break;
+    }
+    return clk / (double)((f2 & 0x3Fu) + 1u);
+}
+
+/* ---------------- Time ---------------- */
+
+/**
+ * @brief Apply the side effects of register writes since the last access.
+ */
+static void apply(void) {
+    uint8_t      clk[HOST_BCSCTL3 + 1u - HOST_DCOCTL];
+    uint16_t     tactl;
+    unsigned int x;
+
+    /* TAR counts on its own; reading it breaks a spin instead (host_io16). A UCB0TXBUF or
+     * UCA0TXBUF write need not change the register file */
+    spin16[HOST_TAR] = r16[HOST_TAR];
+    if (!i2c_tx && !uart_tx && !memcmp(r8, spin8, sizeof r8)
+        && !memcmp(r16, spin16, sizeof r16)) {
+        return;
+    }
+    if (((r16[HOST_TACTL] ^ spin16[HOST_TACTL]) & ~(TAIE | TAIFG))
+        || memcmp(&r8[HOST_DCOCTL], &spin8[HOST_DCOCTL], sizeof clk)) {
+        /* the debt so far ran on the timer and clocks before these writes */
+        tactl = r16[HOST_TACTL];
+        memcpy(clk, &r8[HOST_DCOCTL], sizeof clk);
+        r16[HOST_TACTL] = spin16[HOST_TACTL];
+        memcpy(&r8[HOST_DCOCTL], &spin8[HOST_DCOCTL], sizeof clk);
+        settle();
+        r16[HOST_TACTL] = tactl;
+        memcpy(&r8[HOST_DCOCTL], clk, sizeof clk);
+        ev_ok   = 0;
+        cycle_s = 1.0 / mclk_hz();
+    } else if (r16[HOST_TACTL] != spin16[HOST_TACTL]
+               || memcmp(&r16[HOST_TACCTL0], &spin16[HOST_TACCTL0],
+                         (HOST_TACCR2 + 1u - HOST_TACCTL0) * sizeof r16[0])) {
+        observe(1); /* a debt short of the next count misses no match: it can stay */
+        ev_ok = 0;
+    }
+    i2c_update();
+    uart_update();
+    if (r16[HOST_TACTL] & TACLR) {
+        r16[HOST_TACTL] &= ~TACLR;
+        r16[HOST_TAR]    = 0;
+        ta_frac          = 0.0;
+    }
+    for (x = 0; x < 3; x++) {
+        if ((r16[cctl[x]] & OUTMOD_7) == OUTMOD_0) {
+            ta_out[x] = (r16[cctl[x]] & OUT) ? 1 : 0;
+        }
+    }
+    flash_keys();
+    if (((r16[HOST_ADC10CTL0] ^ spin16[HOST_ADC10CTL0]) & (ADC10ON | REFON))
+        || ((r8[HOST_CACTL1] ^ spin8[HOST_CACTL1]) & (CAON | CAREF_3))) {
+        energy_analog(analog_on(), t_now + t_debt);
+    }
+    if (((r8[HOST_CACTL1] ^ spin8[HOST_CACTL1]) & ~CAIFG)
+        || r8[HOST_CACTL2] != spin8[HOST_CACTL2]) {
+        ca_update();
+    }
+    if ((r16[HOST_ADC10CTL0] & (ENC | ADC10SC | ADC10ON)) == (ENC | ADC10SC | ADC10ON)) {
+        r16[HOST_ADC10MEM]    = adc_convert();
+        r16[HOST_ADC10CTL0]  &= ~ADC10SC;
+        r16[HOST_ADC10CTL0]  |= ADC10IFG;
+    }
+    pins_update();
+    if (strap_ohm > 0.0) {
+        straps_update();
+    }
+
+    memcpy(spin8, r8, sizeof r8);
+    memcpy(spin16, r16, sizeof r16);
+    spin_break = 1;
+}
+
+/** Book the @p dt up to now in the current power mode (energy.c). */
+static void account(double dt) {
+    enum energy_mode mode = ENERGY_AM;
+
+    if ((sr & CPUOFF) && (sr & (SCG1 | SCG0)) == (SCG1 | SCG0)) {
+        mode = (sr & OSCOFF) ? ENERGY_LPM4 : ENERGY_LPM3;
+    } else if ((sr & CPUOFF) && !(sr & (SCG1 | SCG0))) {
+        mode = ENERGY_LPM0;
+    }
+    energy_run(mode, t_now - dt, dt);
+}
+
+/** Work out what step() runs into next: the timer event, the capture edge (ev_*). */
+static void predict(void) {
+    int    capture = captures_aclk(r16[HOST_TACCTL0]) || captures_aclk(r16[HOST_TACCTL2]);
+    double tu      = term_next();
+    double dt;
+
+    ev_ta_hz   = ta_hz();
+    ev_aclk_hz = aclk_hz();
+    ev_n       = ev_ta_hz > 0.0 ? (double)ta_next() : HUGE_VAL;
+    ev_edge    = capture && ev_aclk_hz > 0.0 ? (aclk_frac < 0.5 ? 0.5 : 1.0) : HUGE_VAL;
+    ev_alive   = ev_ta_hz > 0.0 || ev_edge < HUGE_VAL || hb_next < HUGE_VAL
+               || rail_next < HUGE_VAL || tu < HUGE_VAL;
+    ev_tar     = r16[HOST_TAR];
+    ev_ok      = 1;
+
+    /* the next edge or event, and the next count: a debt short of them shows nothing */
+    ev_event = hb_next < rail_next ? hb_next : rail_next;
+    ev_event = tu < ev_event ? tu : ev_event;
+    dt       = ev_edge < HUGE_VAL ? (ev_edge - aclk_frac) / ev_aclk_hz : HUGE_VAL;
+    ev_event = t_now + dt < ev_event ? t_now + dt : ev_event;
+    dt       = ev_ta_hz > 0.0 ? (1.0 - ta_frac) / ev_ta_hz : HUGE_VAL;
+    ev_count = t_now + dt < ev_event ? t_now + dt : ev_event;
+    dt       = ev_ta_hz > 0.0 ? (ev_n - ta_frac) / ev_ta_hz : HUGE_VAL;
+    ev_event = t_now + dt < ev_event ? t_now + dt : ev_event;
+}
+
+/**
+ * @brief Advance virtual time by at most @p dt, stopping at the next timer count event or
+ *        ACLK capture edge.
+ * @return 1 if something can still happen (timer or ACLK capture running, heartbeat or rail
+ *         change pending)
+ */
+static int step(double dt) {
+    double x, f, c, tt, ta, th, tr, tu, h;
+
+    if (!ev_ok || ev_tar != r16[HOST_TAR]) {
+        predict();
+    }
+    /* Nothing but counting before the next event. The test is on counts and phase, not on
+     * absolute time: t_now loses precision over years and an edge must never be stepped over */
+    x = ta_frac + dt * ev_ta_hz;
+    f = aclk_frac + dt * ev_aclk_hz;
+    if (x < ev_n && f < ev_edge && t_now + dt < hb_next && t_now + dt < rail_next
+        && t_now + dt < term_next()) {
+        c      = floor(x);
+        t_now += dt;
+        if (!(sr & CPUOFF)) {
+            t_active += dt;
+        }
+        account(dt);
+        ta_frac   = x - c;
+        aclk_frac = f - floor(f);
+        ev_n     -= c;
+        ta_count((uint32_t)c);
+        ev_tar = r16[HOST_TAR];
+        return ev_alive;
+    }
+
+    tt = ev_ta_hz > 0.0 ? (ev_n - ta_frac) / ev_ta_hz : HUGE_VAL;
+    ta = ev_edge < HUGE_VAL ? (ev_edge - aclk_frac) / ev_aclk_hz : HUGE_VAL;
+    th = hb_next - t_now;
+    th = th > 0.0 ? th : 0.0;
+    tr = rail_next - t_now;
+    tr = tr > 0.0 ? tr : 0.0;
+    tu = term_next() - t_now;
+    tu = tu > 0.0 ? tu : 0.0;
+    h  = dt;
+    h  = tt < h ? tt : h;
+    h  = ta < h ? ta : h;
+    h  = th < h ? th : h;
+    h  = tr < h ? tr : h;
+    h  = tu < h ? tu : h;
+
+    t_now += h;
+    if (!(sr & CPUOFF)) {
+        t_active += h;
+    }
+    account(h);
+    if (tt <= h) {
+        ta_frac = 0.0; /* land exactly on the event count */
+        ta_count((uint32_t)ev_n);
+    } else if (ev_ta_hz > 0.0) {
+        c       = floor(ta_frac + h * ev_ta_hz);
+        ta_frac = ta_frac + h * ev_ta_hz - c;
+        ta_count((uint32_t)c);
+    }
+    if (ta <= h || aclk_frac + h * ev_aclk_hz >= ev_edge) {
+        aclk_frac = ev_edge == 1.0 ? 0.0 : 0.5;
+        ta_capture(ev_edge == 1.0);
+    } else {
+        f         = aclk_frac + h * ev_aclk_hz;
+        aclk_frac = f - floor(f);
+    }
+    if (th <= h) {
+        heartbeat();
+    }
+    if (tr <= h) {
+        rail();
+    }
+    if (tu <= h) {
+        while (term_next() <= t_now) {
+            terminal();
+        }
+    }
+    if (th <= h || tr <= h || tu <= h) {
+        predict(); /* the heartbeat, rail or terminal may have stopped */
+    } else {
+        ev_ok = 0; /* predicted again when needed: a wake changes it anyway */
+    }
+    return ev_alive;
+}
+
+/** Write @p n bytes of flash from @p mem at @p base as Intel HEX data records to @p f. */
+static void hex_write(FILE *f, const uint8_t *mem, unsigned int base, unsigned int n) {
+    unsigned int a, i, sum;
+
+    for (a = 0; a < n; a += 16u) {
+        sum = 16u + ((base + a) >> 8) + ((base + a) & 0xFFu);
+        fprintf(f, ":10%04X00", base + a);
+        for (i = 0; i < 16u; i++) {
+            fprintf(f, "%02X", mem[a + i]);
+            sum += mem[a + i];
+        }
+        fprintf(f, "%02X\n", (0x100u - (sum & 0xFFu)) & 0xFFu);
+    }
+}
+
+/** Save the Info flash and the main flash area as Intel HEX to @p path. */
+static void flash_save(const char *path) {
+    FILE *f = fopen(path, "w");
+
+    if (!f) {
+        perror(path);
+        exit(2);
+    }
+    hex_write(f, host_info, HOST_INFO_BASE, HOST_INFO_SIZE);
+    hex_write(f, host_main, HOST_MAIN_BASE, HOST_MAIN_SIZE);
+    fprintf(f, ":00000001FF\n");
+    fclose(f);
+}
+
+static void finish(void) {
+    const char   *out = getenv("HOST_INFO_OUT");
+    unsigned long most = 0;
+    unsigned int  i;
+    int           fail;
+
+    fflush(stdout);
+    fprintf(stderr, "host: %.3f s virtual, %.6f s active\n", t_now, t_active);
+    fail = sim_finish(t_now);
+    energy_report(t_now, vcc);
+    for (i = 0; i < sizeof flash_erases / sizeof flash_erases[0]; i++) {
+        most = flash_erases[i] > most ? flash_erases[i] : most;
+    }
+    if (most || flash_words) {
+        printf("flash    %lu words written, at most %lu erases of a segment (%.0f per year), "
+               "%lu below 2.2 V\n",
+               flash_words, most, (double)most / t_now * 365.25 * 86400.0, flash_low);
+    }
+    if (out) {
+        flash_save(out);
+    }
+    exit(fail);
+}
+
+/**
+ * @brief Run the CPU time spent so far through the peripherals.
+ * - Needed before anything that can observe time: Timer_A registers, taking an interrupt,
+ *   sleeping. Other accesses only add to the debt, which keeps busy ISRs cheap.
+ */
+static void settle(void) {
+    while (t_debt > 0.0) {
+        double t0 = t_now;
+        step(t_debt);
+        t_debt -= t_now - t0;
+        if (t_now == t0) {
+            break;
+        }
+    }
+    t_debt = 0.0;
+    if (t_now >= t_end) {
+        finish();
+    }
+}
+
+/**
+ * @brief Settle only if the debt shows: it reaches an event, or with @p counts set, carries
+ *        Timer_A to its next count.
+ * - Otherwise no register or pin changes before the debt runs out (TAR aside, unless @p counts),
+ *   and it stays for the next settle(): a wake's accesses, a conversion and an expander
+ *   transfer then run through the peripherals in one step instead of one per access.
+ */
+static void observe(int counts) {
+    if (t_debt <= 0.0) {
+        return;
+    }
+    if (!ev_ok || ev_tar != r16[HOST_TAR]) {
+        predict();
+    }
+    if (t_now + t_debt < (counts ? ev_count : ev_event)) {
+        return;
+    }
+    settle();
+}
+
+/** Spend @p dt of active CPU time. */
+static void spend(double dt) {
+    t_debt += dt;
+    if (t_now + t_debt >= t_end) {
+        settle();
+    }
+}
+
+/**
+ * @brief Set the status register; step()'s fast path stays while the timer and ACLK rates
+ *        hold and the CPU neither sleeps nor wakes (ta_silent()).
+ */
+static void sr_write(unsigned int v) {
+    unsigned int was = sr;
+
+    sr = v;
+    if ((was ^ v) & (CPUOFF | SCG1 | OSCOFF)) {
+        ev_ok = 0;
+    }
+}
+
+/* ---------------- Interrupts ---------------- */
+
+typedef void (*isr_t)(void);
+
+static void isr_missing(void) {
+    fprintf(stderr, "host: %.6f: interrupt without an ISR\n", t_now);
+    exit(2);
+}
+
+static isr_t irq_pending(void) {
+    uint16_t c0 = r16[HOST_TACCTL0], c1 = r16[HOST_TACCTL1], c2 = r16[HOST_TACCTL2];
+
+    if ((r8[HOST_CACTL1] & CAIE) && (r8[HOST_CACTL1] & CAIFG)) {
+        return COMPARATORA_ISR ? COMPARATORA_ISR : isr_missing;
+    }
+    if ((c0 & CCIE) && (c0 & CCIFG)) {
+        return TIMER0_A0_ISR ? TIMER0_A0_ISR : isr_missing;
+    }
+    if (((c1 & CCIE) && (c1 & CCIFG)) || ((c2 & CCIE) && (c2 & CCIFG))
+        || ((r16[HOST_TACTL] & TAIE) && (r16[HOST_TACTL] & TAIFG))) {
+        return TIMER0_A1_ISR ? TIMER0_A1_ISR : isr_missing;
+    }
+    if (r8[HOST_IE2] & r8[HOST_IFG2] & UCA0RXIFG) { /* UCA0RXIE */
+        return USCIAB0RX_ISR ? USCIAB0RX_ISR : isr_missing;
+    }
+    if ((r16[HOST_ADC10CTL0] & ADC10IE) && (r16[HOST_ADC10CTL0] & ADC10IFG)) {
+        return ADC10_ISR ? ADC10_ISR : isr_missing;
+    }
+    if (r8[HOST_P2IE] & r8[HOST_P2IFG]) {
+        return PORT2_ISR ? PORT2_ISR : isr_missing;
+    }
+    if (r8[HOST_P1IE] & r8[HOST_P1IFG]) {
+        return PORT1_ISR ? PORT1_ISR : isr_missing;
+    }
+    return NULL;
+}
+
+/** Take pending interrupts while GIE is set. */
+static void dispatch(void) {
+    isr_t isr;
+    if (!(sr & GIE)) {
+        return;
+    }
+    observe(0);
+    while ((sr & GIE) && (isr = irq_pending()) != NULL) {
+        unsigned int saved = sr;
+        if (saved & CPUOFF) {
+            energy_wake();
+        }
+        sr_write(0); /* GIE and LPM bits cleared on entry */
+        spend(HOST_IRQ_CYCLES * cycle_s);
+        if (isr == TIMER0_A0_ISR) {
+            ta_set(HOST_TACCTL0, CCIFG, 0); /* single-source vectors */
+        } else if (isr == COMPARATORA_ISR) {
+            r8[HOST_CACTL1] &= ~CAIFG;
+        }
+        sr_exit_clear = 0;
+        isr();
+        apply();
+        spend(HOST_RETI_CYCLES * cycle_s);
+        if ((saved & ~sr_exit_clear) & CPUOFF) {
+            settle(); /* back to sleep: the debt ran active */
+        } else {
+            observe(0);
+        }
+        sr_write(saved & ~sr_exit_clear);
+    }
+}
+
+/* ---------------- Register access ---------------- */
+
+/**
+ * @brief Bring the model up to the access of register @p id.
+ * @param id register index, 8-bit registers offset by HOST_REG16_COUNT
+ */
+static void sync(int id) {
+    int polling = id == spin_id[0] || id == spin_id[1];
+
+    spin_id[1] = spin_id[0];
+    spin_id[0] = id;
+    apply();
+    if (spin_break || !polling) {
+        spin_break = 0;
+        spins      = 0;
+    } else if (++spins >= HOST_SPIN_ACCESSES) {
+        spins = 0;
+        settle();
+        step(t_end - t_now); /* nothing changes before the next event */
+    }
+    spend(HOST_IO_CYCLES * cycle_s);
+    dispatch();
+}
+
+volatile uint8_t *host_io8(enum host_reg8 r) {
+    sync(HOST_REG16_COUNT + (int)r);
+    if (r == HOST_P1IN || r == HOST_P2IN) {
+        settle(); /* the levels at this very access (the software UART samples bits) */
+        r8[r] = port_in(r == HOST_P2IN);
+    }
+    if (r == HOST_UCB0TXBUF) {
+        i2c_tx          = 1; /* written after this returns */
+        r8[HOST_IFG2]  &= ~UCB0TXIFG;
+    }
+    if (r == HOST_UCA0RXBUF) {
+        r8[HOST_IFG2] &= ~UCA0RXIFG;
+    }
+    if (r == HOST_UCA0TXBUF) {
+        uart_tx         = 1;
+        r8[HOST_IFG2]  &= ~UCA0TXIFG;
+    }
+    return &r8[r];
+}
+
+volatile uint16_t *host_io16(enum host_reg16 r) {
+    sync((int)r);
+    if (r >= HOST_TACTL && r <= HOST_TAIV) {
+        observe(r == HOST_TAR);
+    }
+    if (r == HOST_TAR) {
+        spins = 0;
+    }
+    if (r == HOST_TAIV) {
+        uint16_t c1 = r16[HOST_TACCTL1], c2 = r16[HOST_TACCTL2];
+        if ((c1 & CCIE) && (c1 & CCIFG)) {
+            ta_set(HOST_TACCTL1, CCIFG, 0);
+            ta_set(r, 0xFFFFu, TA0IV_TACCR1);
+        } else if ((c2 & CCIE) && (c2 & CCIFG)) {
+            ta_set(HOST_TACCTL2, CCIFG, 0);
+            ta_set(r, 0xFFFFu, TA0IV_TACCR2);
+        } else if ((r16[HOST_TACTL] & TAIE) && (r16[HOST_TACTL] & TAIFG)) {
+            ta_set(HOST_TACTL, TAIFG, 0);
+            ta_set(r, 0xFFFFu, TA0IV_TAIFG);
+        } else {
+            ta_set(r, 0xFFFFu, TA0IV_NONE);
+        }
+    }
+    return &r16[r];
+}
+
+/* ---------------- Intrinsics ---------------- */
+
+void host_delay_cycles(unsigned long cycles) {
+    apply();
+    spins = 0; /* a loop timed by its own cycles (a bit-banged character), not a polling one */
+    spend((double)cycles * cycle_s);
+    dispatch();
+}
+
+void host_bis_sr(unsigned int bits) {
+    apply();
+    settle();
+    sr_write(sr | bits);
+    for (;;) {
+        dispatch();
+        if (!(sr & CPUOFF)) {
+            return;
+        }
+        if (!(sr & GIE)) {
+            fprintf(stderr, "host: %.6f: CPU off with interrupts disabled\n", t_now);
+            finish();
+        }
+        while (!irq_pending()) {
+            if (t_now >= t_end) {
+                finish();
+            }
+            if (!step(t_end - t_now)) {
+                fprintf(stderr, "host: %.6f: asleep with no wake source\n", t_now);
+                finish();
+            }
+        }
+    }
+}
+
+void host_bic_sr(unsigned int bits) {
+    apply();
+    sr_write(sr & ~bits);
+}
+
+void host_bic_sr_on_exit(unsigned int bits) {
+    sr_exit_clear |= bits;
+}
+
+double host_time(void) {
+    return t_now + t_debt;
+}
+
+char host_strap(unsigned int port, unsigned int bit) {
+    return strap[port][bit];
+}
+
+void host_press(double t) {
+    if (hb_port >= 0 && hb_next == HUGE_VAL && ++hb_pressed >= hb_presses) {
+        hb_next      = t + hb_half; /* the node restarts */
+        hb_hang_next = t + hb_hang;
+        hb_pressed   = 0;
+    }
+}
+
+/**
+ * @brief Segment of flash address @p addr: its index in flash_erases and its size; -1 outside
+ *        Info flash and the main flash area.
+ */
+static int flash_seg(unsigned int addr, unsigned int *size) {
+    if (addr >= HOST_INFO_BASE && addr - HOST_INFO_BASE < HOST_INFO_SIZE) {
+        *size = 64u;
+        return (int)((addr - HOST_INFO_BASE) / 64u);
+    }
+    if (addr >= HOST_MAIN_BASE && addr - HOST_MAIN_BASE < HOST_MAIN_SIZE) {
+        *size = 512u;
+        return (int)(HOST_INFO_SIZE / 64u + (addr - HOST_MAIN_BASE) / 512u);
+    }
+    return -1;
+}
+
+uint8_t *host_flash(unsigned int addr) {
+    unsigned int size;
+
+    if (flash_seg(addr, &size) < 0) {
+        fprintf(stderr, "host: %.6f: flash read at 0x%04X, outside the model\n", t_now, addr);
+        exit(2);
+    }
+    return addr < HOST_MAIN_BASE ? &host_info[addr - HOST_INFO_BASE]
+                                 : &host_main[addr - HOST_MAIN_BASE];
+}
+
+void host_flash_write(unsigned int addr, uint16_t w) {
+    unsigned int size;
+    int          seg = flash_seg(addr, &size);
+    uint8_t     *b;
+    uint16_t     f1, f3;
+    double       hz, cycles;
+
+    apply(); /* the FCTL writes before this one */
+    f1 = r16[HOST_FCTL1];
+    f3 = r16[HOST_FCTL3];
+    if (seg < 0 || (addr & 1u) || (f3 & LOCK) || !(f1 & (ERASE | WRT))
+        || (seg == HOST_INFO_SIZE / 64u - 1u && (f3 & LOCKA))) {
+        r16[HOST_FCTL3] |= ACCVIFG;
+        return;
+    }
+    hz = flash_hz();
+    if (hz < 257e3 || hz > 476e3) {
+        fprintf(stderr, "host: %.6f: flash timing generator at %.0f Hz\n", t_now, hz);
+        exit(2);
+    }
+    b          = host_flash(addr);
+    flash_low += vcc_now() < 2.2;
+    if (f1 & ERASE) {
+        memset(b - (addr & (size - 1u)), 0xFF, size);
+        flash_erases[seg]++;
+        cycles = HOST_SEG_ERASE;
+    } else {
+        b[0] &= (uint8_t)w;
+        b[1] &= (uint8_t)(w >> 8);
+        flash_words++;
+        cycles = HOST_WORD_WRITE;
+    }
+    energy_analog(analog_on() | ENERGY_FLASH, t_now + t_debt);
+    spend(cycles / hz); /* the CPU is held */
+    energy_analog(analog_on(), t_now + t_debt);
+}
+
+/* ---------------- Setup ---------------- */
+
+static double env_num(const char *name, double def) {
+    const char *v = getenv(name);
+    return v ? atof(v) : def;
+}
+
+/** Load the Info flash and main flash area parts of an Intel HEX file. */
+static void info_load(const char *path) {
+    FILE        *f = fopen(path, "r");
+    char         line[600];
+    unsigned int len, addr, type, i, b;
+
+    if (!f) {
+        perror(path);
+        exit(2);
+    }
+    while (fgets(line, sizeof line, f)) {
+        if (sscanf(line, ":%2x%4x%2x", &len, &addr, &type) != 3 || type != 0) {
+            continue;
+        }
+        for (i = 0; i < len && sscanf(line + 9 + 2 * i, "%2x", &b) == 1; i++) {
+            if (addr + i >= HOST_INFO_BASE && addr + i < HOST_INFO_BASE + HOST_INFO_SIZE) {
+                host_info[addr + i - HOST_INFO_BASE] = (uint8_t)b;
+            } else if (addr + i >= HOST_MAIN_BASE && addr + i < HOST_MAIN_BASE + HOST_MAIN_SIZE) {
+                host_main[addr + i - HOST_MAIN_BASE] = (uint8_t)b;
+            }
+        }
+    }
+    fclose(f);
+}
+
+/** Power-on reset, before main(). */
+__attribute__((constructor)) static void host_reset(void) {
+    unsigned int i;
+    const char  *info  = getenv("HOST_INFO");
+    const char  *trace = getenv("HOST_TRACE");
+    const char  *hb    = getenv("HOST_HEARTBEAT");
+    const char  *dis   = getenv("HOST_DISCHARGE");
+    const char  *rl    = getenv("HOST_RAIL");
+    const char  *st    = getenv("HOST_STRAPS");
+
+    r8[HOST_DCOCTL]      = 0x60;
+    r8[HOST_BCSCTL1]     = 0x87;
+    r8[HOST_BCSCTL3]     = 0x05;
+    r8[HOST_CALBC1_1MHZ] = getenv("HOST_NOCAL") ? 0xFF : 0x86;
+    r8[HOST_CALDCO_1MHZ] = getenv("HOST_NOCAL") ? 0xFF : 0xB5;
+    r16[HOST_WDTCTL]     = 0x6900;
+    r8[HOST_IFG1]        = PORIFG; /* power-up */
+    r8[HOST_UCB0CTL1]    = UCSWRST;
+    r8[HOST_UCA0CTL1]    = UCSWRST;
+    r16[HOST_FCTL1]      = FRKEY;
+    r16[HOST_FCTL2]      = FRKEY | FSSEL_1 | FN1;
+    r16[HOST_FCTL3]      = FRKEY | LOCKA | LOCK | WAIT;
+    memcpy(spin16 + HOST_FCTL1, r16 + HOST_FCTL1, 3u * sizeof r16[0]); /* not written yet */
+    cycle_s              = 1.0 / mclk_hz();
+    memset(host_info, 0xFF, sizeof host_info);
+    memset(host_main, 0xFF, sizeof host_main);
+    if (info) {
+        info_load(info);
+    }
+    for (i = 0; i < 16; i++) {
+        pin[i / 8u][i % 8u] = 'Z';
+    }
+    t_end      = env_num("HOST_DAYS", 3.0) * 86400.0;
+    vlo_hz     = env_num("HOST_VLO_HZ", 11805.0);
+    vlo_tc     = env_num("HOST_VLO_TC", 0.0) * 1e-6;
+    temp_c     = env_num("HOST_TEMP_C", 25.0);
+    temp_swing = env_num("HOST_TEMP_SWING", 0.0);
+    vcc        = env_num("HOST_VCC", 3.0);
+    trace_mask = trace ? (unsigned int)strtoul(trace, NULL, 16) : 0u;
+    if (dis && *dis) {
+        if (sscanf(dis, "%lf:%lf:%lf", &dis_every, &dis_min, &dis_len) != 3 || dis_every <= 0.0
+            || dis_len <= 0.0 || dis_len > dis_every * 24.0) {
+            fprintf(stderr, "host: HOST_DISCHARGE=%s: expected <every days>:<lowest V>:<hours>\n",
+                    dis);
+            exit(2);
+        }
+        dis_every *= 86400.0;
+        dis_len   *= 3600.0;
+    }
+    rail_v = 1.65;
+    if (rl && *rl) {
+        int n = sscanf(rl, "%lf:%lf:%lf", &rail_every, &rail_off, &rail_v);
+        if (n < 2 || rail_every <= 0.0 || rail_off <= 0.0 || rail_off >= rail_every * 24.0) {
+            fprintf(stderr, "host: HOST_RAIL=%s: expected <every days>:<off hours>[:<V>]\n", rl);
+            exit(2);
+        }
+        rail_every *= 86400.0;
+        rail_off   *= 3600.0;
+        rail_next   = rail_every;
+    }
+    while (st && *st) {
+        unsigned int port, bit;
+        char         l;
+        int          n = 0;
+        if (sscanf(st, "%u.%u:%c%n", &port, &bit, &l, &n) != 3 || port < 1 || port > 2
+            || bit > 7 || (l != 'L' && l != 'H') || (st[n] && st[n] != ',')) {
+            fprintf(stderr, "host: HOST_STRAPS=%s: expected <port>.<bit>:<L|H>[,...]\n", st);
+            exit(2);
+        }
+        strap[port - 1u][bit] = l;
+        strap_ohm             = env_num("HOST_STRAP_OHM", ENERGY_STRAP_OHM);
+        st                   += st[n] ? n + 1 : n;
+    }
+    term_on    = term_init();
+    hb_next    = HUGE_VAL;
+    if (hb && *hb) {
+        unsigned int port;
+        double       period;
+        int          n =
+            sscanf(hb, "%u.%u:%lf:%lf:%u", &port, &hb_bit, &period, &hb_hang, &hb_presses);
+        if (n < 3 || port < 1 || port > 2 || hb_bit > 7 || period <= 0.0 || hb_presses < 1) {
+            fprintf(stderr, "host: HOST_HEARTBEAT=%s: expected <port>.<bit>:<period s>[:<days>"
+                    "[:<presses>]]\n", hb);
+            exit(2);
+        }
+        hb_port      = (int)port - 1;
+        hb_half      = period / 2.0;
+        hb_next      = hb_half;
+        hb_hang      = n > 3 ? hb_hang * 86400.0 : 0.0;
+        hb_hang_next = hb_hang;
+    }
+}
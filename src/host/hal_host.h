@@ -0,0 +1,434 @@
+/**
+ * @file hal_host.h
+ * @brief Host backend of hal.h: msp430.h names on top of a peripheral model.
+ *
+ * Register names expand to host_io8() / host_io16(), which bring the model up to date (and
+ * spend a few MCLK cycles of virtual time) before handing out the register. Reads and writes
+ * therefore see the same values and side effects as on the G2553: TAR counts, TAIV clears the
+ * flag it reports, TACLR self-clears, ADC10SC converts.
+ *
+ * Intrinsics map onto the model's status register: __bis_SR_register(LPM3_bits | GIE) sleeps
+ * until the next interrupt in virtual time, dispatches it, and only returns if the ISR cleared
+ * the LPM bits with __bic_SR_register_on_exit(). Interrupts are also taken at register
+ * accesses while GIE is set.
+ *
+ * Only what the firmware uses is modelled; bit values match msp430g2553.h. The chips on the
+ * expander outputs (PULSE_OUT) are modelled in expander.c.
+ */
+
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include <stdint.h>
+
+/* ---------------- Model registers ---------------- */
+enum host_reg8 {
+    HOST_IE1,
+    HOST_IFG1,
+    HOST_IE2,
+    HOST_IFG2,
+    HOST_DCOCTL,
+    HOST_BCSCTL1,
+    HOST_BCSCTL2,
+    HOST_BCSCTL3,
+    HOST_CALDCO_1MHZ,
+    HOST_CALBC1_1MHZ,
+    HOST_P1IN,
+    HOST_P1OUT,
+    HOST_P1DIR,
+    HOST_P1IFG,
+    HOST_P1IES,
+    HOST_P1IE,
+    HOST_P1SEL,
+    HOST_P1SEL2,
+    HOST_P1REN,
+    HOST_P2IN,
+    HOST_P2OUT,
+    HOST_P2DIR,
+    HOST_P2IFG,
+    HOST_P2IES,
+    HOST_P2IE,
+    HOST_P2SEL,
+    HOST_P2SEL2,
+    HOST_P2REN,
+    HOST_ADC10AE0,
+    HOST_CACTL1,
+    HOST_CACTL2,
+    HOST_CAPD,
+    HOST_UCB0CTL0,
+    HOST_UCB0CTL1,
+    HOST_UCB0BR0,
+    HOST_UCB0BR1,
+    HOST_UCB0STAT,
+    HOST_UCB0TXBUF,
+    HOST_UCA0CTL0,
+    HOST_UCA0CTL1,
+    HOST_UCA0BR0,
+    HOST_UCA0BR1,
+    HOST_UCA0MCTL,
+    HOST_UCA0RXBUF,
+    HOST_UCA0TXBUF,
+    HOST_REG8_COUNT
+};
+
+enum host_reg16 {
+    HOST_WDTCTL,
+    HOST_TACTL,
+    HOST_TAR,
+    HOST_TACCTL0,
+    HOST_TACCTL1,
+    HOST_TACCTL2,
+    HOST_TACCR0,
+    HOST_TACCR1,
+    HOST_TACCR2,
+    HOST_TAIV,
+    HOST_ADC10CTL0,
+    HOST_ADC10CTL1,
+    HOST_ADC10MEM,
+    HOST_UCB0I2CSA,
+    HOST_FCTL1,
+    HOST_FCTL2,
+    HOST_FCTL3,
+    HOST_REG16_COUNT
+};
+
+volatile uint8_t  *host_io8(enum host_reg8 r);
+volatile uint16_t *host_io16(enum host_reg16 r);
+
+#define IE1          (*host_io8(HOST_IE1))
+#define IFG1         (*host_io8(HOST_IFG1))
+#define IE2          (*host_io8(HOST_IE2))
+#define IFG2         (*host_io8(HOST_IFG2))
+#define DCOCTL       (*host_io8(HOST_DCOCTL))
+#define BCSCTL1      (*host_io8(HOST_BCSCTL1))
+#define BCSCTL2      (*host_io8(HOST_BCSCTL2))
+#define BCSCTL3      (*host_io8(HOST_BCSCTL3))
+#define CALDCO_1MHZ  (*host_io8(HOST_CALDCO_1MHZ))
+#define CALBC1_1MHZ  (*host_io8(HOST_CALBC1_1MHZ))
+#define P1IN         (*host_io8(HOST_P1IN))
+#define P1OUT        (*host_io8(HOST_P1OUT))
+#define P1DIR        (*host_io8(HOST_P1DIR))
+#define P1IFG        (*host_io8(HOST_P1IFG))
+#define P1IES        (*host_io8(HOST_P1IES))
+#define P1IE         (*host_io8(HOST_P1IE))
+#define P1SEL        (*host_io8(HOST_P1SEL))
+#define P1SEL2       (*host_io8(HOST_P1SEL2))
+#define P1REN        (*host_io8(HOST_P1REN))
+#define P2IN         (*host_io8(HOST_P2IN))
+#define P2OUT        (*host_io8(HOST_P2OUT))
+#define P2DIR        (*host_io8(HOST_P2DIR))
+#define P2IFG        (*host_io8(HOST_P2IFG))
+#define P2IES        (*host_io8(HOST_P2IES))
+#define P2IE         (*host_io8(HOST_P2IE))
+#define P2SEL        (*host_io8(HOST_P2SEL))
+#define P2SEL2       (*host_io8(HOST_P2SEL2))
+#define P2REN        (*host_io8(HOST_P2REN))
+#define ADC10AE0     (*host_io8(HOST_ADC10AE0))
+#define CACTL1       (*host_io8(HOST_CACTL1))
+#define CACTL2       (*host_io8(HOST_CACTL2))
+#define CAPD         (*host_io8(HOST_CAPD))
+#define UCB0CTL0     (*host_io8(HOST_UCB0CTL0))
+#define UCB0CTL1     (*host_io8(HOST_UCB0CTL1))
+#define UCB0BR0      (*host_io8(HOST_UCB0BR0))
+#define UCB0BR1      (*host_io8(HOST_UCB0BR1))
+#define UCB0STAT     (*host_io8(HOST_UCB0STAT))
+#define UCB0TXBUF    (*host_io8(HOST_UCB0TXBUF))
+#define UCA0CTL0     (*host_io8(HOST_UCA0CTL0))
+#define UCA0CTL1     (*host_io8(HOST_UCA0CTL1))
+#define UCA0BR0      (*host_io8(HOST_UCA0BR0))
+#define UCA0BR1      (*host_io8(HOST_UCA0BR1))
+#define UCA0MCTL     (*host_io8(HOST_UCA0MCTL))
+#define UCA0RXBUF    (*host_io8(HOST_UCA0RXBUF))
+#define UCA0TXBUF    (*host_io8(HOST_UCA0TXBUF))
+
+#define WDTCTL       (*host_io16(HOST_WDTCTL))
+#define TACTL        (*host_io16(HOST_TACTL))
+#define TAR          (*host_io16(HOST_TAR))
+#define TACCTL0      (*host_io16(HOST_TACCTL0))
+#define TACCTL1      (*host_io16(HOST_TACCTL1))
+#define TACCTL2      (*host_io16(HOST_TACCTL2))
+#define TACCR0       (*host_io16(HOST_TACCR0))
+#define TACCR1       (*host_io16(HOST_TACCR1))
+#define TACCR2       (*host_io16(HOST_TACCR2))
+#define TAIV         (*host_io16(HOST_TAIV))
+#define ADC10CTL0    (*host_io16(HOST_ADC10CTL0))
+#define ADC10CTL1    (*host_io16(HOST_ADC10CTL1))
+#define ADC10MEM     (*host_io16(HOST_ADC10MEM))
+#define UCB0I2CSA    (*host_io16(HOST_UCB0I2CSA))
+#define FCTL1        (*host_io16(HOST_FCTL1))
+#define FCTL2        (*host_io16(HOST_FCTL2))
+#define FCTL3        (*host_io16(HOST_FCTL3))
+
+/* ---------------- Bits ---------------- */
+#define BIT0         (0x0001)
+#define BIT1         (0x0002)
+#define BIT2         (0x0004)
+#define BIT3         (0x0008)
+#define BIT4         (0x0010)
+#define BIT5         (0x0020)
+#define BIT6         (0x0040)
+#define BIT7         (0x0080)
+
+/* Status register */
+#define GIE          (0x0008)
+#define CPUOFF       (0x0010)
+#define OSCOFF       (0x0020)
+#define SCG0         (0x0040)
+#define SCG1         (0x0080)
+#define LPM0_bits    (CPUOFF)
+#define LPM1_bits    (SCG0 | CPUOFF)
+#define LPM2_bits    (SCG1 | CPUOFF)
+#define LPM3_bits    (SCG1 | SCG0 | CPUOFF)
+#define LPM4_bits    (SCG1 | SCG0 | OSCOFF | CPUOFF)
+
+/* Special function registers */
+#define WDTIFG       (0x01)
+#define OFIFG        (0x02)
+#define PORIFG       (0x04)
+#define RSTIFG       (0x08)
+#define NMIIFG       (0x10)
+
+/* Watchdog */
+#define WDTPW        (0x5A00)
+#define WDTHOLD      (0x0080)
+
+/* Basic clock module+ */
+#define XT2OFF       (0x80)
+#define DIVA_0       (0x00)
+#define DIVA_1       (0x10)
+#define DIVA_2       (0x20)
+#define DIVA_3       (0x30)
+#define DIVM_0       (0x00)
+#define DIVM_1       (0x10)
+#define DIVM_2       (0x20)
+#define DIVM_3       (0x30)
+#define DIVS_0       (0x00)
+#define DIVS_1       (0x02)
+#define DIVS_2       (0x04)
+#define DIVS_3       (0x06)
+#define LFXT1S_0     (0x00)
+#define LFXT1S_2     (0x20)
+#define LFXT1S_3     (0x30)
+#define LFXT1OF      (0x01)
+
+/* Timer_A */
+#define TASSEL_0     (0x0000)
+#define TASSEL_1     (0x0100)
+#define TASSEL_2     (0x0200)
+#define TASSEL_3     (0x0300)
+#define ID_0         (0x0000)
+#define ID_1         (0x0040)
+#define ID_2         (0x0080)
+#define ID_3         (0x00C0)
+#define MC_0         (0x0000)
+#define MC_1         (0x0010)
+#define MC_2         (0x0020)
+#define MC_3         (0x0030)
+#define TACLR        (0x0004)
+#define TAIE         (0x0002)
+#define TAIFG        (0x0001)
+
+#define CM_0         (0x0000)
+#define CM_1         (0x4000)
+#define CM_2         (0x8000)
+#define CM_3         (0xC000)
+#define CCIS_0       (0x0000)
+#define CCIS_1       (0x1000)
+#define CCIS_2       (0x2000)
+#define CCIS_3       (0x3000)
+#define SCS          (0x0800)
+#define SCCI         (0x0400)
+#define CAP          (0x0100)
+#define OUTMOD_0     (0x0000)
+#define OUTMOD_1     (0x0020)
+#define OUTMOD_2     (0x0040)
+#define OUTMOD_3     (0x0060)
+#define OUTMOD_4     (0x0080)
+#define OUTMOD_5     (0x00A0)
+#define OUTMOD_6     (0x00C0)
+#define OUTMOD_7     (0x00E0)
+#define CCIE         (0x0010)
+#define CCI          (0x0008)
+#define OUT          (0x0004)
+#define COV          (0x0002)
+#define CCIFG        (0x0001)
+
+#define TA0IV_NONE   (0x0000)
+#define TA0IV_TACCR1 (0x0002)
+#define TA0IV_TACCR2 (0x0004)
+#define TA0IV_TAIFG  (0x000A)
+
+/* ADC10 */
+#define SREF_0       (0x0000)
+#define SREF_1       (0x2000)
+#define SREF_2       (0x4000)
+#define SREF_3       (0x6000)
+#define ADC10SHT_0   (0x0000)
+#define ADC10SHT_1   (0x0800)
+#define ADC10SHT_2   (0x1000)
+#define ADC10SHT_3   (0x1800)
+#define ADC10SR      (0x0400)
+#define REFOUT       (0x0200)
+#define REFBURST     (0x0100)
+#define MSC          (0x0080)
+#define REF2_5V      (0x0040)
+#define REFON        (0x0020)
+#define ADC10ON      (0x0010)
+#define ADC10IE      (0x0008)
+#define ADC10IFG     (0x0004)
+#define ENC          (0x0002)
+#define ADC10SC      (0x0001)
+
+#define INCH_0       (0x0000)
+#define INCH_10      (0xA000)
+#define INCH_11      (0xB000)
+#define ADC10DIV_0   (0x0000)
+#define ADC10DIV_3   (0x0060)
+#define ADC10DIV_7   (0x00E0)
+#define ADC10SSEL_0  (0x0000)
+#define ADC10SSEL_3  (0x0018)
+#define ADC10BUSY    (0x0001)
+
+/* Comparator_A+ */
+#define CAEX         (0x80)
+#define CARSEL       (0x40)
+#define CAREF_0      (0x00)
+#define CAREF_1      (0x10)
+#define CAREF_2      (0x20)
+#define CAREF_3      (0x30)
+#define CAON         (0x08)
+#define CAIES        (0x04)
+#define CAIE         (0x02)
+#define CAIFG        (0x01)
+
+#define CASHORT      (0x80)
+#define P2CA4        (0x40)
+#define P2CA3        (0x20)
+#define P2CA2        (0x10)
+#define P2CA1        (0x08)
+#define P2CA0        (0x04)
+#define CAF          (0x02)
+#define CAOUT        (0x01)
+
+/* USCI_B0, I2C mode */
+#define UCA10        (0x80)
+#define UCSLA10      (0x40)
+#define UCMM         (0x20)
+#define UCMST        (0x08)
+#define UCMODE_0     (0x00)
+#define UCMODE_1     (0x02)
+#define UCMODE_2     (0x04)
+#define UCMODE_3     (0x06)
+#define UCSYNC       (0x01)
+
+#define UCSSEL_0     (0x00)
+#define UCSSEL_1     (0x40)
+#define UCSSEL_2     (0x80)
+#define UCSSEL_3     (0xC0)
+#define UCTR         (0x10)
+#define UCTXNACK     (0x08)
+#define UCTXSTP      (0x04)
+#define UCTXSTT      (0x02)
+#define UCSWRST      (0x01)
+
+#define UCBBUSY      (0x10)
+#define UCNACKIFG    (0x08)
+#define UCSTPIFG     (0x04)
+#define UCSTTIFG     (0x02)
+#define UCALIFG      (0x01)
+
+#define UCB0TXIFG    (0x08)
+#define UCB0RXIFG    (0x04)
+
+/* USCI_A0, UART mode */
+#define UCA0TXIE     (0x02)
+#define UCA0RXIE     (0x01)
+#define UCA0TXIFG    (0x02)
+#define UCA0RXIFG    (0x01)
+
+/* Flash controller */
+#define FRKEY        (0x9600)
+#define FWKEY        (0xA500)
+#define ERASE        (0x0002)
+#define MERAS        (0x0004)
+#define WRT          (0x0040)
+#define BLKWRT       (0x0080)
+#define FSSEL_0      (0x0000)
+#define FSSEL_1      (0x0040)
+#define FSSEL_2      (0x0080)
+#define FSSEL_3      (0x00C0)
+#define FN0          (0x0001)
+#define FN1          (0x0002)
+#define FN2          (0x0004)
+#define FN3          (0x0008)
+#define FN4          (0x0010)
+#define FN5          (0x0020)
+#define BUSY         (0x0001)
+#define KEYV         (0x0002)
+#define ACCVIFG      (0x0004)
+#define WAIT         (0x0008)
+#define LOCK         (0x0010)
+#define EMEX         (0x0020)
+#define LOCKA        (0x0040)
+
+/* ---------------- Intrinsics ---------------- */
+void host_delay_cycles(unsigned long cycles);
+void host_bis_sr(unsigned int bits);
+void host_bic_sr(unsigned int bits);
+void host_bic_sr_on_exit(unsigned int bits);
+
+#define __interrupt
+#define __delay_cycles(n)              host_delay_cycles(n)
+#define __bis_SR_register(b)           host_bis_sr(b)
+#define __bic_SR_register(b)           host_bic_sr(b)
+#define __bic_SR_register_on_exit(b)   host_bic_sr_on_exit(b)
+#define __enable_interrupt()           host_bis_sr(GIE)
+#define __disable_interrupt()          host_bic_sr(GIE)
+#define __no_operation()               host_delay_cycles(1)
+
+/* ---------------- Memory ---------------- */
+#define HOST_INFO_BASE (0x1000u)
+#define HOST_INFO_SIZE (256u)
+#define HOST_MAIN_BASE (0xF600u) /* four main flash segments below the vector segment */
+#define HOST_MAIN_SIZE (2048u)
+
+/** Info flash segments D..A, erased (0xFF) at start unless HOST_INFO loads them. */
+extern uint8_t host_info[HOST_INFO_SIZE];
+
+/** Main flash of the HAL_MAIN_FLASH area, erased at start unless HOST_INFO loads it. */
+extern uint8_t host_main[HOST_MAIN_SIZE];
+
+/**
+ * @brief Flash byte at @p addr (HAL_FLASH_PTR), in Info flash or the main flash area; any other
+ *        address ends the run.
+ */
+uint8_t *host_flash(unsigned int addr);
+
+/**
+ * @brief Word write to flash at @p addr (HAL_FLASH_WRITE): erases its segment or programs the
+ *        word as FCTL1 asks, taking the flash timing generator's time.
+ */
+void host_flash_write(unsigned int addr, uint16_t w);
+
+/* ---------------- Model control ---------------- */
+
+/**
+ * @brief Virtual time since power-up, in seconds.
+ */
+double host_time(void);
+
+/**
+ * @brief The HOST_STRAPS tie of a pin.
+ * @param port 0 for P1, 1 for P2
+ * @param bit  pin number
+ * @return 'L' for GND, 'H' for VCC, 0 if the pin is open
+ */
+char host_strap(unsigned int port, unsigned int bit);
+
+/**
+ * @brief A node's button line went LOW at @p t on an expander (expander.c): a hung
+ *        HOST_HEARTBEAT node restarts, as for an MCU pin.
+ */
+void host_press(double t);
+
+#endif /* HAL_HOST_H */
@@ -0,0 +1,703 @@
+/**
+ * @file sim.c
+ * @brief Pulse monitor of the host build.
+ *
+ * Watches the pin of every channel (PULSE_CHANNELS) in the peripheral model and checks every
+ * pulse against the build configuration:
+ * - interval to the previous pulse of the channel (the first one counts from its phase), its
+ *   error in ppm, and with one channel the accumulated drift of the pulse train against
+ *   n * PULSE_INTERVAL_MIN;
+ * - a pulse is skipped if an interval exceeds 1.5 nominal intervals, doubled if it is shorter
+ *   than half of one;
+ * - each LOW run of the pattern must start and last within 10 % of its PULSE_MS slots, or of its
+ *   durations for a gesture (PULSE_GESTURES);
+ * - the patterns of two channels must not overlap, except that up to PULSE_BATCH of them may
+ *   start together (within SIM_BATCH_S, the expander writes of one batch);
+ * - the run fails on any of these, or if a channel had no pulse in its last 1.5 intervals. The
+ *   pulse count itself may differ from the nominal one by the accumulated drift.
+ *
+ * With SENSE_TIMEOUT_MIN the nominal interval is the timeout, and every SENSE_EDGE of the node's
+ * heartbeat on the sense pin (HOST_HEARTBEAT) starts it over: a pulse less than half a timeout
+ * after activity counts as doubled (a healthy node was reset), one more than 1.5 timeouts after
+ * it as skipped. With ESCALATE_GAP_MIN, each further press while the node stays silent is held
+ * to its escalation gap instead (ESCALATE_GAP_MIN, doubling up to ESCALATE_MAX_MIN) and must
+ * play ESCALATE_PATTERN. Activity during a press ends the escalation once the press is over.
+ *
+ * With ADAPT_MIN_MIN the firmware picks the interval itself: a pulse is doubled if it comes less
+ * than half of ADAPT_MIN_MIN after the one before, skipped past 1.5 PULSE_INTERVAL_MIN, and the
+ * summary gives the range of the learned intervals instead of their error.
+ *
+ * With BATT_SAMPLE_MIN every supply sample the firmware takes is checked as well: once VCC
+ * has been below BATT_LOW_MV and a sample reads BATT_RECOVER_MV again, pulses in the next
+ * BATT_DELAY_MIN minutes plus 8 sample periods (averaging and trend) start the interval over
+ * and are not themselves held to it. If the supply stayed low for 8 samples or more, at least
+ * one must come, unless the node was pressed or showed activity (SENSE_TIMEOUT_MIN) from
+ * BATT_DELAY_MIN minutes before the recovery on; shorter dips may be averaged away.
+ *
+ * With PGOOD_DELAY_S the same holds for the node's rail coming back (HOST_RAIL): the window is
+ * PGOOD_DELAY_S plus two PGOOD_POLL_S periods and a few seconds, and a pulse must come in it
+ * if the rail was down for a poll period or longer.
+ *
+ * With CKPT_MIN and an Info flash image loaded (HOST_INFO, e.g. saved by an earlier run with
+ * HOST_INFO_OUT) the schedule may resume from a checkpoint: the first pulse of each channel is
+ * not held to the interval, and there is no drift of the pulse train.
+ *
+ * With CONSOLE_BAUD the lines typed on the terminal (HOST_CONSOLE, see term.c) are followed: "w"
+ * changes the slot width from the next pattern on, and "i" (not with SENSE_TIMEOUT_MIN,
+ * ADAPT_MIN_MIN or EVENT_ONLY) the interval of the channels at PULSE_INTERVAL_MIN. Their next
+ * pulse is held to the new interval from the one before; if that was already past, it comes
+ * right away and is not. Lines the firmware rejects, or that come while a pattern plays (busy),
+ * change nothing here either.
+ *
+ * With CONF_BLOCK the site block in Info flash (HOST_INFO, see conf.h) is read as the firmware
+ * reads it, and its interval and slot width replace the compiled ones from the start; the
+ * summary says which were taken. With STRAP_INTERVAL_BIT and STRAP_WIDTH_BIT the resistor straps
+ * of HOST_STRAPS are followed the same way, over the block.
+ *
+ * With EVENT_ONLY there is no interval. Each trigger (a SENSE_EDGE on the sense pin for
+ * EVENT_SENSE, the rail coming back for EVENT_PGOOD) must get one pulse EVENT_DELAY_S or
+ * PGOOD_DELAY_S later, within 5 % and a second; later or never counts as skipped, a pulse
+ * without a trigger as doubled. Triggers while one is pending or within EVENT_HOLDOFF_S after a
+ * pulse are dropped, as by the firmware; within 1 % of the end of the holdoff either is fine.
+ *
+ * One line per pulse unless HOST_PULSES=0; the summary also lists every sched_time_t wrap.
+ */
+
+/* ---------------- Includes ---------------- */
+#include "sim.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../conf.h"
+#include "../config.h"
+#include "../strap.h"
+#include "../timebase.h"
+#include "hal_host.h"
+
+/* ---------------- Defines ---------------- */
+#if PULSE_OUT == PULSE_OUT_GPIO
+#define SIM_IS_PIN(c, port, bit) ((port) == 0 && (1u << (bit)) == sim_chan[c].pin)
+#else
+#define SIM_IS_PIN(c, port, bit) ((port) >= 2 && ((port) - 2u) * 8u + (bit) == sim_chan[c].pin)
+#endif
+#define SIM_BATCH_S    (0.01) /* patterns starting this close are one batch, s */
+#if SENSE_TIMEOUT_MIN
+#define SIM_INTERVAL(c) (SENSE_TIMEOUT_MIN * 60.0)
+#define SIM_ESCALATE    (ESCALATE_GAP_MIN > 0)
+#else
+#define SIM_ESCALATE    (0)
+#define SIM_INTERVAL(c) (sim_wait[c])
+#endif
+#define SIM_ADAPT      (ADAPT_MIN_MIN > 0)
+#define SIM_WIDTH_S    (sim_width)
+#define SIM_RETIME     (CONF_INTERVAL) /* the interval can be set */
+#define SIM_CHANS      (sizeof sim_chan / sizeof sim_chan[0])
+#define SIM_CHAN(pin, min, phase, pattern) {(pin), (min) * 60.0, (phase) * 60.0, (pattern)},
+#define SIM_WRAPS_MAX  (64)
+#if BATT_SAMPLE_MIN
+#define SIM_RECOVER_S  (BATT_DELAY_MIN * 60.0 + 8.0 * BATT_SAMPLE_MIN * 60.0)
+#endif
+#if PGOOD_DELAY_S
+#define SIM_PGOOD_S    (PGOOD_DELAY_S * 1.1 + 2.0 * PGOOD_POLL_S + 2.0)
+#endif
+#define SIM_EVENT_SLACK(d) (0.05 * (d) + 1.0) /* pulse timing tolerance after a trigger, s */
+#define SIM_CODE(...)      __VA_ARGS__, 0,
+#define SIM_GESTURE(p)     ((p) > 0xFFu) /* pattern is GESTURE(n) */
+
+/* ---------------- Types ---------------- */
+typedef struct {
+    unsigned int pin;      /* P1 pin bit, or expander line (port 2 + line / 8) */
+    double       interval; /* s */
+    double       phase;    /* s */
+    unsigned int pattern;  /* PULSE_MS slots, first in bit 0; set bits are LOW; or GESTURE(n) */
+} sim_chan_t;
+
+/* ---------------- Variables ---------------- */
+static const sim_chan_t sim_chan[] = {PULSE_CHANNELS(SIM_CHAN)};
+static const unsigned char sim_code[] = {PULSE_GESTURES(SIM_CODE) 0}; /* gestures, 0-ended */
+static int           sim_gestures;     /* a channel plays a gesture: widths are relative */
+static unsigned long sim_pulses;
+static unsigned long sim_timed;   /* pulses held to the interval */
+static unsigned long sim_skipped;
+static unsigned long sim_doubled;
+static unsigned long sim_bad_width;
+static unsigned long sim_resumed; /* first pulses after a checkpoint (CKPT_MIN) */
+static double        sim_width = PULSE_MS / 1000.0;  /* pattern slot, s */
+static double        sim_wait[SIM_CHANS];  /* interval, s; from the site block or the console */
+static double        sim_origin[SIM_CHANS]; /* the nominal count runs from here at sim_wait */
+static double        sim_expect;           /* ... plus this many pulses before */
+static int           sim_exempt[SIM_CHANS]; /* next pulse not held to the interval */
+static double        sim_start[SIM_CHANS]; /* first LOW edge of the pattern in progress */
+static unsigned int  sim_pat[SIM_CHANS];   /* ... and its pattern */
+static double        sim_low[SIM_CHANS];   /* LOW edge of the run in progress, -1 = none */
+static unsigned int  sim_run_n[SIM_CHANS]; /* LOW runs of the pattern so far */
+static double        sim_last[SIM_CHANS];  /* first LOW edge of the previous pattern */
+static unsigned long sim_count[SIM_CHANS]; /* pulses per channel */
+static unsigned long sim_overlaps;
+static double        sim_active;       /* last node activity, 0 = none (SENSE_TIMEOUT_MIN) */
+static double        sim_woke = -1.0;  /* activity during a press, -1 = none */
+static unsigned int  sim_presses;      /* presses since the last activity */
+static double        sim_err_min = HUGE_VAL, sim_err_max = -HUGE_VAL, sim_err_sum;
+static double        sim_w_min = HUGE_VAL, sim_w_max;
+static double        sim_learn_min = HUGE_VAL, sim_learn_max; /* intervals, s (ADAPT_MIN_MIN) */
+static double        sim_wrap_t[SIM_WRAPS_MAX];
+static unsigned int  sim_wraps;
+static int           sim_quiet = -1;
+static int           sim_ready;
+#if BATT_SAMPLE_MIN
+static unsigned int  sim_batt_low;          /* samples below BATT_LOW_MV since the last recovery */
+#endif
+#if PGOOD_DELAY_S && !EVENT_ONLY
+static double        sim_rail_down;         /* last drop of the node's rail */
+#endif
+static double        sim_recover = -1.0;    /* last supply recovery or rail return, -1 = none */
+static double        sim_recover_len;       /* its window, s */
+static double        sim_recover_lead;      /* pulses or activity this long before it count, s */
+static int           sim_recover_rail;      /* 0 supply, 1 rail */
+static int           sim_recover_hit;       /* a pulse came for it (or none needed) */
+static unsigned long sim_recoveries[2];
+static unsigned long sim_recover_missed[2];
+#if EVENT_ONLY
+static double        sim_event = -1.0;      /* pending trigger, -1 = none */
+static double        sim_event_delay;       /* its pulse delay, s */
+static int           sim_event_maybe;       /* near the end of a holdoff: may be dropped */
+static double        sim_event_quiet;       /* triggers before this are dropped (holdoff) */
+static double        sim_event_edge;        /* ... and may be dropped before this */
+static unsigned long sim_events;
+#endif
+
+/* ---------------- Functions ---------------- */
+
+/** Whether the firmware takes a pattern slot of @p ms: 2 to 0x3FFF nominal counts. */
+static int sim_slot_ok(unsigned long ms) {
+    double counts = floor(ms * (double)ACLK_VLO_HZ / (1000.0 * TB_DIV) + 0.5);
+
+    return ms >= 1u && ms <= 60000u && (!EVENT_ONLY || 8.0 * ms < EVENT_HOLDOFF_S * 1000.0)
+           && counts >= 2.0 && counts <= 0x3FFF;
+}
+
+#if CONF_BLOCK || STRAP_P2_BITS
+/** The channels at PULSE_INTERVAL_MIN pulse every @p min minutes from the start. */
+static void sim_site_interval(unsigned long min) {
+    unsigned int i;
+
+    for (i = 0; SIM_RETIME && i < SIM_CHANS; i++) {
+        if (sim_chan[i].interval == PULSE_INTERVAL_MIN * 60.0) {
+            sim_wait[i] = min * 60.0;
+        }
+    }
+}
+#endif
+
+#if CONF_BLOCK
+/** Read the site block at CONF_BLOCK_ADDR as conf_load() does, and follow it. */
+static void sim_site(void) {
+    const uint8_t *b    = host_flash(CONF_BLOCK_ADDR);
+    unsigned int   pins = 0, crc = 0xFFFFu, i, k;
+    unsigned long  w[CONF_BLOCK_WORDS];
+
+    for (i = 0; i < CONF_BLOCK_WORDS; i++) {
+        w[i] = b[2u * i] | (unsigned long)b[2u * i + 1u] << 8;
+    }
+    for (i = 0; i < 2u * (CONF_BLOCK_WORDS - 1u); i++) {
+        crc ^= (unsigned int)b[i] << 8;
+        for (k = 0; k < 8u; k++) {
+            crc = (crc & 0x8000u ? crc << 1 ^ 0x1021u : crc << 1) & 0xFFFFu;
+        }
+    }
+    for (i = 0; PULSE_OUT == PULSE_OUT_GPIO && i < SIM_CHANS; i++) {
+        pins |= sim_chan[i].pin;
+    }
+    if (w[0] != CONF_MAGIC || b[2] != CONF_VERSION || b[3] != pins || w[5] != crc
+        || w[2] > PULSE_INTERVAL_MIN || (w[3] && !sim_slot_ok(w[3]))
+        || (w[4] && (w[4] < CONF_VLO_HZ_MIN || w[4] > CONF_VLO_HZ_MAX))) {
+        printf("site     no valid block, compiled settings\n");
+        return;
+    }
+    if (w[2]) {
+        sim_site_interval(w[2]);
+    }
+    if (w[3]) {
+        sim_width = w[3] / 1000.0;
+    }
+    printf("site     interval %lu min, width %lu ms, VLO %lu Hz (0 = compiled)\n", w[2], w[3],
+           w[4]);
+}
+#endif
+
+#if STRAP_P2_BITS
+/** Follow the straps of HOST_STRAPS as conf_strap() reads them; open pins change nothing. */
+static void sim_strap(void) {
+    char          ti = 0, tw = 0;
+    unsigned long v;
+    unsigned int  bit;
+
+    for (bit = 0; bit < 8u; bit++) {
+        if (STRAP_INTERVAL_BIT == 1u << bit) {
+            ti = host_strap(1, bit);
+        }
+        if (STRAP_WIDTH_BIT == 1u << bit) {
+            tw = host_strap(1, bit);
+        }
+    }
+    printf("straps  ");
+    if (ti) {
+        v = ti == 'H' ? STRAP_INTERVAL_VCC_MIN : STRAP_INTERVAL_GND_MIN;
+        sim_site_interval(v);
+        printf(" interval %lu min,", v);
+    } else {
+        printf(" interval %s,", STRAP_INTERVAL_BIT ? "open" : "-");
+    }
+    if (tw) {
+        v         = tw == 'H' ? STRAP_WIDTH_VCC_MS : STRAP_WIDTH_GND_MS;
+        sim_width = v / 1000.0;
+        printf(" width %lu ms\n", v);
+    } else {
+        printf(" width %s\n", STRAP_WIDTH_BIT ? "open" : "-");
+    }
+}
+#endif
+
+/** Set up the per-channel state, once. */
+static void sim_init(void) {
+    unsigned int c;
+
+    if (sim_ready) {
+        return;
+    }
+    for (c = 0; c < SIM_CHANS; c++) {
+        sim_low[c]    = -1.0;
+        sim_wait[c]   = sim_chan[c].interval;
+        sim_origin[c] = sim_chan[c].phase;
+        sim_gestures |= SIM_GESTURE(sim_chan[c].pattern);
+    }
+    if (SIM_ESCALATE) {
+        sim_gestures |= SIM_GESTURE(ESCALATE_PATTERN);
+    }
+#if CONF_BLOCK
+    sim_site();
+#endif
+#if STRAP_P2_BITS
+    sim_strap();
+#endif
+    sim_ready = 1;
+}
+
+/** Close the window of a supply recovery or rail return once @p t is past it. */
+static void sim_recover_check(double t) {
+    if (sim_recover >= 0.0 && t > sim_recover + sim_recover_len) {
+        /* a node pressed or seen active shortly before needs no further press; the firmware
+         * measures that on the VLO, hence the margin */
+        double from = sim_recover - 1.1 * sim_recover_lead;
+        sim_recover_missed[sim_recover_rail] +=
+            !sim_recover_hit && sim_active < from && sim_last[0] < from;
+        sim_recover = -1.0;
+    }
+}
+
+#if BATT_SAMPLE_MIN || (PGOOD_DELAY_S && !EVENT_ONLY)
+/** Open the window of a supply recovery or rail return at @p t; @p hit if none is needed. */
+static void sim_recover_open(int rail, double t, double len, double lead, int hit) {
+    sim_recover_check(t);
+    sim_recover          = t;
+    sim_recover_len      = len;
+    sim_recover_lead     = lead;
+    sim_recover_rail     = rail;
+    sim_recover_hit      = hit;
+    sim_recoveries[rail] += !hit;
+}
+#endif
+
+#if EVENT_ONLY
+/** Give up on the pending trigger once @p t is past its pulse. */
+static void sim_event_check(double t) {
+    if (sim_event >= 0.0 && t > sim_event + sim_event_delay + SIM_EVENT_SLACK(sim_event_delay)) {
+        sim_skipped += !sim_event_maybe;
+        sim_event    = -1.0;
+    }
+}
+
+/** A trigger at @p t asks for a pulse @p delay later. */
+static void sim_trigger(double t, double delay) {
+    sim_event_check(t);
+    if (sim_event >= 0.0 || t < sim_event_quiet) {
+        return; /* pending, or in the holdoff */
+    }
+    sim_event       = t;
+    sim_event_delay = delay;
+    sim_event_maybe = t < sim_event_edge;
+    sim_events     += !sim_event_maybe;
+}
+#endif
+
+/**
+ * @brief Run @p k of @p pattern: LOW from @p off for @p len, s.
+ * @return 0 if the pattern has fewer runs
+ */
+static int sim_run(unsigned int pattern, unsigned int k, double *off, double *len) {
+    unsigned int slot = 0;
+
+    if (SIM_GESTURE(pattern)) {
+        const unsigned char *d = sim_code;
+        double               t = 0.0;
+        for (pattern -= 0x100u; pattern; pattern--) {
+            while (*d++) {
+            }
+        }
+        for (slot = 0; d[slot]; t += d[slot++] * (GESTURE_MS / 1000.0)) {
+            if (!(slot & 1u) && k-- == 0) {
+                *off = t;
+                *len = d[slot] * (GESTURE_MS / 1000.0);
+                return 1;
+            }
+        }
+        return 0;
+    }
+    for (;;) {
+        for (; pattern && !(pattern & 1u); pattern >>= 1) {
+            slot++;
+        }
+        if (!pattern) {
+            return 0;
+        }
+        *off = slot * SIM_WIDTH_S;
+        for (*len = 0.0; pattern & 1u; pattern >>= 1) {
+            *len += SIM_WIDTH_S;
+            slot++;
+        }
+        if (k-- == 0) {
+            return 1;
+        }
+    }
+}
+
+/** Nominal time from the last pulse (or activity) of channel @p c to its next pulse, s. */
+static double sim_interval(unsigned int c) {
+    double gap = ESCALATE_GAP_MIN * 60.0;
+
+    (void)c; /* one channel with SENSE_TIMEOUT_MIN */
+    if (!SIM_ESCALATE || !sim_presses) {
+        return SIM_INTERVAL(c);
+    }
+    gap = ldexp(gap, (int)(sim_presses < 32u ? sim_presses : 32u) - 1);
+    return gap < ESCALATE_MAX_MIN * 60.0 ? gap : ESCALATE_MAX_MIN * 60.0;
+}
+
+/** The pattern of channel @p c that started at @p start is complete. */
+static void sim_pulse(unsigned int c, double start) {
+    double from     = sim_count[c] ? sim_last[c] : sim_chan[c].phase;
+    double nominal  = sim_interval(c);
+    double interval = start - (sim_active > from ? sim_active : from);
+    double err      = (interval / nominal - 1.0) * 1e6;
+    int    recovery, resumed, retimed;
+
+#if EVENT_ONLY
+    /* interval and error are from the trigger, against its delay */
+    sim_event_check(start);
+    interval         = sim_event >= 0.0 ? start - sim_event : 0.0;
+    err              = sim_event >= 0.0 ? (interval / sim_event_delay - 1.0) * 1e6 : 0.0;
+    sim_event_quiet  = start + 0.99 * EVENT_HOLDOFF_S;
+    sim_event_edge   = start + 1.01 * EVENT_HOLDOFF_S;
+    recovery         = 0;
+    resumed          = 0;
+    retimed          = 0;
+    sim_pulses++;
+    if (sim_event < 0.0) {
+        sim_doubled++;
+    } else if (interval < sim_event_delay - SIM_EVENT_SLACK(sim_event_delay)) {
+        sim_skipped++; /* early: the delay was not kept */
+    } else {
+        sim_events += sim_event_maybe; /* answered after all */
+    }
+    sim_event = -1.0;
+    if (interval > 0.0) {
+        sim_timed++;
+        sim_err_min  = err < sim_err_min ? err : sim_err_min;
+        sim_err_max  = err > sim_err_max ? err : sim_err_max;
+        sim_err_sum += err;
+    }
+#else
+    sim_recover_check(start);
+    recovery         = sim_recover >= 0.0;
+    sim_recover_hit |= recovery;
+    resumed          = CKPT_MIN && !sim_count[c] && getenv("HOST_INFO");
+    sim_resumed     += resumed;
+    retimed          = sim_exempt[c];
+    sim_exempt[c]    = 0;
+    sim_pulses++;
+    if (recovery || resumed || retimed) {
+        /* brought forward on purpose, the time left at the checkpoint, or a shorter interval */
+    } else if (interval > 1.5 * nominal) {
+        sim_skipped++;
+    } else if (interval < 0.5 * (SIM_ADAPT ? ADAPT_MIN_MIN * 60.0 : nominal)) {
+        sim_doubled++;
+    }
+    if (SIM_ADAPT) {
+        sim_learn_min = interval < sim_learn_min ? interval : sim_learn_min;
+        sim_learn_max = interval > sim_learn_max ? interval : sim_learn_max;
+    } else if (!recovery && !resumed && !retimed) {
+        sim_timed++;
+        sim_err_min  = err < sim_err_min ? err : sim_err_min;
+        sim_err_max  = err > sim_err_max ? err : sim_err_max;
+        sim_err_sum += err;
+    }
+#endif
+    sim_last[c] = start;
+    sim_count[c]++;
+    sim_presses++;
+    if (sim_woke >= 0.0) {
+        sim_active  = sim_woke; /* the press brought the node back */
+        sim_woke    = -1.0;
+        sim_presses = 0;
+    }
+
+    if (sim_quiet < 0) {
+        sim_quiet = getenv("HOST_PULSES") && atoi(getenv("HOST_PULSES")) == 0;
+    }
+    if (!sim_quiet) {
+        if (SIM_CHANS > 1) {
+            printf("channel %u ", c);
+        }
+        printf("pulse %6lu %16.3f s  interval %12.3f s %+9.1f ppm%s\n", sim_pulses, start,
+               interval, err,
+               resumed     ? "  (resumed)"
+               : retimed   ? "  (new interval)"
+               : !recovery ? ""
+               : sim_recover_rail ? "  (rail return)" : "  (supply recovery)");
+    }
+}
+
+void sim_pin(unsigned int port, unsigned int bit, char level, double t) {
+    unsigned int c, o, n;
+    double       w, end, off, len;
+
+    for (c = 0; c < SIM_CHANS && !SIM_IS_PIN(c, port, bit); c++) {
+    }
+    if (c == SIM_CHANS) {
+        return;
+    }
+    sim_init();
+    if (level == 'L') {
+        if (!sim_run_n[c]) {
+            sim_start[c] = t;
+            sim_pat[c]   = SIM_ESCALATE && sim_presses ? ESCALATE_PATTERN : sim_chan[c].pattern;
+            for (o = 0, n = 1; o < SIM_CHANS; o++) {
+                if (o != c && (sim_run_n[o] || sim_low[o] >= 0.0)) {
+                    n++;
+                    sim_overlaps += t - sim_start[o] > SIM_BATCH_S;
+                }
+            }
+            sim_overlaps += n > PULSE_BATCH;
+        }
+        sim_low[c] = t;
+    } else if (sim_low[c] >= 0.0) {
+        /* the run against its nominal timing; widths are listed per slot, or as a ratio */
+        if (!sim_run(sim_pat[c], sim_run_n[c], &off, &len)) {
+            off = len = SIM_WIDTH_S; /* more runs than the pattern has */
+            sim_bad_width++;
+        }
+        w          = (t - sim_low[c]) / len;
+        end        = (t - sim_start[c]) / (off + len); /* up to the end of the run */
+        sim_w_min  = w < sim_w_min ? w : sim_w_min;
+        sim_w_max  = w > sim_w_max ? w : sim_w_max;
+        sim_low[c] = -1.0;
+        if (fabs(w - 1.0) > 0.1 || fabs(end - 1.0) > 0.1) {
+            sim_bad_width++;
+        }
+        if (sim_run(sim_pat[c], ++sim_run_n[c], &off, &len)) {
+            return; /* more to come */
+        }
+        sim_run_n[c] = 0;
+        sim_pulse(c, sim_start[c]);
+    }
+}
+
+void sim_input(unsigned int port, unsigned int bit, char level, double t) {
+#if SENSE_TIMEOUT_MIN
+    /* only the edges the firmware listens to */
+    if (port + 1u == SENSE_PORT && (1u << bit) == (SENSE_PIN_BIT)
+        && (level == 'H') == (SENSE_EDGE == SENSE_EDGE_RISING)) {
+        if (sim_ready && (sim_run_n[0] || sim_low[0] >= 0.0)) {
+            sim_woke = t; /* in the middle of a press */
+        } else {
+            sim_active  = t;
+            sim_presses = 0;
+        }
+    }
+#elif EVENT_ONLY & EVENT_SENSE
+    if (port + 1u == SENSE_PORT && (1u << bit) == (SENSE_PIN_BIT)
+        && (level == 'H') == (SENSE_EDGE == SENSE_EDGE_RISING)) {
+        sim_trigger(t, EVENT_DELAY_S);
+    }
+#else
+    (void)port;
+    (void)bit;
+    (void)level;
+    (void)t;
+#endif
+}
+
+/** Whether a pattern plays on any channel: the firmware answers "busy". */
+static int sim_busy(void) {
+    unsigned int c;
+
+    for (c = 0; c < SIM_CHANS; c++) {
+        if (sim_run_n[c] || sim_low[c] >= 0.0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+void sim_console(const char *line, double t) {
+    unsigned int  c;
+    unsigned long n;
+    double        from;
+    int           k = 0;
+
+    sim_init();
+    if (sscanf(line, " %*c %lu %n", &n, &k) != 1 || line[k] || sim_busy()) {
+        return; /* not a setting, or not taken */
+    }
+    while (*line == ' ') {
+        line++;
+    }
+    if (*line == 'w' && sim_slot_ok(n)) {
+        sim_width = n / 1000.0;
+    }
+    if (*line == 'i' && SIM_RETIME && n >= 1u && n <= PULSE_INTERVAL_MIN) {
+        for (c = 0; c < SIM_CHANS; c++) {
+            if (sim_chan[c].interval != PULSE_INTERVAL_MIN * 60.0) {
+                continue;
+            }
+            from = sim_count[c] ? sim_last[c] : sim_chan[c].phase;
+            /* the nominal count so far, then on at the new interval */
+            sim_expect   += floor((from - sim_origin[c]) / sim_wait[c] + 0.5);
+            sim_wait[c]   = n * 60.0;
+            sim_exempt[c] = from + sim_wait[c] < t;
+            sim_origin[c] = sim_exempt[c] ? t - sim_wait[c] : from; /* the next pulse is now */
+        }
+    }
+}
+
+void sim_supply(double v, double t) {
+#if BATT_SAMPLE_MIN
+    if (v * 1000.0 < BATT_LOW_MV) {
+        sim_batt_low++;
+    } else if (sim_batt_low && v * 1000.0 >= BATT_RECOVER_MV) {
+        sim_recover_open(0, t, SIM_RECOVER_S, BATT_DELAY_MIN * 60.0, sim_batt_low < 8u);
+        sim_batt_low = 0;
+    }
+#else
+    (void)v;
+    (void)t;
+#endif
+}
+
+void sim_rail(int up, double t) {
+#if EVENT_ONLY & EVENT_PGOOD
+    if (up) {
+        sim_trigger(t, PGOOD_DELAY_S);
+    }
+#elif PGOOD_DELAY_S
+    if (!up) {
+        sim_rail_down = t;
+    } else {
+        sim_recover_open(1, t, SIM_PGOOD_S, PGOOD_DELAY_S, t - sim_rail_down < PGOOD_POLL_S);
+    }
+#else
+    (void)up;
+    (void)t;
+#endif
+}
+
+void sim_wrap(double t) {
+    if (sim_wraps < SIM_WRAPS_MAX) {
+        sim_wrap_t[sim_wraps] = t;
+    }
+    sim_wraps++;
+}
+
+int sim_finish(double t) {
+    double       expect = sim_expect;
+    int          stall  = 0; /* a channel without a pulse (or activity) for 1.5 intervals */
+    int          fail;
+    unsigned int i;
+
+    sim_init();
+    for (i = 0; i < SIM_CHANS; i++) {
+        double since = sim_count[i] ? sim_last[i] : sim_chan[i].phase;
+        since        = sim_active > since ? sim_active : since;
+        stall       |= t - since > 1.5 * sim_interval(i);
+        expect      += floor((t - sim_origin[i]) / SIM_INTERVAL(i));
+    }
+
+#if EVENT_ONLY
+    stall = 0;
+    sim_event_check(t);
+#endif
+    sim_recover_check(t);
+    fail = sim_skipped || sim_doubled || sim_bad_width || sim_overlaps || sim_recover_missed[0]
+           || sim_recover_missed[1] || stall;
+
+    printf("run      %.3f days virtual, %.3f s host CPU\n", t / 86400.0,
+           (double)clock() / CLOCKS_PER_SEC);
+#if EVENT_ONLY
+    printf("pulses   %lu (events %lu), ", sim_pulses, sim_events);
+    (void)expect;
+#else
+    if (sim_active > 0.0) {
+        printf("pulses   %lu (node last active %.0f s), ", sim_pulses, sim_active);
+    } else if (SIM_ADAPT) {
+        printf("pulses   %lu (%.0f at the longest interval), ", sim_pulses, expect);
+    } else {
+        printf("pulses   %lu (nominal %.0f), ", sim_pulses, expect);
+    }
+#endif
+    printf("skipped %lu, doubled %lu, width errors %lu%s\n", sim_skipped, sim_doubled,
+           sim_bad_width, stall ? ", stalled" : "");
+    if (sim_timed && EVENT_ONLY) {
+        printf("delay    %+.1f .. %+.1f ppm, mean %+.1f ppm from the trigger\n", sim_err_min,
+               sim_err_max, sim_err_sum / (double)sim_timed);
+    } else if (sim_timed && (sim_active > 0.0 || sim_recoveries[0] || sim_recoveries[1])) {
+        printf("interval %+.1f .. %+.1f ppm, mean %+.1f ppm after the last activity or pulse\n",
+               sim_err_min, sim_err_max, sim_err_sum / (double)sim_timed);
+    } else if (sim_timed && (SIM_CHANS > 1 || sim_resumed || sim_expect > 0.0)) {
+        printf("interval %+.1f .. %+.1f ppm, mean %+.1f ppm\n", sim_err_min, sim_err_max,
+               sim_err_sum / (double)sim_timed);
+    } else if (sim_timed) {
+        printf("interval %+.1f .. %+.1f ppm, mean %+.1f ppm; drift after the last pulse %+.3f s\n",
+               sim_err_min, sim_err_max, sim_err_sum / (double)sim_timed,
+               sim_last[0] - (double)sim_pulses * SIM_INTERVAL(0));
+    }
+    if (SIM_ADAPT && sim_pulses) {
+        printf("learned  %.1f .. %.1f min between pulses\n", sim_learn_min / 60.0,
+               sim_learn_max / 60.0);
+    }
+    if (sim_pulses && sim_gestures) {
+        printf("width    %.4f .. %.4f of nominal\n", sim_w_min, sim_w_max);
+    } else if (sim_pulses) {
+        printf("width    %.4f .. %.4f s per slot\n", sim_w_min * SIM_WIDTH_S,
+               sim_w_max * SIM_WIDTH_S);
+    }
+    if (SIM_CHANS > 1) {
+        printf("channels %u, %lu overlapping patterns\n", (unsigned int)SIM_CHANS, sim_overlaps);
+    }
+    if (sim_recoveries[0]) {
+        printf("supply   %lu recoveries, %lu without a pulse\n", sim_recoveries[0],
+               sim_recover_missed[0]);
+    }
+    if (sim_recoveries[1]) {
+        printf("rail     %lu returns, %lu without a pulse\n", sim_recoveries[1],
+               sim_recover_missed[1]);
+    }
+    printf("wraps    %u sched_time_t wrap(s)", sim_wraps);
+    for (i = 0; i < sim_wraps && i < SIM_WRAPS_MAX; i++) {
+        printf("%s%.0f s", i ? ", " : " at ", sim_wrap_t[i]);
+    }
+    printf("\n%s\n", fail ? "FAIL" : "PASS");
+    return fail;
+}
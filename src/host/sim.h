@@ -0,0 +1,64 @@
+/**
+ * @file sim.h
+ * @brief Pulse monitor of the host build (see sim.c); called by the peripheral model.
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+
+/**
+ * @brief A port pin changed level.
+ * @param port 0 for P1, 1 for P2
+ * @param bit  pin number
+ * @param level 'L', 'H' or 'Z'
+ * @param t    virtual time, s
+ */
+void sim_pin(unsigned int port, unsigned int bit, char level, double t);
+
+/**
+ * @brief An input pin driven from outside (HOST_HEARTBEAT) changed level: node activity.
+ * @param port 0 for P1, 1 for P2
+ * @param bit  pin number
+ * @param level 'L' or 'H'
+ * @param t    virtual time, s
+ */
+void sim_input(unsigned int port, unsigned int bit, char level, double t);
+
+/**
+ * @brief The firmware converted the supply voltage.
+ * @param v VCC, V
+ * @param t virtual time, s
+ */
+void sim_supply(double v, double t);
+
+/**
+ * @brief The node's rail dropped or came back (HOST_RAIL).
+ * @param up 1 if it came back
+ * @param t  virtual time, s
+ */
+void sim_rail(int up, double t);
+
+/**
+ * @brief The ACLK timer count since power-up crossed a multiple of 2^32 (sched_time_t wraps).
+ * @param t virtual time, s
+ */
+void sim_wrap(double t);
+
+/**
+ * @brief The serial terminal (term.c) sent a line to the console (CONSOLE_BAUD).
+ * @param line the line, without its CR
+ * @param t    virtual time of the CR, s
+ */
+void sim_console(const char *line, double t);
+
+/**
+ * @brief End of the run: print the summary.
+ * @param t virtual time, s
+ * @return process exit status: 0, or 1 if a pulse was skipped, doubled or mis-sized, a supply
+ *         recovery went without a pulse, or the pulses stopped while the node was silent
+ */
+int sim_finish(double t);
+
+#endif /* SIM_H */
@@ -0,0 +1,214 @@
+/**
+ * @file term.c
+ * @brief Serial terminal on the console pins of the host build (CONSOLE_BAUD).
+ *
+ * Modelled:
+ * - Typing: HOST_CONSOLE="<s>:<line>[;<s>:<line>...]" sends each line at <s> seconds of virtual
+ *   time (or right after the one before), one character every TERM_GAP_S, then CR. The line
+ *   into the MCU (P1.1) changes at each bit boundary; the peripheral model sets the pin's edge
+ *   flag from it and hands the whole character to USCI_A0 in the middle of the stop bit. A line
+ *   may be empty: Enter alone.
+ * - Reading: characters from USCI_A0 whole, or decoded from the P1.2 edges of the software UART
+ *   by sampling the middle of each bit; a start bit over before its middle is a glitch. Text
+ *   goes to HOST_CONSOLE_OUT if set, else to stdout line by line with its time; CR is dropped
+ *   and anything else unprintable shows as '?'.
+ * - Both run at HOST_CONSOLE_BAUD (default 9600) 8N1. The model's USCI_A0 garbles characters if
+ *   its rate is off by more than 4 %; the software UART is sampled as it comes.
+ *
+ * sim.c is told each line when its CR is sent, to follow the settings it makes.
+ */
+
+/* ---------------- Includes ---------------- */
+#include "term.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim.h"
+
+/* ---------------- Defines ---------------- */
+#define TERM_LINES    (64)    /* lines of HOST_CONSOLE */
+#define TERM_LINE_LEN (32)    /* characters per line, CR not included */
+#define TERM_GAP_S    (0.05)  /* from one character typed to the next */
+#define TERM_SKEW     (0.04)  /* bit rate mismatch a UART still receives */
+#define TERM_EDGES    (12)    /* P1.2 edges kept per character */
+
+/* ---------------- Variables ---------------- */
+static double       term_rate = 9600.0;
+static double       term_at[TERM_LINES];                     /* when each line is typed */
+static char         term_text[TERM_LINES][TERM_LINE_LEN + 1];
+static unsigned int term_lines;
+static unsigned int term_li;             /* line being typed */
+static unsigned int term_ci;             /* its character; its length = CR */
+static unsigned int term_k;              /* boundary of that character: 0 start .. 9 stop, 10 */
+static double       term_t0 = HUGE_VAL;  /* its start bit */
+static char         term_rx = 'H';       /* the line into the MCU */
+static char         term_tx = 'H';       /* the line from the MCU (software UART) */
+static double       term_tx_t0 = HUGE_VAL; /* start bit of the character on it */
+static double       term_edge_t[TERM_EDGES];
+static char         term_edge_l[TERM_EDGES];
+static unsigned int term_edges;
+static FILE        *term_out;
+static char         term_buf[128];      /* text since the last line end */
+static unsigned int term_len;
+
+/* ---------------- Functions ---------------- */
+
+int term_init(void) {
+    const char *in   = getenv("HOST_CONSOLE");
+    const char *rate = getenv("HOST_CONSOLE_BAUD");
+    const char *out  = getenv("HOST_CONSOLE_OUT");
+    const char *p;
+    double      t;
+    int         n;
+
+    if (rate) {
+        term_rate = atof(rate);
+    }
+    if (term_rate < 300.0) {
+        fprintf(stderr, "host: HOST_CONSOLE_BAUD=%s: 300 or more\n", rate);
+        exit(2);
+    }
+    if (out && !(term_out = fopen(out, "w"))) {
+        perror(out);
+        exit(2);
+    }
+    if (!in || !*in) {
+        return 0;
+    }
+    for (p = in; *p; p += *p == ';') {
+        n = 0;
+        if (term_lines == TERM_LINES || sscanf(p, "%lf:%n", &t, &n) != 1 || !n || t < 0.0
+            || strcspn(p + n, ";") > TERM_LINE_LEN) {
+            fprintf(stderr, "host: HOST_CONSOLE=%s: expected <s>:<line>[;<s>:<line>...], "
+                    "up to %d lines of %d characters\n", in, TERM_LINES, TERM_LINE_LEN);
+            exit(2);
+        }
+        p                  += n;
+        term_at[term_lines] = t;
+        memcpy(term_text[term_lines], p, strcspn(p, ";"));
+        p += strcspn(p, ";");
+        term_lines++;
+    }
+    term_t0 = term_at[0];
+    return 1;
+}
+
+double term_next(void) {
+    double rx = term_t0 + (term_k < 10u ? term_k : 9.5) / term_rate;
+    double tx = term_tx_t0 + 9.5 / term_rate;
+
+    return rx < tx ? rx : tx;
+}
+
+char term_level(void) {
+    return term_rx;
+}
+
+double term_baud(void) {
+    return term_rate;
+}
+
+/** The terminal shows character @p c, received at @p t. */
+static void term_show(uint8_t c, double t) {
+    if (c == '\r') {
+        return;
+    }
+    if (c != '\n' && (c < ' ' || c > '~')) {
+        c = '?';
+    }
+    if (term_out) {
+        fputc(c, term_out);
+        return;
+    }
+    if (c != '\n' && term_len < sizeof term_buf - 1u) {
+        term_buf[term_len++] = (char)c;
+    }
+    if (c == '\n') {
+        term_buf[term_len] = 0;
+        printf("%14.6f console %s\n", t, term_buf);
+        term_len = 0;
+    }
+}
+
+/** Level of the line from the MCU at @p t, from the edges since the start bit. */
+static char term_tx_at(double t) {
+    char         l = 'L';
+    unsigned int i;
+
+    for (i = 0; i < term_edges && term_edge_t[i] <= t; i++) {
+        l = term_edge_l[i];
+    }
+    return l;
+}
+
+/** The character on the line from the MCU ends: sample its bits. */
+static void term_tx_end(void) {
+    uint8_t      b = 0;
+    unsigned int k;
+
+    for (k = 1; k <= 8u; k++) {
+        b |= (uint8_t)((term_tx_at(term_tx_t0 + (k + 0.5) / term_rate) == 'H') << (k - 1u));
+    }
+    term_show(term_tx_at(term_tx_t0 + 9.5 / term_rate) == 'H' ? b : '?',
+              term_tx_t0 + 9.5 / term_rate);
+    term_tx_t0 = HUGE_VAL;
+}
+
+enum term_event term_step(uint8_t *byte) {
+    const char *s;
+    uint8_t     c;
+    double      t;
+
+    if (term_tx_t0 + 9.5 / term_rate <= term_t0 + (term_k < 10u ? term_k : 9.5) / term_rate) {
+        term_tx_end();
+        return TERM_NONE;
+    }
+    s = term_text[term_li];
+    c = term_ci < strlen(s) ? (uint8_t)s[term_ci] : (uint8_t)'\r';
+    if (term_k < 10u) {
+        term_rx = term_k == 0 ? 'L' : term_k == 9u || ((c >> (term_k - 1u)) & 1u) ? 'H' : 'L';
+        return term_k++ ? TERM_BIT : TERM_START;
+    }
+    /* middle of the stop bit: on to the next character, or line */
+    *byte  = c;
+    t      = term_t0 + 9.5 / term_rate;
+    term_k = 0;
+    if (c != '\r') {
+        term_ci++;
+        term_t0 += TERM_GAP_S;
+    } else {
+        sim_console(s, t);
+        term_ci = 0;
+        term_li++;
+        term_t0 += TERM_GAP_S;
+        if (term_li == term_lines) {
+            term_t0 = HUGE_VAL;
+        } else if (term_at[term_li] > term_t0) {
+            term_t0 = term_at[term_li];
+        }
+    }
+    return TERM_BYTE;
+}
+
+void term_byte(uint8_t b, double baud, double t) {
+    term_show(fabs(baud / term_rate - 1.0) > TERM_SKEW ? '?' : b, t);
+}
+
+void term_pin(unsigned int port, unsigned int bit, char level, double t) {
+    if (port != 0 || bit != 2u || level == 'Z') {
+        return;
+    }
+    if (term_tx_t0 == HUGE_VAL && term_tx == 'H' && level == 'L') {
+        term_tx_t0 = t; /* start bit */
+        term_edges = 0;
+    } else if (level == 'H' && t < term_tx_t0 + 0.5 / term_rate) {
+        term_tx_t0 = HUGE_VAL; /* a glitch, e.g. while the pin changes function */
+    } else if (term_tx_t0 != HUGE_VAL && term_edges < TERM_EDGES) {
+        term_edge_t[term_edges]   = t;
+        term_edge_l[term_edges++] = level;
+    }
+    term_tx = level;
+}
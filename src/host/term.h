@@ -0,0 +1,64 @@
+/**
+ * @file term.h
+ * @brief Serial terminal on the console pins of the host build (see term.c); driven by the
+ *        peripheral model.
+ */
+
+#ifndef TERM_H
+#define TERM_H
+
+#include <stdint.h>
+
+/** What term_step() did to the line into the MCU. */
+enum term_event {
+    TERM_NONE,  /* nothing (a character from the MCU was decoded) */
+    TERM_START, /* start bit: the line went LOW */
+    TERM_BIT,   /* next data or stop bit */
+    TERM_BYTE   /* middle of the stop bit: a UART has the character */
+};
+
+/**
+ * @brief Read HOST_CONSOLE, HOST_CONSOLE_BAUD and HOST_CONSOLE_OUT.
+ * @return 1 if there is a terminal (HOST_CONSOLE)
+ */
+int term_init(void);
+
+/**
+ * @brief Virtual time of the next term_step(), s; HUGE_VAL if nothing is pending.
+ */
+double term_next(void);
+
+/**
+ * @brief Carry out the event due at term_next().
+ * @param byte set to the character at TERM_BYTE
+ * @return @ref term_event
+ */
+enum term_event term_step(uint8_t *byte);
+
+/**
+ * @brief Level of the line into the MCU (P1.1): 'L' or 'H'.
+ */
+char term_level(void);
+
+/**
+ * @brief The terminal's bit rate.
+ */
+double term_baud(void);
+
+/**
+ * @brief A character from the MCU's UART at @p baud; garbled if that is off by more than 4 %.
+ * @param t virtual time of its stop bit, s
+ */
+void term_byte(uint8_t b, double baud, double t);
+
+/**
+ * @brief An MCU port pin changed level; P1.2 is the line from the MCU, decoded at the
+ *        terminal's bit rate (the software UART).
+ * @param port 0 for P1, 1 for P2
+ * @param bit  pin number
+ * @param level 'L', 'H' or 'Z'
+ * @param t    virtual time, s
+ */
+void term_pin(unsigned int port, unsigned int bit, char level, double t);
+
+#endif /* TERM_H */
@@ -0,0 +1,159 @@
+/**
+ * @file log.c
+ * @brief Event log in main flash (see log.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "log.h"
+
+#include "flash.h"
+#include "hal.h"
+#include "timebase.h"
+
+#if LOG_SEGS
+
+/* ---------------- Defines ---------------- */
+#if LOG_SEGS < 2 || LOG_SEGS > 4
+#error "LOG_SEGS must be 2..4: the log drops a whole segment when it moves on"
+#endif
+#if LOG_BATCH < 1 || LOG_BATCH > 16
+#error "LOG_BATCH must be 1..16: RAM keeps twice as many records"
+#endif
+
+/* Segment i of the log; LOG_SEG(LOG_SEGS) is its end */
+#define LOG_SEG(i)   (HAL_MAIN_ADDR(log_area) + (i) * FLASH_MAIN_SEG_SIZE)
+#define LOG_WORD(a)  (*(const volatile uint16_t *)HAL_FLASH_PTR(a))
+#define LOG_FIRST    (4u) /* offset of the first record slot: after the magic and sequence */
+/* Log time unit: 8192 nominal VLO cycles (0.69 s at 11805 Hz), a power of two of counts */
+#define LOG_UNIT     (8192u / TB_DIV)
+#define LOG_TIME_U   (32768UL) /* units per LOG_TIME payload step */
+/* Records after the one that fills the batch (the rest of its dispatch, or while the flash
+ * cannot be written) take up to as many again */
+#define LOG_ROOM     (2u * LOG_BATCH)
+
+/* ---------------- Variables ---------------- */
+HAL_MAIN_FLASH(log_area, LOG_SEGS * FLASH_MAIN_SEG_SIZE);
+
+/* Records not yet in flash, and room for a LOG_LOST one; kept over a reset while log_check
+ * holds the complement of log_n */
+static HAL_NOINIT uint16_t log_ram[2u * (LOG_ROOM + 1u)];
+static HAL_NOINIT uint16_t log_n;
+static HAL_NOINIT uint16_t log_check;
+
+static uint16_t log_next;  /* flash address of the next record, 0 = no segment started */
+static uint16_t log_seq = 0xFFFFu; /* sequence number of its segment; the first one is 0 */
+static uint16_t log_lost;  /* records dropped since the last flush */
+static uint32_t log_mark;  /* nominal time of the last record, counts */
+static uint16_t log_frac;  /* ... and the counts past its whole unit */
+
+/* ---------------- Functions ---------------- */
+
+/**
+ * - The started segment with the newest sequence number (wrapping) is the current one; its
+ *   first erased slot is where the next record goes.
+ */
+void log_init(void) {
+    uint16_t a, best = 0;
+    uint8_t  s;
+
+    if ((log_check ^ log_n) != 0xFFFFu || log_n > LOG_ROOM) {
+        log_n = 0;
+    }
+    log_check = log_n ^ 0xFFFFu;
+    for (s = 0; s < LOG_SEGS; s++) {
+        a = LOG_SEG(s);
+        if (LOG_WORD(a) == LOG_MAGIC
+            && (!best || (int16_t)(LOG_WORD(a + 2u) - LOG_WORD(best + 2u)) > 0)) {
+            best = a;
+        }
+    }
+    log_next = best;
+    if (!best) {
+        return;
+    }
+    log_seq  = LOG_WORD(best + 2u);
+    log_next = best + LOG_FIRST;
+    while (log_next < best + FLASH_MAIN_SEG_SIZE
+           && (LOG_WORD(log_next) != 0xFFFFu || LOG_WORD(log_next + 2u) != 0xFFFFu)) {
+        log_next += 4u;
+    }
+}
+
+/**
+ * - Nominal counts to log units with shifts only: a unit is a power of two of counts, and the
+ *   counts left over carry to the next record. The BOOT record's time word is ACLK_VLO_HZ, from
+ *   which tools/log_decode.py turns units into seconds.
+ * - A dropped record leaves log_mark where it was, so its time carries to the next one kept.
+ */
+uint8_t log_event(uint8_t type, uint16_t payload, uint32_t now) {
+    uint32_t d    = now - log_mark, u;
+    uint32_t mark = now;
+
+    if ((int32_t)d < 0) {
+        d    = 0; /* an event of the same dispatch stamped before the last one */
+        mark = log_mark;
+    }
+    d += log_frac;
+    if (type == LOG_BOOT) {
+        d    = 0;
+        mark = now;
+    }
+    u = d / LOG_UNIT; /* a shift */
+
+    if (log_n + (u > 0xFFFEu ? 2u : 1u) > LOG_ROOM) {
+        log_lost++;
+        return 1;
+    }
+    log_mark = mark;
+    log_frac = (uint16_t)(d % LOG_UNIT);
+    if (u > 0xFFFEu) {
+        log_ram[2u * log_n]      = (uint16_t)((LOG_TIME << 12) | ((u / LOG_TIME_U) & 0x0FFFu));
+        log_ram[2u * log_n + 1u] = 0;
+        log_n++;
+        u %= LOG_TIME_U;
+    }
+    log_ram[2u * log_n]      = (uint16_t)(((uint16_t)type << 12) | (payload & 0x0FFFu));
+    log_ram[2u * log_n + 1u] = type == LOG_BOOT ? ACLK_VLO_HZ : (uint16_t)u;
+    log_n++;
+    log_check = log_n ^ 0xFFFFu;
+    return log_n >= LOG_BATCH;
+}
+
+/**
+ * - A full or blank log starts the next segment (erased, with a sequence number one up); the
+ *   first segment started is number 0.
+ */
+void log_flush(void) {
+    uint16_t head[2];
+    uint8_t  i;
+
+    if (log_lost) {
+        log_lost                 = log_lost < 0x0FFFu ? log_lost : 0x0FFFu;
+        log_ram[2u * log_n]      = (uint16_t)((LOG_LOST << 12) | log_lost);
+        log_ram[2u * log_n + 1u] = 0;
+        log_n++;
+        log_lost = 0;
+    }
+    for (i = 0; i < log_n; i++) {
+        if (!log_next || log_next == LOG_SEG(LOG_SEGS)) {
+            log_next = LOG_SEG(0);
+        }
+        if ((uint16_t)(log_next - LOG_SEG(0)) % FLASH_MAIN_SEG_SIZE == 0u) {
+            flash_erase(log_next);
+            head[0] = LOG_MAGIC;
+            head[1] = ++log_seq;
+            flash_write(log_next, head, 2u);
+            log_next += LOG_FIRST;
+        }
+        flash_write(log_next, &log_ram[2u * i], 2u);
+        log_next += 4u;
+    }
+    log_n     = 0;
+    log_check = log_n ^ 0xFFFFu;
+}
+
+uint16_t log_addr(void) {
+    return LOG_SEG(0);
+}
+
+#endif /* LOG_SEGS */
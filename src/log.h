@@ -0,0 +1,86 @@
+/**
+ * @file log.h
+ * @brief Event log in a ring of main flash segments.
+ *
+ * After a node has died, the log tells whether the watcher was running and when it pressed:
+ * every boot, pulse, sense pin wake (the node came back after a quiet spell), VLO calibration
+ * and supply low or recovery is a 4-byte record. Records collect in RAM that survives a reset
+ * (@ref HAL_NOINIT) and go to flash @ref LOG_BATCH at a time, so the flash energy is spent
+ * rarely. The log fills @ref LOG_SEGS segments in turn; a segment is only erased when the log
+ * moves on to it, which drops its 127 oldest records and spreads the wear.
+ *
+ * Format version @ref LOG_VERSION, read by tools/log_decode.py (words little-endian):
+ * - Segment: @ref LOG_MAGIC, a sequence number one up on the segment started before it, then 127
+ *   record slots. The first erased slot (0xFFFF 0xFFFF) ends the segment.
+ * - Record: the type (@ref log_type) in bits 15..12 and a payload in bits 11..0, then the
+ *   time since the record before, 0..0xFFFE units of 8192 nominal VLO cycles (0.69 s at
+ *   11805 Hz), counted like the schedule. A BOOT record starts the count from 0 and its second
+ *   word is @ref ACLK_VLO_HZ instead, the units' scale; a second word of 0xFFFF is a record torn
+ *   by a power loss.
+ * - A longer gap is a LOG_TIME record of payload x 32768 units first.
+ * - A LOG_BOOT payload has 0x100 set when the schedule resumed from a checkpoint (ckpt.h).
+ * - A calibration is LOG_CAL with the top 4 bits of the Q14 @ref vlo_cal_scale, then LOG_CAL_LO
+ *   with the low 12: one step is 61 ppm. A half without the other is passed over.
+ *
+ * Dumps of a whole fleet are read by tools/log_fleet.py, so the format only changes with
+ * @ref LOG_VERSION, which is part of the magic: a reader never misreads another version, it finds
+ * no log. New record types may be added within a version; readers pass over types they do not
+ * know.
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+/** Format version: changes whenever the layout or the meaning of a type or payload does. */
+#define LOG_VERSION (3u)
+
+/** First word of a started segment. */
+#define LOG_MAGIC   (0x4C00u | LOG_VERSION)
+
+/** Record types and their payloads. */
+enum log_type {
+    LOG_BOOT     = 1, /* IFG1 reset flags (WDTIFG, PORIFG, RSTIFG, NMIIFG), 0x100 if resumed */
+    LOG_PULSE    = 2, /* channel */
+    LOG_SENSE    = 3, /* 0 */
+    LOG_CAL      = 4, /* vlo_cal_scale bits 15..12, then LOG_CAL_LO; 0 if the calibration failed */
+    LOG_BATT_LOW = 5, /* ADC10 code of VCC/2 against 1.5 V (BATT_CODE) */
+    LOG_BATT_OK  = 6, /* ADC10 code, as for LOG_BATT_LOW */
+    LOG_LOST     = 7, /* records dropped while the RAM batch was full */
+    LOG_CAL_LO   = 8, /* vlo_cal_scale bits 11..0, right after LOG_CAL */
+    LOG_TIME     = 14 /* gap of payload x 32768 units before the next record */
+};
+
+/**
+ * @brief Find the end of the log in flash; a RAM batch that survived a reset is kept.
+ * - Reads only: a blank log is started by the first log_flush().
+ */
+void log_init(void);
+
+/**
+ * @brief Add a record to the RAM batch; dropped (and counted) once it holds twice
+ *        @ref LOG_BATCH records.
+ * @param type    @ref log_type
+ * @param payload 12 bits
+ * @param now     nominal time of the event, counts (timebase.h); the time since boot at LOG_BOOT
+ * @return 1 once the batch is full: call log_flush() soon
+ */
+uint8_t log_event(uint8_t type, uint16_t payload, uint32_t now);
+
+/**
+ * @brief Write the RAM batch to flash, and a LOG_LOST record if any were dropped.
+ * - Erases the next segment first when the current one is full (~15 ms); interrupts must be
+ *   disabled and VCC at least 2.2 V (flash.h).
+ */
+void log_flush(void);
+
+/**
+ * @brief Address of the log's first segment; the log spans @ref LOG_SEGS segments of
+ *        FLASH_MAIN_SEG_SIZE bytes from there.
+ */
+uint16_t log_addr(void);
+
+#endif /* LOG_H */
@@ -3,54 +3,396 @@
  * @brief Meshtastic Watcher — Minimal low-power pulse (MSP430G2553)
  *
  * @section what_it_does What it does
- * - Generates a LOW pulse on PULSE_PIN_BIT every @ref PULSE_INTERVAL_MIN minutes.
- * - Optimized for minimal energy; ~0.1 µA typical in LPM3 (excluding pulse time).
+ * - Generates a LOW pulse on PULSE_PIN_BIT every @ref PULSE_INTERVAL_MIN minutes; or, with
+ *   @ref PULSE_CHANNELS, a pulse pattern per channel (one node each) on its own pin, interval
+ *   and phase. Channels due together are pulsed one after the other, or @ref PULSE_BATCH at a
+ *   time; with @ref PULSE_OUT, dozens of them on shift register or I2C expander lines.
+ * - A pattern is a few presses on a grid of @ref PULSE_MS slots, or a gesture from
+ *   @ref PULSE_GESTURES: a list of press and release durations for clicks and long presses.
+ * - With @ref BATT_SAMPLE_MIN, also pulses @ref BATT_DELAY_MIN minutes after the supply recovers
+ *   from a deep discharge, and the schedule continues from there.
+ * - With @ref PGOOD_DELAY_S, also pulses that many seconds after Comparator_A+ sees the node's
+ *   rail come back.
+ * - With @ref SENSE_TIMEOUT_MIN, pulses only once the node has shown no activity on the sense pin
+ *   for that many minutes. While it stays silent it gets a long press @ref ESCALATE_GAP_MIN
+ *   minutes later, then more at doubling gaps up to @ref ESCALATE_MAX_MIN.
+ * - With @ref ADAPT_MIN_MIN, keeps the schedule but learns its interval from the sense pin: half
+ *   the time the node typically stays up after a press that brought it back.
+ * - With @ref CKPT_MIN, keeps the time left to each deadline over resets and power losses, in
+ *   RAM and in Info flash, and resumes the schedule from it at boot.
+ * - With @ref LOG_SEGS, records boots, pulses, sense pin wakes, VLO calibrations and supply
+ *   changes in a ring of main flash segments, for tools/log_decode.py to read back.
+ * - With @ref CONSOLE_BAUD, a serial console shows the time, counters and settings, dumps the
+ *   event log, and sets the interval and pulse width until the next reset.
+ * - With @ref CONF_BLOCK, takes the interval, pulse width and VLO frequency of the site from a
+ *   block in Info flash at boot, so one build serves many sites (conf.h).
+ * - With @ref STRAP_INTERVAL_BIT and @ref STRAP_WIDTH_BIT, picks the interval and pulse width
+ *   from resistor straps on P2 read once at boot (strap.h).
+ * - With @ref EVENT_ONLY, keeps no schedule: sleeps in LPM4 with all clocks off and pulses only
+ *   on a sense pin edge or the node's rail coming back, then ignores events for
+ *   @ref EVENT_HOLDOFF_S seconds.
+ * - Optimized for minimal energy; ~0.5 µA typical in LPM3 with the VLO (see the README energy
+ *   budget).
  *
  * @section how_it_does How it does
- * - Timer_A runs from ACLK = VLO (~12 kHz) and interrupts every ~30 s.
- *   The ISR accumulates 30 s ticks until the target interval elapses, then emits the pulse.
+ * - Timer_A runs from ACLK = VLO (~12 kHz). timebase.h picks the dividers at build time so an
+ *   interval takes the fewest timer wakes (~6 min apart for the 12 h default).
+ * - sched.c keeps absolute time on Timer_A; the next pulse is an event at an absolute deadline,
+ *   reached with only the counter rollovers plus one final compare (@ref SCHED_TICKLESS).
  * - Output uses open-drain behavior: idle Hi-Z; only driven LOW during the pulse by switching
- * PULSE_PIN_BIT to output-low.
+ * the channel pin to output-low. @ref PULSE_MODE_OUTMOD holds it on TA0.1 at OUT = 0 and the
+ * CCR1 interrupt releases it, so it is never driven HIGH either.
+ * - chan.c keeps each channel's next deadline in nominal counts, in a heap; the earliest one is
+ *   the single pulse event, and a channel due while a batch of patterns runs starts at its end.
+ * - out.c changes all lines of a pattern slot in one P1DIR write or one expander transfer, and
+ *   leaves the expander interface idle in between.
  * - CPU remains in LPM3 between interrupts for low power.
- * - DCO (1 MHz) is only enabled to time the pulse with a simple busy-wait delay.
+ * - The pulse is timed by Timer_A TACCR1 (@ref PULSE_MODE_TIMER), one match per slot or
+ *   gesture duration; the CPU sleeps in LPM3 while the pin is held LOW. @ref PULSE_MODE_DELAY
+ *   keeps the legacy DCO busy-wait instead.
+ * - The sense pin interrupt is taken once per burst of activity, then masked; the latched edge
+ *   flag is polled every 1/8 of @ref SENSE_TIMEOUT_MIN while the node stays active (sense.h).
+ * - The console's RX pin interrupt waits for a key; on the G2553 USCI_A0 then runs from SMCLK
+ *   in LPM0 until @ref CONSOLE_IDLE_S passes without one (console.h).
  * - All unused pins are configured as outputs driven LOW to minimize leakage.
  *
  * @section pins Pins
- * - OUTPUT -> PULSE_PIN_BIT  (active-LOW pulse; idle Hi-Z; open-drain style)
+ * - OUTPUT -> PULSE_PIN_BIT  (active-LOW pulse; idle Hi-Z; open-drain style); one P1 pin per
+ *   channel with @ref PULSE_CHANNELS
+ * - OUTPUT -> P2.EXP_SER_BIT, EXP_SCK_BIT, EXP_RCK_BIT (74HC595 chain; @ref PULSE_OUT_595)
+ * - I2C    <> P1.6 SCL, P1.7 SDA (PCF8574 expanders; @ref PULSE_OUT_PCF8574)
+ * - INPUT  <- P1.PGOOD_CA   (CAx: node rail through a divider; only with @ref PGOOD_DELAY_S)
+ * - INPUT  <- SENSE_PIN_BIT  (node LED or heartbeat GPIO; with @ref SENSE_TIMEOUT_MIN or
+ *   @ref EVENT_SENSE)
+ * - UART   <> P1.1 RX, P1.2 TX (serial console; only with @ref CONSOLE_BAUD)
  * - GND    -> common ground with the target device
  *
- * @section build_config Build-time config
+ * @section build_config Build-time config (config.h)
  * - @ref PULSE_INTERVAL_MIN : Minutes between pulses
  * - @ref PULSE_MS           : Pulse width in milliseconds.
  * - @ref PULSE_PIN_BIT      : Output pin bit mask
+ * - @ref PULSE_PATTERN      : Pulse pattern in PULSE_MS slots (default: a single pulse)
+ * - @ref PULSE_GESTURES, @ref GESTURE_MS : Gestures as press/release durations, their unit
+ * - @ref PULSE_CHANNELS     : Channel list: pin, interval, phase and pattern per node
+ * - @ref PULSE_OUT, @ref PULSE_BATCH : Line outputs (P1 or expanders), patterns started at once
+ * - @ref EXP_COUNT, @ref EXP_SER_BIT, @ref EXP_SCK_BIT, @ref EXP_RCK_BIT, @ref EXP_I2C_ADDR,
+ *   @ref EXP_I2C_KHZ : Expander chain
  * - @ref DBG_PIN_BIT        : Debug output pin bit mask (pulses on startup)
+ * - @ref PULSE_MODE         : How the pulse width is timed (DCO busy-wait or TACCR1)
+ * - @ref TIMEBASE_ERR_PPM   : Timer rounding error budget for one interval
+ * - @ref SCHED_TICKLESS     : Continuous timer with per-event compares, or fixed ticks
+ * - @ref VLO_CAL_HOURS      : VLO calibration period against the DCO (0 = off)
+ * - @ref TEMPCOMP_MIN       : Temperature sampling period for VLO compensation (0 = off)
+ * - @ref BATT_SAMPLE_MIN    : Supply sampling period for the recovery pulse (0 = off)
+ * - @ref BATT_LOW_MV, @ref BATT_RECOVER_MV, @ref BATT_RISE_SAMPLES, @ref BATT_DELAY_MIN :
+ *   Recovery detection and the delay of its pulse
+ * - @ref PGOOD_DELAY_S      : Pulse delay after the node's rail comes back (0 = not watched)
+ * - @ref PGOOD_POLL_S, @ref PGOOD_CA, @ref PGOOD_REF : Comparator duty cycle, input, threshold
+ * - @ref SENSE_TIMEOUT_MIN  : Silence on the sense pin before a pulse (0 = pulse blindly)
+ * - @ref SENSE_PORT, @ref SENSE_PIN_BIT, @ref SENSE_EDGE, @ref SENSE_PULL : Sense input
+ * - @ref ESCALATE_GAP_MIN, @ref ESCALATE_MAX_MIN, @ref ESCALATE_PATTERN : Presses of a silent
+ *   node after the first (0 = one every timeout)
+ * - @ref ADAPT_MIN_MIN, @ref ADAPT_QUIET_MIN : Shortest learned interval (0 = fixed), silence
+ *   that counts as a hang
+ * - @ref CKPT_MIN, @ref CKPT_FLASH_MIN : Schedule checkpoints to RAM (0 = off), and to flash
+ * - @ref LOG_SEGS, @ref LOG_BATCH : Event log segments (0 = off), records per flash write
+ * - @ref CONSOLE_BAUD, @ref CONSOLE_IDLE_S : Serial console (0 = off), idle time to its close
+ * - @ref CONF_BLOCK         : Site block in Info flash read at boot (0 = compiled values only)
+ * - @ref STRAP_INTERVAL_BIT, @ref STRAP_WIDTH_BIT : Strap pins on P2 (0 = none), and the
+ *   values picked by a tie to GND or VCC
+ * - @ref EVENT_ONLY         : Wake sources of the event-only LPM4 mode (0 = scheduled)
+ * - @ref EVENT_DELAY_S, @ref EVENT_HOLDOFF_S : Sense edge to pulse, events ignored after it
  *
  * @section notes Notes
  * - Assumes the target side provides a pull-up on the button GPIO.
- * - Timing uses VLO; expect drift vs. temperature and voltage.
+ * - Timing uses VLO; vlo_cal.c re-measures it against the calibrated DCO at boot and every
+ *   @ref VLO_CAL_HOURS hours; tempcomp.c follows its temperature drift in between from a
+ *   per-device table. Supply voltage drift is not compensated.
  */
 
 /* ---------------- Includes ---------------- */
-#include <msp430.h>
+#include <stdint.h>
+
+#include "batt.h"
+#include "chan.h"
+#include "ckpt.h"
+#include "conf.h"
+#include "config.h"
+#include "console.h"
+#include "fixed.h"
+#include "flash.h"
+#include "gesture.h"
+#include "hal.h"
+#include "log.h"
+#include "out.h"
+#include "pgood.h"
+#include "sched.h"
+#include "sense.h"
+#include "tempcomp.h"
+#include "timebase.h"
+#include "vlo_cal.h"
 
 /* ---------------- Defines ---------------- */
-#define PULSE_INTERVAL_MIN (60 * 12) /* minutes between pulses */
-#define PULSE_MS           (500u)    /* pulse duration in ms */
-#define PULSE_PIN_BIT      (BIT4)    /* output pin: P1.4 */
-#define DBG_PIN_BIT        (BIT3)    /* output pin: P1.3 */
-
-/* Timer_A constants for ~30 s base period with VLO */
-#define ACLK_VLO_HZ        (11805u) // VLO is ~12 kHz, measured to be 11.8 kHz
-#define TIMER_DIV          (8u)
-#define TIMER_HZ           (ACLK_VLO_HZ / TIMER_DIV)
-#define BASE_PERIOD_S      (30u)
-#define CCR0_30S           ((unsigned int)((unsigned long)BASE_PERIOD_S * (unsigned long)TIMER_HZ - 1u))
+/* TAIV vector values (not every device header provides the TA0IV_ names) */
+#ifndef TA0IV_TACCR1
+#define TA0IV_TACCR1 (0x0002)
+#endif
+#ifndef TA0IV_TAIFG
+#define TA0IV_TAIFG  (0x000A)
+#endif
+
+#if PULSE_MODE != PULSE_MODE_DELAY && PULSE_MODE != PULSE_MODE_TIMER                              \
+        && PULSE_MODE != PULSE_MODE_OUTMOD
+#error "Unknown PULSE_MODE"
+#endif
+
+#if PULSE_MODE == PULSE_MODE_OUTMOD                                                               \
+        && (PULSE_OUT != PULSE_OUT_GPIO || PULSE_BATCH != 1 || (CHAN_PINS & ~(BIT2 | BIT6)))
+#error "PULSE_MODE_OUTMOD needs every channel on a TA0.1 pin (BIT2 or BIT6), one at a time"
+#endif
+
+#if PULSE_BATCH < 1 || PULSE_BATCH > 255
+#error "PULSE_BATCH must be 1..255"
+#endif
+/* Patterns that can run at once */
+#define PULSE_BATCH_N (PULSE_BATCH < CHAN_COUNT ? PULSE_BATCH : CHAN_COUNT)
+
+#if (OUT_P1_BITS & DBG_PIN_BIT) || (OUT_P2_BITS & ~0x3F)
+#error "DBG_PIN_BIT is taken by a channel or an expander; expander pins are P2.0..P2.5"
+#endif
+
+#if CHAN_COUNT > 1                                                                                \
+        && (SENSE_TIMEOUT_MIN || ADAPT_MIN_MIN || BATT_SAMPLE_MIN || PGOOD_DELAY_S || EVENT_ONLY)
+#error "SENSE_TIMEOUT_MIN, ADAPT_MIN_MIN, BATT_SAMPLE_MIN, PGOOD_DELAY_S, EVENT_ONLY: one channel"
+#endif
+
+#if PULSE_MODE != PULSE_MODE_DELAY
+#if GESTURE_COUNT && GESTURE_MS * ACLK_VLO_HZ < 2000 * TB_DIV
+#error "GESTURE_MS is shorter than two timer counts"
+#endif
+#define GESTURE_Q8  TB_MS_Q8(GESTURE_MS)              /* gesture unit in nominal counts, Q8 */
+#define PULSE_CHUNK ((uint16_t)(TB_PERIOD_COUNTS / 2u)) /* longest TACCR1 step, timer counts */
+#endif
+
+/* Timer counts per nominal count are kept within what fx_recip_q14() accepts */
+#define PULSE_RATE_MIN (FX_ONE / 4u)
+
+/* Presses a silent node gets after the first: ESCALATE_PATTERN at growing gaps */
+#define ESCALATE_USED      (SENSE_TIMEOUT_MIN && ESCALATE_GAP_MIN)
+
+#if SENSE_TIMEOUT_MIN && ADAPT_MIN_MIN
+#error "ADAPT_MIN_MIN learns the interval that SENSE_TIMEOUT_MIN replaces; set one of them"
+#endif
+
+#if SENSE_TIMEOUT_MIN
+/* Nominal counts from the last activity (or pulse) to the next pulse */
+#define PULSE_WAIT_COUNTS  TB_SECONDS(SENSE_TIMEOUT_MIN * 60UL)
+#if ESCALATE_USED
+/* From the last activity, or from the last press while the node stays silent */
+#define PULSE_WAIT(c)      (escalate_pressed ? escalate_gap : PULSE_WAIT_COUNTS)
+#else
+#define PULSE_WAIT(c)      PULSE_WAIT_COUNTS /* the timeout replaces the interval */
+#endif
+/* Sense pin poll period while the node is active: a pulse comes 1 to 9/8 timeouts after the
+ * last edge */
+#define SENSE_CHECK_COUNTS (PULSE_WAIT_COUNTS / 8u)
+#elif ADAPT_MIN_MIN
+#if EVENT_ONLY
+#error "ADAPT_MIN_MIN learns the interval of the schedule; EVENT_ONLY has none"
+#endif
+#if ADAPT_QUIET_MIN < 1 || ADAPT_QUIET_MIN >= ADAPT_MIN_MIN || ADAPT_MIN_MIN > PULSE_INTERVAL_MIN
+#error "1 <= ADAPT_QUIET_MIN < ADAPT_MIN_MIN <= PULSE_INTERVAL_MIN must hold"
+#endif
+#define ADAPT_MIN_COUNTS   TB_SECONDS(ADAPT_MIN_MIN * 60UL)
+#define ADAPT_MAX_COUNTS   TB_INTERVAL_COUNTS
+#define ADAPT_QUIET_COUNTS TB_SECONDS(ADAPT_QUIET_MIN * 60UL)
+/* Nominal counts from one pulse to the next, as learned (there is one channel) */
+#define PULSE_WAIT(c)      ((void)(c), adapt_wait)
+/* Sense pin poll period while the node is active: the last activity is known to 1/8 of the
+ * silence that counts as a hang */
+#define SENSE_CHECK_COUNTS (ADAPT_QUIET_COUNTS / 8u)
+#elif CONF_INTERVAL
+/* Nominal counts from one pulse of channel c to its next; the channels at PULSE_INTERVAL_MIN
+ * take the interval of the site block or the console */
+#define PULSE_WAIT(c)                                                                              \
+    (chan_cfg[c].wait == TB_INTERVAL_COUNTS ? conf.interval : chan_cfg[c].wait)
+#else
+/* Nominal counts from one pulse of channel c to its next */
+#define PULSE_WAIT(c)      (chan_cfg[c].wait)
+#endif
+
+#if CONF_USED
+/* Pattern slot, from the site block or the console */
+#define PULSE_SLOT_MS      (conf.slot_ms)
+#define PULSE_SLOT_COUNTS  (conf.slot_counts)
+#else
+#define PULSE_SLOT_MS      (PULSE_MS)
+#define PULSE_SLOT_COUNTS  (TB_PULSE_TICKS)
+#endif
+
+#if ESCALATE_USED
+#if ESCALATE_GAP_MIN < 1 || ESCALATE_MAX_MIN < ESCALATE_GAP_MIN                                   \
+        || ESCALATE_MAX_MIN > PULSE_INTERVAL_MIN
+#error "ESCALATE_GAP_MIN <= ESCALATE_MAX_MIN <= PULSE_INTERVAL_MIN must hold"
+#endif
+#if (ESCALATE_PATTERN <= 0xFF && !(ESCALATE_PATTERN & 1))                                         \
+        || ESCALATE_PATTERN >= GESTURE(GESTURE_COUNT)
+#error "ESCALATE_PATTERN must fit a byte and start with a LOW slot (bit 0), or be a GESTURE"
+#endif
+#define ESCALATE_GAP_COUNTS TB_SECONDS(ESCALATE_GAP_MIN * 60UL)
+#define ESCALATE_MAX_COUNTS TB_SECONDS(ESCALATE_MAX_MIN * 60UL)
+/* Pattern of channel c's press, fixed when it starts (there is one channel) */
+#define PULSE_PATTERN_OF(c) ((void)(c), escalate_pattern)
+#else
+#define PULSE_PATTERN_OF(c) (chan_cfg[c].pattern)
+#endif
+
+#if SENSE_USED
+#if (SENSE_PORT == 1 && (SENSE_PIN_BIT & (OUT_P1_BITS | DBG_PIN_BIT)))                            \
+        || (SENSE_PORT == 2 && (SENSE_PIN_BIT & OUT_P2_BITS))
+#error "SENSE_PIN_BIT is taken by an output or the debug pin"
+#endif
+#define SENSE_P1_BIT       (SENSE_PORT == 1 ? SENSE_PIN_BIT : 0)
+#define SENSE_P2_BIT       (SENSE_PORT == 2 ? SENSE_PIN_BIT : 0)
+#else
+#define SENSE_P1_BIT       (0)
+#define SENSE_P2_BIT       (0)
+#endif
+
+#if EVENT_ONLY
+#if EVENT_ONLY & ~(EVENT_SENSE | EVENT_PGOOD)
+#error "EVENT_ONLY takes EVENT_SENSE and/or EVENT_PGOOD"
+#endif
+#if !SCHED_TICKLESS
+#error "EVENT_ONLY needs SCHED_TICKLESS"
+#endif
+#if SENSE_TIMEOUT_MIN || TEMPCOMP_MIN || BATT_SAMPLE_MIN || PGOOD_POLL_S
+#error "EVENT_ONLY: set SENSE_TIMEOUT_MIN, TEMPCOMP_MIN, BATT_SAMPLE_MIN and PGOOD_POLL_S to 0"
+#endif
+#if !(EVENT_ONLY & EVENT_PGOOD) != !PGOOD_DELAY_S
+#error "EVENT_PGOOD and PGOOD_DELAY_S go together in EVENT_ONLY builds"
+#endif
+#if EVENT_HOLDOFF_S * 1000L <= PULSE_MS * 8L || EVENT_HOLDOFF_S * 1000L <= GESTURE_TOTAL_MS
+#error "EVENT_HOLDOFF_S must be longer than the longest pattern (8 slots of PULSE_MS, gestures)"
+#endif
+#define EVENT_DELAY_COUNTS   TB_SECONDS(EVENT_DELAY_S)
+#define EVENT_HOLDOFF_COUNTS TB_SECONDS(EVENT_HOLDOFF_S)
+#endif
+
+#if CKPT_MIN && EVENT_ONLY
+#error "CKPT_MIN keeps the schedule; EVENT_ONLY has none"
+#endif
+
+#if BATT_SAMPLE_MIN
+#if (SENSE_TIMEOUT_MIN && BATT_DELAY_MIN > SENSE_TIMEOUT_MIN)                                      \
+        || (!SENSE_TIMEOUT_MIN && BATT_DELAY_MIN > PULSE_INTERVAL_MIN)
+#error "BATT_DELAY_MIN must not exceed the pulse interval (or SENSE_TIMEOUT_MIN)"
+#endif
+#define BATT_SAMPLE_COUNTS TB_SECONDS(BATT_SAMPLE_MIN * 60UL)
+#define BATT_DELAY_COUNTS  TB_SECONDS(BATT_DELAY_MIN * 60UL)
+#endif
+
+#if PGOOD_DELAY_S
+#define PGOOD_P1_BIT       (1u << PGOOD_CA)
+#if PGOOD_P1_BIT & (OUT_P1_BITS | DBG_PIN_BIT | SENSE_P1_BIT)
+#error "PGOOD_CA is on an output, the debug or the sense pin"
+#endif
+#if (SENSE_TIMEOUT_MIN && PGOOD_DELAY_S > SENSE_TIMEOUT_MIN * 60L)                                 \
+        || (!SENSE_TIMEOUT_MIN && PGOOD_DELAY_S > PULSE_INTERVAL_MIN * 60L)
+#error "PGOOD_DELAY_S must not exceed the pulse interval (or SENSE_TIMEOUT_MIN)"
+#endif
+#if PGOOD_POLL_S && !SCHED_TICKLESS
+#error "PGOOD_POLL_S needs SCHED_TICKLESS: events only run on the minutes-long timer tick otherwise"
+#endif
+#define PGOOD_DELAY_COUNTS TB_SECONDS(PGOOD_DELAY_S)
+#define PGOOD_POLL_COUNTS  TB_SECONDS(PGOOD_POLL_S)
+#else
+#define PGOOD_P1_BIT       (0)
+#endif
+
+#if CONSOLE_BAUD
+#if (CONSOLE_RX_BIT | CONSOLE_TX_BIT) & (OUT_P1_BITS | DBG_PIN_BIT | SENSE_P1_BIT | PGOOD_P1_BIT)
+#error "The console's P1.1 and P1.2 are taken by a channel, the debug, sense or power-good pin"
+#endif
+#define CONSOLE_IDLE_COUNTS TB_SECONDS(CONSOLE_IDLE_S)
+#define CONSOLE_P1_BITS    (CONSOLE_RX_BIT)
+#define CONSOLE_P1_HIGH    (CONSOLE_TX_BIT) /* idle line: no start bit for the terminal */
+#else
+#define CONSOLE_P1_BITS    (0)
+#define CONSOLE_P1_HIGH    (0)
+#endif
+
+#if STRAP_P2_BITS
+#if STRAP_P2_BITS & (OUT_P2_BITS | SENSE_P2_BIT | BIT6 | BIT7)
+#error "A strap pin is taken by an expander or the sense pin; straps are P2.0..P2.5"
+#endif
+#if (STRAP_INTERVAL_BIT & (STRAP_INTERVAL_BIT - 1)) || (STRAP_WIDTH_BIT & (STRAP_WIDTH_BIT - 1))  \
+        || (STRAP_INTERVAL_BIT & STRAP_WIDTH_BIT)
+#error "STRAP_INTERVAL_BIT and STRAP_WIDTH_BIT must be one P2 pin each, not the same"
+#endif
+#endif
+
+/* Port pins left as inputs by gpio_init_lowpower(); the 595 pins are outputs resting LOW */
+#define GPIO_P1_INPUTS     (OUT_P1_BITS | SENSE_P1_BIT | PGOOD_P1_BIT | CONSOLE_P1_BITS)
+#define GPIO_P2_INPUTS     (SENSE_P2_BIT)
+
+/* ---------------- Variables ---------------- */
+/*
+ * Deadlines are kept in nominal counts (timer counts at ACLK_VLO_HZ, chan.h). pulse_base is the
+ * nominal time at pulse_mark; each stretch of timer counts after it is credited at the VLO rate
+ * that held during it, so a new estimate only rescales the part of each interval still to come.
+ */
+static uint16_t     pulse_rate     = FX_ONE;         /* timer counts per nominal count, Q14 */
+static uint16_t     pulse_rate_inv = FX_ONE;         /* nominal counts per timer count, Q14 */
+static uint32_t     pulse_base;                      /* nominal counts at pulse_mark (wraps) */
+static sched_time_t pulse_mark;                      /* time of the last pulse or rate change */
+#if PULSE_MODE != PULSE_MODE_DELAY
+static uint16_t     pulse_ticks    = TB_PULSE_TICKS; /* pattern slot in timer counts */
+static uint32_t     pulse_left;                      /* counts of the step not yet armed */
+#endif
+static uint8_t      pulse_batch[PULSE_BATCH_N];      /* channels of the running patterns */
+static uint8_t      pulse_n;                         /* their number, 0 = none running */
+static uint8_t      pulse_k;                         /* their current step (slot or duration) */
+static const uint8_t *pulse_code;                    /* gesture of the batch, 0 = slot patterns */
+#if ESCALATE_USED
+static uint8_t      escalate_pressed; /* pressed since the node last showed activity */
+static uint16_t     escalate_pattern; /* pattern of the last press */
+static uint32_t     escalate_gap;     /* nominal counts from the last press to the next */
+#endif
+#if ADAPT_MIN_MIN
+/* Typical up time after a press that brought the node back, nominal counts; kept over a reset
+ * while adapt_check holds its complement */
+static HAL_NOINIT uint32_t adapt_up;
+static HAL_NOINIT uint32_t adapt_check;
+static uint32_t     adapt_wait;   /* learned interval, nominal counts */
+static uint32_t     adapt_since;  /* nominal time of the last press that found the node hung */
+static uint32_t     adapt_active; /* ... and of the last activity seen */
+#endif
+#if CKPT_MIN
+static uint8_t      ckpt_wait = CKPT_FLASH_N; /* checkpoints to the next one to flash */
+#endif
+#if LOG_SEGS && BATT_SAMPLE_MIN
+static uint8_t      log_vcc_ok = 1; /* the last supply sample read 2.2 V or more */
+#endif
+#if EVENT_ONLY
+static volatile uint8_t event_busy; /* pulse pending or holdoff running; LPM4 when clear */
+#endif
+#if TEMPCOMP_MIN
+static uint16_t     temp_factor    = FX_ONE;         /* VLO factor at the last temperature sample */
+static uint16_t     temp_ref_inv   = FX_ONE;         /* 1 / VLO factor at the last calibration */
+#endif
+#if CONSOLE_BAUD
+static uint32_t     pulse_count;                     /* presses since boot */
+#if SENSE_USED
+static uint32_t     sense_count;                     /* sense pin wakes since boot */
+#endif
+#endif
 
 /* ---------------- Functions ---------------- */
 
 /**
  * @brief Initialize system clocks.
- * - ACLK = VLO (~12 kHz) for Timer_A.
+ * - ACLK = VLO (~12 kHz) / TB_DIVA_DIV for Timer_A.
  * - DCO = 1 MHz used for delay_ms().
  */
 static void clocks_init(void) {
@@ -59,35 +401,28 @@ static void clocks_init(void) {
         BCSCTL1 = CALBC1_1MHZ;
         DCOCTL  = CALDCO_1MHZ;
     }
+    BCSCTL1 = (BCSCTL1 & ~DIVA_3) | TB_DIVA_BITS; /* CALBC1 leaves DIVA = /1 */
 }
 
 /**
  * @brief Initialize GPIO for low power.
- * - All unused pins set as outputs = 0.
- * - Pulse pin starts in Hi-Z (input); prepared LOW when driven.
+ * - All unused pins set as outputs = 0, but the console's TX (CONSOLE_BAUD), which rests HIGH.
+ * - Channel pins start in Hi-Z (input); prepared LOW when driven. So do SCL and SDA of the
+ *   PCF8574 expanders, on the bus pull-ups.
+ * - The sense and power-good pins are left inputs, never driven against the node.
  */
 static void gpio_init_lowpower(void) {
-    P1OUT = 0x00;
-    P1DIR = 0xFF & ~PULSE_PIN_BIT; /* all outputs low; pulse pin as input */
+    P1OUT = CONSOLE_P1_HIGH;
+    P1DIR = 0xFF & ~GPIO_P1_INPUTS; /* all outputs low; channel (sense, power-good) pins inputs */
     P2OUT = 0x00;
-    P2DIR = 0xFF;
+    P2DIR = 0xFF & ~GPIO_P2_INPUTS;
 
-    P1SEL  &= ~PULSE_PIN_BIT;
-    P1SEL2 &= ~PULSE_PIN_BIT;
-    P1REN  &= ~PULSE_PIN_BIT; /* no internal pull */
+    P1SEL  &= ~OUT_P1_BITS;
+    P1SEL2 &= ~OUT_P1_BITS;
+    P1REN  &= ~OUT_P1_BITS; /* no internal pull */
     /* P1OUT bit already 0 -> ready to drive LOW when DIR=1 */
 }
 
-/**
- * @brief Initialize Timer_A to interrupt every ~30 s.
- */
-static void timerA_init_30s(void) {
-    TACTL    = TASSEL_1 | ID_3 | TACLR; /* ACLK, /8, clear */
-    TACCR0   = CCR0_30S;                /* ~30 s */
-    TACCTL0  = CCIE;                    /* enable CCR0 interrupt */
-    TACTL   |= MC_1;                    /* up mode */
-}
-
 /**
  * @brief Simple delay in milliseconds using DCO=1 MHz.
  * @param ms number of milliseconds to delay
@@ -98,17 +433,725 @@ static void delay_ms(unsigned int ms) {
     }
 }
 
+#if PULSE_MODE == PULSE_MODE_OUTMOD
 /**
- * @brief Generate a LOW pulse (open-drain style).
- * - Switch pin to output-LOW for @ref PULSE_MS, then back to input (Hi-Z).
+ * @brief Drive channel pin @p pin LOW for the step that starts now, following the TA0.1 output
+ *        held at OUT = 0 (OUTMOD_0); the output unit never sets it.
  */
-static void do_pulse(void) {
-    P1OUT &= ~PULSE_PIN_BIT; /* ensure LOW when driven */
-    P1DIR |= PULSE_PIN_BIT;  /* drive LOW */
-    delay_ms(PULSE_MS);
-    P1DIR &= ~PULSE_PIN_BIT; /* back to Hi-Z */
+static void pulse_low(uint8_t pin) {
+    if (!(P1SEL & pin)) {
+        TACCTL1  = OUTMOD_0 | CCIE; /* output unit drives OUT = 0 */
+        P1SEL   |= pin;             /* pin follows TA0.1 */
+        P1DIR   |= pin;             /* drive LOW */
+    }
+}
+
+/**
+ * @brief Release channel pin @p pin: input (Hi-Z) first, which is the trailing edge, then GPIO
+ *        function.
+ * - The line is tied to the target's pull-up, so it is never driven HIGH.
+ */
+static void pulse_release(uint8_t pin) {
+    P1DIR   &= ~pin; /* back to Hi-Z: the edge */
+    P1SEL   &= ~pin; /* back to GPIO */
+    TACCTL1  = CCIE; /* OUT = 0, unused until the next LOW slot */
     /* P1OUT stays 0 for the next pulse */
 }
+#endif
+
+/**
+ * @brief Whether member @p i of the running batch holds its line LOW in step @p k.
+ */
+static uint8_t pulse_is_low(uint8_t i, uint8_t k) {
+    if (pulse_code) {
+        return !(k & 1u) && pulse_code[k]; /* LOW, Hi-Z, LOW, ... up to the 0 */
+    }
+    return (uint8_t)(PULSE_PATTERN_OF(pulse_batch[i]) >> k) & 1u;
+}
+
+#if PULSE_MODE != PULSE_MODE_DELAY
+/**
+ * @brief Arm TACCR1 for the rest of the step, at most @ref PULSE_CHUNK counts of it; a longer
+ *        step takes several matches.
+ */
+static void pulse_arm(void) {
+    uint16_t n = pulse_left > PULSE_CHUNK ? PULSE_CHUNK : (uint16_t)pulse_left;
+
+    pulse_left -= n;
+    TACCR1      = sched_compare_in(n);
+}
+#endif
+
+#if PULSE_MODE == PULSE_MODE_OUTMOD
+/**
+ * @brief Hand the single channel's pin to TA0.1 for the part of step pulse_k just armed.
+ * - A LOW stretch stays on the timer output until a Hi-Z step releases it.
+ */
+static void pulse_outmod(void) {
+    uint8_t pin = chan_cfg[pulse_batch[0]].pin;
+
+    if (pulse_is_low(0, pulse_k)) {
+        pulse_low(pin);
+    } else {
+        pulse_release(pin);
+    }
+}
+#endif
+
+/**
+ * @brief Output step pulse_k of the running batch (open-drain style): in a LOW step a member
+ *        holds its line LOW, in a Hi-Z one it releases it.
+ * - Slot patterns step by @ref PULSE_MS slots, a gesture by its own durations.
+ * - All lines change with one out_write(). @ref PULSE_MODE_OUTMOD: the single channel's pin
+ *   follows TA0.1 instead, held at OUT = 0.
+ * - Timer modes arm TACCR1 for the step; @ref PULSE_MODE_DELAY busy-waits through it.
+ * @return 0 if the batch is over (nothing is output)
+ */
+static uint8_t pulse_out(void) {
+    uint8_t more = 0;
+    uint8_t i;
+
+    if (pulse_code) {
+        more = pulse_code[pulse_k];
+    } else {
+        for (i = 0; i < pulse_n; i++) {
+            more |= (uint8_t)(PULSE_PATTERN_OF(pulse_batch[i]) >> pulse_k);
+        }
+    }
+    if (!more) {
+        return 0;
+    }
+#if PULSE_MODE != PULSE_MODE_DELAY
+    pulse_left = pulse_code ? fx_mul_q14(((uint32_t)more * GESTURE_Q8 + 128u) >> 8, pulse_rate)
+                            : pulse_ticks;
+    pulse_arm();
+#endif
+#if PULSE_MODE == PULSE_MODE_OUTMOD
+    pulse_outmod();
+#else
+    for (i = 0; i < pulse_n; i++) {
+        if (pulse_is_low(i, pulse_k)) {
+            out_press(chan_cfg[pulse_batch[i]].pin);
+        }
+    }
+    out_write();
+#endif
+#if PULSE_MODE == PULSE_MODE_DELAY
+    for (i = pulse_code ? more : 1u; i; i--) {
+        delay_ms(pulse_code ? GESTURE_MS : PULSE_SLOT_MS);
+    }
+#endif
+    return 1;
+}
+
+/**
+ * @brief Move pulse_mark up to @p t, crediting the counts since at the current rate.
+ * - A @p t before pulse_mark (an earlier deadline of the same dispatch) leaves it.
+ */
+static void pulse_rebase(sched_time_t t) {
+    if (SCHED_BEFORE(pulse_mark, t)) {
+        pulse_base += fx_mul_q14(t - pulse_mark, pulse_rate_inv);
+        pulse_mark  = t;
+    }
+}
+
+/**
+ * @brief Timer time of nominal time @p n at the current rate; pulse_mark if @p n is not after
+ *        pulse_base.
+ */
+static sched_time_t pulse_time(uint32_t n) {
+    int32_t d = (int32_t)(n - pulse_base);
+    return pulse_mark + (d > 0 ? fx_mul_q14((uint32_t)d, pulse_rate) : 0u);
+}
+
+#if ESCALATE_USED
+/**
+ * @brief Channel @p c gets a press: its own pattern if the node has been active since the last
+ *        one, @ref ESCALATE_PATTERN otherwise. The next one follows @ref ESCALATE_GAP_MIN later,
+ *        or twice the last gap, up to @ref ESCALATE_MAX_MIN, unless the node shows activity.
+ */
+static void escalate(uint8_t c) {
+    if (!escalate_pressed) {
+        escalate_pressed = 1;
+        escalate_pattern = chan_cfg[c].pattern;
+        escalate_gap     = ESCALATE_GAP_COUNTS;
+    } else {
+        escalate_pattern = ESCALATE_PATTERN;
+        escalate_gap     = escalate_gap > ESCALATE_MAX_COUNTS / 2u ? ESCALATE_MAX_COUNTS
+                                                                    : 2u * escalate_gap;
+    }
+}
+#endif
+
+#if ADAPT_MIN_MIN
+/**
+ * @brief Move the up time estimate a quarter of the way to @p up nominal counts, and set the
+ *        interval to half of it, within @ref ADAPT_MIN_MIN .. @ref PULSE_INTERVAL_MIN.
+ */
+static void adapt_learn(uint32_t up) {
+    if (up > 2u * ADAPT_MAX_COUNTS) {
+        up = 2u * ADAPT_MAX_COUNTS;
+    }
+    if (up > adapt_up) {
+        adapt_up += (up - adapt_up) >> 2;
+    } else {
+        adapt_up -= (adapt_up - up) >> 2;
+    }
+    adapt_check = ~adapt_up;
+    adapt_wait  = adapt_up / 2u;
+    if (adapt_wait < ADAPT_MIN_COUNTS) {
+        adapt_wait = ADAPT_MIN_COUNTS;
+    } else if (adapt_wait > ADAPT_MAX_COUNTS) {
+        adapt_wait = ADAPT_MAX_COUNTS;
+    }
+}
+
+/**
+ * @brief Take the estimate kept over a reset; after a power-up, or if it reads invalid, start
+ *        from the longest interval.
+ */
+static void adapt_init(void) {
+    if (adapt_check != ~adapt_up || adapt_up > 2u * ADAPT_MAX_COUNTS) {
+        adapt_up = 2u * ADAPT_MAX_COUNTS;
+    }
+    adapt_learn(adapt_up);
+}
+
+/**
+ * @brief Learn from the press due at nominal time @p n.
+ * - A node silent for @ref ADAPT_QUIET_MIN had hung: the time from the last press that found it
+ *   hung to its last activity is an up time. Nothing is learnt if it never came back.
+ * - A node still active has been up at least since that press; this only raises the estimate.
+ */
+static void adapt_press(uint32_t n) {
+    if ((int32_t)(n - adapt_active) > (int32_t)ADAPT_QUIET_COUNTS) {
+        if ((int32_t)(adapt_active - adapt_since) > 0) {
+            adapt_learn(adapt_active - adapt_since);
+        }
+        adapt_since = n;
+    } else if (n - adapt_since > adapt_up) {
+        adapt_learn(n - adapt_since);
+    }
+}
+#endif
+
+#if CKPT_MIN
+/**
+ * @brief Checkpoint the time left to every channel's deadline (ckpt.h), rounded up.
+ * @param flash 1 to write it to Info flash as well; not while the supply is low
+ *        (@ref BATT_SAMPLE_MIN), as erasing and programming need 2.2 V
+ */
+static void checkpoint(uint8_t flash) {
+    uint32_t left;
+    uint8_t  c;
+
+    pulse_rebase(sched_now());
+    for (c = 0; c < CHAN_COUNT; c++) {
+        left = chan_due(c) - pulse_base;
+        left = (int32_t)left < 0 ? 0u : (left + (1UL << CKPT_SHIFT) - 1u) >> CKPT_SHIFT;
+        ckpt_set(c, left > 0xFFFFu ? 0xFFFFu : (uint16_t)left);
+    }
+#if BATT_SAMPLE_MIN
+    flash = flash && !batt_low;
+#endif
+    ckpt_save(flash);
+}
+#endif
+
+#if LOG_SEGS
+/**
+ * @brief Log an event at nominal time @p n (log.h); a full batch goes to flash from
+ *        SCHED_EV_LOG, right after the running dispatch.
+ */
+static void log_at(uint8_t type, uint16_t payload, uint32_t n) {
+    if (log_event(type, payload, n)) {
+        sched_at(SCHED_EV_LOG, sched_now());
+    }
+}
+
+/**
+ * @brief Log an event now.
+ */
+static void log_now(uint8_t type, uint16_t payload) {
+    pulse_rebase(sched_now());
+    log_at(type, payload, pulse_base);
+}
+#endif
+
+/**
+ * @brief Start the patterns of the channels that are due, up to @ref PULSE_BATCH at once, then
+ *        arm SCHED_EV_PULSE for the earliest deadline left.
+ * - Slot patterns of any kind share a batch; a gesture only batches with the same gesture, and
+ *   a channel that does not fit the batch starts after it.
+ * - A channel's next deadline is one interval after its last one however late its pattern
+ *   started, so staggering does not shift the schedule.
+ * - Timer modes: TIMER0_A1_ISR takes each TACCR1 match to the next slot; nothing is armed while
+ *   a batch runs, and its end calls this again once its lines are released.
+ * - @ref PULSE_MODE_DELAY: busy-waits through each batch.
+ * - @ref CKPT_MIN: a batch that started is checkpointed to RAM, so a reset does not repeat it.
+ * - Must be called with interrupts disabled; a slot counts from the current timer count.
+ */
+static void pulse_next(void) {
+    uint8_t      c, i;
+    uint16_t     p;
+    uint32_t     n;
+    sched_time_t t;
+
+    for (;;) {
+#if PULSE_MODE != PULSE_MODE_DELAY
+        if (pulse_n) {
+            return;
+        }
+#endif
+        while (pulse_n < PULSE_BATCH_N) {
+            c = chan_first();
+            n = chan_due(c);
+            t = pulse_time(n);
+            p = PULSE_PATTERN_OF(c);
+            for (i = 0; i < pulse_n && pulse_batch[i] != c; i++) {
+            }
+            if (i < pulse_n || SCHED_BEFORE(sched_now(), t)) {
+                break; /* not due, or late by a whole interval: once per batch */
+            }
+            if (pulse_n && p != PULSE_PATTERN_OF(pulse_batch[0])
+                && (p > 0xFFu || PULSE_PATTERN_OF(pulse_batch[0]) > 0xFFu)) {
+                break; /* another gesture */
+            }
+            if ((int32_t)(n - pulse_base) > 0) {
+                pulse_base = n; /* (n, t) is an exact pair: no rounding */
+                pulse_mark = t;
+            }
+#if LOG_SEGS
+            log_at(LOG_PULSE, c, pulse_base);
+#endif
+#if CONSOLE_BAUD
+            pulse_count++;
+#endif
+#if ESCALATE_USED
+            escalate(c);
+#elif ADAPT_MIN_MIN
+            adapt_press(n);
+#endif
+            chan_set_first(n + PULSE_WAIT(c));
+            pulse_batch[pulse_n++] = c;
+        }
+        if (!pulse_n) {
+            sched_at(SCHED_EV_PULSE, pulse_time(chan_due(chan_first())));
+            return;
+        }
+        p          = PULSE_PATTERN_OF(pulse_batch[0]);
+        pulse_code = p > 0xFFu ? gesture_code((uint8_t)(p - GESTURE(0))) : 0;
+        pulse_k    = 0;
+#if PULSE_MODE == PULSE_MODE_DELAY
+        while (pulse_out()) {
+            pulse_k++;
+        }
+        out_write(); /* release */
+        pulse_n = 0;
+#else
+        TACCTL1 = CCIE; /* clears CCIFG, enables the CCR1 interrupt */
+        pulse_out();    /* the first step is LOW */
+#endif
+#if CKPT_MIN
+        checkpoint(0); /* after the first step is armed: it does not delay the pattern */
+#endif
+    }
+}
+
+#if PULSE_MODE != PULSE_MODE_DELAY
+/**
+ * @brief TACCR1 match: the rest of a long step, the next step of the running batch, or its
+ *        end.
+ * - At the end CCR1 goes idle and the channels due, held back while the batch ran, start
+ *   right away.
+ */
+static void pulse_slot(void) {
+    if (pulse_left) {
+        pulse_arm();
+#if PULSE_MODE == PULSE_MODE_OUTMOD
+        pulse_outmod();
+#endif
+        return;
+    }
+    pulse_k++;
+    if (pulse_out()) {
+        return;
+    }
+#if PULSE_MODE == PULSE_MODE_OUTMOD
+    pulse_release(chan_cfg[pulse_batch[0]].pin);
+#else
+    out_write(); /* release */
+#endif
+    TACCTL1 = 0;
+    pulse_n = 0;
+    pulse_next();
+}
+#endif
+
+/**
+ * @brief Re-arm the pending pulses for the current VLO estimate.
+ * - rate = calibration scale * temperature factor now / temperature factor at calibration.
+ * - Counts since the last pulse or rate change are credited at the previous rate; the rest of
+ *   each interval is converted at the new one.
+ */
+static void pulse_retime(void) {
+    uint32_t rate = FX_ONE;
+
+#if VLO_CAL_HOURS
+    rate = vlo_cal_scale;
+#elif CONF_BLOCK
+    rate = conf.vlo_rate;
+#endif
+#if TEMPCOMP_MIN
+    rate = fx_mul_q14(fx_mul_q14(rate, temp_factor), temp_ref_inv);
+#endif
+    if (rate < PULSE_RATE_MIN) {
+        rate = PULSE_RATE_MIN;
+    } else if (rate > 0xFFFFu) {
+        rate = 0xFFFFu;
+    }
+
+    pulse_rebase(sched_now());
+    pulse_rate     = (uint16_t)rate;
+    pulse_rate_inv = fx_recip_q14(pulse_rate);
+#if PULSE_MODE != PULSE_MODE_DELAY
+    /* rounded */
+    pulse_ticks = (uint16_t)((fx_mul_q14(2u * PULSE_SLOT_COUNTS, pulse_rate) + 1u) >> 1);
+#endif
+    pulse_next();
+}
+
+#if (BATT_SAMPLE_MIN || PGOOD_DELAY_S) && !EVENT_ONLY
+/**
+ * @brief Bring the pending pulse forward to @p counts nominal counts after @p now.
+ * - A pulse that is already due sooner stays; the interval after it is unchanged.
+ * - Nothing changes either if the last pulse (or node activity) is less than @p counts ago.
+ */
+static void pulse_within(sched_time_t now, uint32_t counts) {
+    uint32_t done;
+
+    pulse_rebase(now);
+    done = pulse_base - (chan_due(0) - PULSE_WAIT(0));
+    if (done >= counts && done < PULSE_WAIT(0) - counts) {
+        chan_set_first(pulse_base + counts);
+        pulse_next();
+    }
+}
+#endif
+
+#if SENSE_TIMEOUT_MIN || ADAPT_MIN_MIN
+/**
+ * @brief The node showed activity at @p now: the pulse deadline starts over from there, and the
+ *        next press is the channel's own pattern again. @ref ADAPT_MIN_MIN: only noted.
+ * - The sense pin is polled again after @ref SENSE_CHECK_COUNTS; edges until then only latch.
+ */
+static void node_alive(sched_time_t now) {
+#if ESCALATE_USED
+    escalate_pressed = 0;
+#endif
+    pulse_rebase(now);
+#if ADAPT_MIN_MIN
+    adapt_active = pulse_base;
+#else
+    chan_set_first(pulse_base + PULSE_WAIT_COUNTS);
+    pulse_next();
+#endif
+    sched_at(SCHED_EV_SENSE, now + fx_mul_q14(SENSE_CHECK_COUNTS, pulse_rate));
+}
+#endif
+
+#if TEMPCOMP_MIN
+/**
+ * @brief Sample the die temperature and look up the VLO factor for it.
+ */
+static void temp_update(void) {
+    temp_factor = tempcomp_factor(tempcomp_sample());
+}
+#endif
+
+#if BATT_SAMPLE_MIN
+/**
+ * @brief Sample the supply (batt.h). @ref LOG_SEGS: log it going low or recovering, and note
+ *        whether the flash can still be written.
+ * @return 1 on the sample that finds the supply recovered
+ */
+static uint8_t batt_check(void) {
+    uint16_t code = batt_sample();
+#if LOG_SEGS
+    uint8_t  was  = batt_low;
+#endif
+    uint8_t  up   = batt_update(code);
+
+#if LOG_SEGS
+    log_vcc_ok = code >= BATT_CODE(2200u);
+    if (batt_low != was) {
+        log_now(batt_low ? LOG_BATT_LOW : LOG_BATT_OK, code);
+        if (batt_low) {
+            sched_at(SCHED_EV_LOG, sched_now()); /* written while the supply still allows */
+        }
+    }
+#endif
+    return up;
+}
+#endif
+
+#if VLO_CAL_HOURS
+/**
+ * @brief Re-measure the VLO; the temperature now becomes the compensation reference.
+ * - Call pulse_retime() afterwards to apply it.
+ */
+static void vlo_recalibrate(void) {
+#if TEMPCOMP_MIN
+    temp_update();
+#endif
+    if (vlo_cal_run()) {
+#if TEMPCOMP_MIN
+        temp_ref_inv = fx_recip_q14(temp_factor);
+#endif
+#if LOG_SEGS
+        log_now(LOG_CAL, vlo_cal_scale >> 12);
+        log_now(LOG_CAL_LO, vlo_cal_scale & 0x0FFFu);
+    } else {
+        log_now(LOG_CAL, 0);
+#endif
+    }
+}
+#endif
+
+#if EVENT_ONLY
+/**
+ * @brief A wake-up event: pulse @p counts nominal counts from now.
+ * - Ignored while a pulse is pending or the holdoff after one runs.
+ * - The VLO is re-measured first: the timer only runs while awake, so the last calibration may
+ *   be any age.
+ */
+static void event_start(uint32_t counts) {
+    if (event_busy) {
+        return;
+    }
+    event_busy = 1;
+    pulse_rebase(sched_now());
+    chan_set_first(pulse_base + counts);
+#if VLO_CAL_HOURS
+    vlo_recalibrate();
+#endif
+    pulse_retime();
+}
+#endif
+
+#if SENSE_USED
+/**
+ * @brief The sense pin's first edge after a quiet spell, from its port ISR.
+ * - Masks the pin interrupt and restarts the pulse deadline (@ref ADAPT_MIN_MIN: notes the
+ *   activity); SCHED_EV_SENSE polls from here on. @ref LOG_SEGS: logs the wake.
+ * - @ref EVENT_ONLY: the edge asks for a pulse @ref EVENT_DELAY_S from now; the interrupt stays
+ *   masked until the holdoff after it is over.
+ */
+static void sense_wake(void) {
+    sense_disarm();
+#if EVENT_ONLY
+    event_start(EVENT_DELAY_COUNTS);
+#else
+    node_alive(sched_now());
+#endif
+#if LOG_SEGS
+    log_now(LOG_SENSE, 0);
+#endif
+#if CONSOLE_BAUD
+    sense_count++;
+#endif
+}
+#endif
+
+#if CONF_INTERVAL
+/**
+ * @brief The interval of the channels at @ref PULSE_INTERVAL_MIN changed from @p old nominal
+ *        counts to conf.interval: their next pulse follows their last one by the new interval,
+ *        or is due now (pulse_base) if that is past.
+ */
+static void pulse_move(uint32_t old) {
+    uint32_t due;
+    uint8_t  c;
+
+    for (c = 0; c < CHAN_COUNT; c++) {
+        if (chan_cfg[c].wait == TB_INTERVAL_COUNTS) {
+            due = chan_due(c) - old + conf.interval;
+            chan_resume(c, (int32_t)(due - pulse_base) > 0 ? due : pulse_base);
+        }
+    }
+}
+#endif
+
+#if CONSOLE_BAUD
+/**
+ * @brief Nominal counts @p n in whole seconds.
+ */
+static uint32_t console_s(uint32_t n) {
+    return n / ACLK_VLO_HZ * TB_DIV + n % ACLK_VLO_HZ * TB_DIV / ACLK_VLO_HZ;
+}
+
+#if !CONSOLE_SOFT
+/**
+ * @brief A key on the console: the session stays open @ref CONSOLE_IDLE_S from now.
+ */
+static void console_seen(void) {
+    sched_at(SCHED_EV_CONSOLE, sched_now() + fx_mul_q14(CONSOLE_IDLE_COUNTS, pulse_rate));
+}
+#endif
+
+#if CONF_INTERVAL
+/**
+ * @brief Set the interval of the channels at @ref PULSE_INTERVAL_MIN to @p min minutes.
+ * - Their next pulse follows their last one by the new interval, or comes now if that is past.
+ * - Must be called with interrupts disabled, while no batch runs.
+ */
+static void pulse_set_interval(uint16_t min) {
+    uint32_t old = conf.interval;
+
+    pulse_rebase(sched_now());
+    conf.interval     = conf_interval(min);
+    conf.interval_min = min;
+    pulse_move(old);
+    pulse_next();
+}
+#endif
+
+/**
+ * @brief Set the pattern slot to @p ms, @p counts nominal counts; takes effect from the next
+ *        pattern. Must be called with interrupts disabled, while no batch runs.
+ */
+static void pulse_set_width(uint16_t ms, uint16_t counts) {
+    conf.slot_ms     = ms;
+    conf.slot_counts = counts;
+    pulse_retime();
+}
+
+/**
+ * @brief Console "s": nominal time since boot (wraps) and to the next pulse, presses so far, the
+ *        settings, then what the build watches: sense pin wakes, the VLO estimate, the supply.
+ */
+static void console_status(void) {
+    uint32_t now;
+#if !EVENT_ONLY
+    uint32_t next;
+#endif
+
+    __disable_interrupt();
+    pulse_rebase(sched_now());
+    now = pulse_base;
+#if !EVENT_ONLY
+    next = chan_due(chan_first()) - pulse_base;
+#endif
+    __enable_interrupt();
+    console_line("time", console_s(now), "s");
+#if !EVENT_ONLY
+    console_line("next", (int32_t)next > 0 ? console_s(next) : 0u, "s");
+#endif
+    console_line("pulses", pulse_count, "");
+#if CONF_INTERVAL
+    console_line("interval", conf.interval_min, "min");
+#endif
+    console_line("width", conf.slot_ms, "ms");
+#if SENSE_USED
+    console_line("wakes", sense_count, "");
+#endif
+    console_line("vlo", fx_mul_q14(ACLK_VLO_HZ, pulse_rate), "Hz");
+#if BATT_SAMPLE_MIN
+    console_puts(batt_low ? "supply low\r\n" : "supply ok\r\n");
+#endif
+}
+
+/**
+ * @brief Console command (console.h), from main():
+ * - "s": the status (console_status()).
+ * - "i <min>": interval of the channels at @ref PULSE_INTERVAL_MIN, 1 up to that; "i" alone
+ *   shows it. Only where the interval is fixed: not with @ref SENSE_TIMEOUT_MIN,
+ *   @ref ADAPT_MIN_MIN or @ref EVENT_ONLY.
+ * - "w <ms>": pattern slot (@ref PULSE_MS; gestures keep @ref GESTURE_MS), 2 to 0x3FFF
+ *   nominal counts; with @ref EVENT_ONLY, 8 slots within @ref EVENT_HOLDOFF_S.
+ * - "l": write the event log batch to flash, then dump the log as Intel HEX for
+ *   tools/log_decode.py (@ref LOG_SEGS).
+ * - Anything else lists the commands.
+ * - Settings hold until the next reset, and are refused ("busy") while a batch runs.
+ */
+void console_on_command(char cmd, uint32_t arg, uint8_t has_arg) {
+    uint32_t counts;
+    uint8_t  busy;
+
+    switch (cmd) {
+    case 's':
+        console_status();
+        break;
+#if CONF_INTERVAL
+    case 'i':
+        if (has_arg && !conf_interval(arg)) {
+            console_puts("? 1..");
+            console_putu(PULSE_INTERVAL_MIN);
+            console_puts(" min\r\n");
+            break;
+        }
+        if (has_arg) {
+            __disable_interrupt();
+            busy = (TACCTL1 & CCIE) != 0;
+            if (!busy) {
+                pulse_set_interval((uint16_t)arg);
+            }
+            __enable_interrupt();
+            if (busy) {
+                console_puts("busy\r\n");
+                break;
+            }
+        }
+        console_line("interval", conf.interval_min, "min");
+        break;
+#endif
+    case 'w':
+        if (has_arg) {
+            counts = conf_slot(arg);
+            if (!counts) {
+                console_puts("? out of range\r\n");
+                break;
+            }
+            __disable_interrupt();
+            busy = (TACCTL1 & CCIE) != 0;
+            if (!busy) {
+                pulse_set_width((uint16_t)arg, (uint16_t)counts);
+            }
+            __enable_interrupt();
+            if (busy) {
+                console_puts("busy\r\n");
+                break;
+            }
+        }
+        console_line("width", conf.slot_ms, "ms");
+        break;
+#if LOG_SEGS
+    case 'l':
+        __disable_interrupt();
+#if BATT_SAMPLE_MIN
+        if (!(TACCTL1 & CCIE) && log_vcc_ok) {
+#else
+        if (!(TACCTL1 & CCIE)) {
+#endif
+            log_flush(); /* otherwise the batch stays in RAM, for SCHED_EV_LOG */
+        }
+        __enable_interrupt();
+        console_hex(log_addr(), LOG_SEGS * FLASH_MAIN_SEG_SIZE);
+        break;
+#endif
+    default:
+        console_puts("s status\r\n");
+#if CONF_INTERVAL
+        console_puts("i [min] interval\r\n");
+#endif
+        console_puts("w [ms] width\r\n");
+#if LOG_SEGS
+        console_puts("l log dump\r\n");
+#endif
+        break;
+    }
+}
+#endif
 
 /**
  * @brief Generate a debug burst on DBG_PIN_BIT.
@@ -128,17 +1171,236 @@ static void do_dbg_burst(void) {
 
 /* ---------------- Main ---------------- */
 int main(void) {
+#if CKPT_MIN
+    uint8_t c;
+#endif
+#if LOG_SEGS
+    uint16_t boot = IFG1 & (WDTIFG | PORIFG | RSTIFG | NMIIFG); /* why the MCU started */
+#endif
+
     WDTCTL = WDTPW | WDTHOLD; /* stop watchdog */
 
     clocks_init();
     gpio_init_lowpower();
-    timerA_init_30s();
+    out_init();
+#if SENSE_USED
+    sense_init();
+#endif
+#if PGOOD_DELAY_S
+    pgood_init();
+#endif
+#if CONSOLE_BAUD
+    console_init();
+#endif
+#if CONF_BLOCK
+    conf_load();
+#if VLO_CAL_HOURS
+    vlo_cal_scale = conf.vlo_rate; /* kept if the calibration fails */
+#endif
+#endif
+#if STRAP_P2_BITS
+    conf_strap(); /* over the site block */
+#endif
+    sched_init();
+    chan_init();
+#if SENSE_TIMEOUT_MIN
+    chan_set_first(PULSE_WAIT_COUNTS); /* the timeout replaces the interval */
+#elif ADAPT_MIN_MIN
+    adapt_init();
+    chan_set_first(adapt_wait);
+#elif (CONF_BLOCK || STRAP_P2_BITS) && CONF_INTERVAL
+    pulse_move(TB_INTERVAL_COUNTS); /* the site's interval from the first pulses on */
+#endif
+#if CKPT_MIN
+    if (ckpt_load()) { /* the schedule resumes; the time the MCU was off is lost */
+        for (c = 0; c < CHAN_COUNT; c++) {
+            chan_resume(c, (uint32_t)ckpt_left(c) << CKPT_SHIFT);
+        }
+#if LOG_SEGS
+        boot |= 0x100u;
+#endif
+    }
+    sched_at(SCHED_EV_CKPT, TB_SECONDS(CKPT_MIN * 60UL));
+#endif
+#if LOG_SEGS
+    IFG1 &= ~(WDTIFG | PORIFG | RSTIFG | NMIIFG); /* the next reset sets its own */
+    log_init();
+    log_at(LOG_BOOT, boot, 0);
+#endif
+#if VLO_CAL_HOURS
+    vlo_recalibrate();
+#if !EVENT_ONLY
+    sched_at(SCHED_EV_VLO_CAL, TB_SECONDS(VLO_CAL_HOURS * 3600UL));
+#endif
+#elif TEMPCOMP_MIN
+    temp_update();
+#endif
+#if TEMPCOMP_MIN
+    sched_at(SCHED_EV_TEMPCOMP, TB_SECONDS(TEMPCOMP_MIN * 60UL));
+#endif
+#if BATT_SAMPLE_MIN
+    batt_check(); /* sets the reference level */
+    sched_at(SCHED_EV_BATT, BATT_SAMPLE_COUNTS);
+#endif
+#if PGOOD_DELAY_S && PGOOD_POLL_S
+    sched_at(SCHED_EV_PGOOD, PGOOD_POLL_COUNTS);
+#endif
     do_dbg_burst();
+#if !EVENT_ONLY
+    pulse_retime(); /* first pulses one interval (or timeout) plus their phase after boot, or
+                       as the checkpoint left them */
+#endif
 
     __enable_interrupt();
 
     for (;;) {
+#if CONSOLE_BAUD
+        console_run(); /* the lines typed since the last wake */
+#endif
+        /* the ISR that changed the mode (or queued a key) returned here; pick it with
+           interrupts off */
+        __disable_interrupt();
+#if CONSOLE_BAUD
+        if (console_pending()) {
+            __enable_interrupt();
+            continue;
+        }
+        if (console_active()) {
+            __bis_SR_register(LPM0_bits | GIE); /* SMCLK clocks USCI_A0 */
+            continue;
+        }
+#endif
+#if EVENT_ONLY
+        __bis_SR_register((event_busy ? LPM3_bits : LPM4_bits) | GIE);
+#else
         __bis_SR_register(LPM3_bits | GIE); /* sleep until ISR */
+#endif
+    }
+}
+
+/* ---------------- Scheduler events ---------------- */
+
+/**
+ * @brief Scheduler event handler (see sched.h).
+ * - SCHED_EV_PULSE: pulse the channels that are due and re-arm for the next deadline (each
+ *   channel's is one interval, timeout or escalation gap after its last). @ref EVENT_ONLY:
+ *   also start the holdoff.
+ * - SCHED_EV_HOLDOFF: the holdoff is over; the sense pin interrupt is enabled again and the
+ *   CPU goes back to LPM4.
+ * - SCHED_EV_VLO_CAL: re-measure the VLO (not while TACCR1 times a pulse) and re-time the
+ *   pending pulse.
+ * - SCHED_EV_TEMPCOMP: sample the temperature and re-time the pending pulse.
+ * - SCHED_EV_BATT: sample the supply; on a recovery bring the pulse forward to
+ *   @ref BATT_DELAY_MIN minutes from now.
+ * - SCHED_EV_PGOOD: compare the node's rail; when it came back bring the pulse forward to
+ *   @ref PGOOD_DELAY_S seconds from now.
+ * - SCHED_EV_SENSE: an edge latched since the last poll restarts the deadline (or is noted,
+ *   @ref ADAPT_MIN_MIN); otherwise the node has gone quiet and the pin interrupt is enabled
+ *   again.
+ * - SCHED_EV_CKPT: checkpoint the schedule to RAM, every @ref CKPT_FLASH_MIN to flash as well
+ *   (not while TACCR1 times a pulse: an erase holds the CPU for ~15 ms).
+ * - SCHED_EV_LOG: write the event log batch to flash, likewise not during a pulse, nor while
+ *   the last supply sample read below 2.2 V.
+ * - SCHED_EV_CONSOLE: no key for @ref CONSOLE_IDLE_S; close the console session (USCI_A0).
+ */
+void sched_on_event(sched_event_t ev, sched_time_t due) {
+    switch (ev) {
+    case SCHED_EV_PULSE:
+#if EVENT_ONLY
+        sched_at(SCHED_EV_HOLDOFF, due + fx_mul_q14(EVENT_HOLDOFF_COUNTS, pulse_rate));
+#endif
+        pulse_next();
+        break;
+#if EVENT_ONLY
+    case SCHED_EV_HOLDOFF:
+        event_busy = 0;
+        sched_cancel(SCHED_EV_PULSE); /* armed an interval on; the next event sets the pulse */
+#if EVENT_ONLY & EVENT_SENSE
+        sense_disarm(); /* drops edges latched during the holdoff */
+        sense_arm();
+#endif
+        break;
+#endif
+#if VLO_CAL_HOURS && !EVENT_ONLY
+    case SCHED_EV_VLO_CAL:
+        if (TACCTL1 & CCIE) {
+            sched_at(SCHED_EV_VLO_CAL, due + TB_SECONDS(1)); /* pulse running, retry */
+            break;
+        }
+        sched_at(SCHED_EV_VLO_CAL, due + TB_SECONDS(VLO_CAL_HOURS * 3600UL));
+        vlo_recalibrate();
+        pulse_retime();
+        break;
+#endif
+#if TEMPCOMP_MIN
+    case SCHED_EV_TEMPCOMP:
+        sched_at(SCHED_EV_TEMPCOMP, due + TB_SECONDS(TEMPCOMP_MIN * 60UL));
+        temp_update();
+        pulse_retime();
+        break;
+#endif
+#if BATT_SAMPLE_MIN
+    case SCHED_EV_BATT:
+        /* at the VLO rate, so the recovery latency holds on a slow VLO too */
+        sched_at(SCHED_EV_BATT, due + fx_mul_q14(BATT_SAMPLE_COUNTS, pulse_rate));
+        if (batt_check()) {
+            pulse_within(due, BATT_DELAY_COUNTS);
+        }
+        break;
+#endif
+#if PGOOD_DELAY_S && PGOOD_POLL_S
+    case SCHED_EV_PGOOD:
+        sched_at(SCHED_EV_PGOOD, due + fx_mul_q14(PGOOD_POLL_COUNTS, pulse_rate));
+        if (pgood_poll()) {
+            pulse_within(due, PGOOD_DELAY_COUNTS);
+        }
+        break;
+#endif
+#if SENSE_TIMEOUT_MIN || ADAPT_MIN_MIN
+    case SCHED_EV_SENSE:
+        if (sense_seen()) {
+            node_alive(due);
+        } else {
+            sense_arm();
+        }
+        break;
+#endif
+#if CKPT_MIN
+    case SCHED_EV_CKPT:
+        if (TACCTL1 & CCIE) {
+            sched_at(SCHED_EV_CKPT, due + TB_SECONDS(1)); /* pulse running, retry */
+            break;
+        }
+        sched_at(SCHED_EV_CKPT, due + TB_SECONDS(CKPT_MIN * 60UL));
+        checkpoint(--ckpt_wait == 0);
+        if (!ckpt_wait) {
+            ckpt_wait = CKPT_FLASH_N;
+        }
+        break;
+#endif
+#if LOG_SEGS
+    case SCHED_EV_LOG:
+        if (TACCTL1 & CCIE) {
+            sched_at(SCHED_EV_LOG, due + TB_SECONDS(1)); /* pulse running, retry */
+            break;
+        }
+#if BATT_SAMPLE_MIN
+        if (!log_vcc_ok) {
+            break; /* the batch stays in RAM; the next event asks again */
+        }
+#endif
+        log_flush();
+        break;
+#endif
+#if CONSOLE_BAUD
+    case SCHED_EV_CONSOLE:
+#if !CONSOLE_SOFT
+        console_close(); /* TIMER0_A0_ISR returns to main() for LPM3 */
+#endif
+        break;
+#endif
+    default:
+        break;
     }
 }
 
@@ -146,16 +1408,119 @@ int main(void) {
 
 /**
  * @brief Timer_A0 ISR.
- * - Runs every ~30 s.
- * - Accumulates elapsed seconds until @ref PULSE_INTERVAL_MIN is reached.
- * - Calls do_pulse() when the interval expires.
+ * - TACCR0 match: a scheduler deadline (or tick, without @ref SCHED_TICKLESS).
+ * - Dispatches due events to sched_on_event().
+ * - @ref EVENT_ONLY: returns to main() once the holdoff is over, to sleep in LPM4.
+ * - @ref CONSOLE_BAUD: returns to main() once the console session closed, to leave LPM0.
  */
 #pragma vector = TIMER0_A0_VECTOR
 __interrupt void TIMER0_A0_ISR(void) {
-    static unsigned long elapsed_sec  = 0;
-    elapsed_sec                      += BASE_PERIOD_S;
-    if (elapsed_sec >= (unsigned long)(PULSE_INTERVAL_MIN * 60UL)) {
-        elapsed_sec = 0;
-        do_pulse();
+#if CONSOLE_BAUD && !CONSOLE_SOFT
+    uint8_t open = console_active();
+#endif
+
+    sched_tick();
+#if EVENT_ONLY
+    if (!event_busy) {
+        __bic_SR_register_on_exit(LPM4_bits); /* holdoff over: main() sleeps in LPM4 */
+    }
+#endif
+#if CONSOLE_BAUD && !CONSOLE_SOFT
+    if (open && !console_active()) {
+        __bic_SR_register_on_exit(LPM4_bits);
+    }
+#endif
+}
+
+/**
+ * @brief Timer_A1 ISR (TACCR1, TACCR2, TAIFG).
+ * - TACCR1 match: the next step of the patterns, or their end; the CPU returns to LPM3 on exit.
+ * - TAIFG: counter rollover, keeps the scheduler's time.
+ */
+#pragma vector = TIMER0_A1_VECTOR
+__interrupt void TIMER0_A1_ISR(void) {
+    switch (TAIV) { /* reading TAIV clears the highest pending flag */
+#if PULSE_MODE != PULSE_MODE_DELAY
+    case TA0IV_TACCR1:
+        pulse_slot();
+        break;
+#endif
+    case TA0IV_TAIFG:
+        sched_rollover();
+        break;
+    default:
+        break;
+    }
+}
+
+#if SENSE_P1_BIT || CONSOLE_BAUD
+/**
+ * @brief Port 1 ISR: the sense pin (sense_wake()) and the console's RX pin (console_edge()).
+ * - Returns to main() for a new sleep mode: LPM3 during the holdoff (@ref EVENT_ONLY), LPM0
+ *   for a console session; or to parse a character.
+ */
+#pragma vector = PORT1_VECTOR
+__interrupt void PORT1_ISR(void) {
+#if CONSOLE_BAUD
+    if ((P1IFG & P1IE & CONSOLE_RX_BIT) && console_edge()) {
+#if !CONSOLE_SOFT
+        console_seen();
+#endif
+        __bic_SR_register_on_exit(LPM4_bits);
+    }
+#endif
+#if SENSE_P1_BIT
+    if (P1IFG & P1IE & SENSE_P1_BIT) {
+        sense_wake();
+#if EVENT_ONLY
+        __bic_SR_register_on_exit(LPM4_bits);
+#endif
     }
+#endif
+}
+#endif
+
+#if SENSE_P2_BIT
+/**
+ * @brief Port 2 ISR: the sense pin (sense_wake()).
+ * - @ref EVENT_ONLY: returns to main(), which sleeps in LPM3 until the holdoff is over.
+ */
+#pragma vector = PORT2_VECTOR
+__interrupt void PORT2_ISR(void) {
+    sense_wake();
+#if EVENT_ONLY
+    __bic_SR_register_on_exit(LPM4_bits);
+#endif
+}
+#endif
+
+#if CONSOLE_BAUD && !CONSOLE_SOFT
+/**
+ * @brief USCI_A0 receive ISR: a console character (UCA0RXIFG clears as it is read); main()
+ *        parses it.
+ */
+#pragma vector = USCIAB0RX_VECTOR
+__interrupt void USCIAB0RX_ISR(void) {
+    console_rx();
+    console_seen();
+    __bic_SR_register_on_exit(LPM4_bits);
+}
+#endif
+
+#if PGOOD_DELAY_S && !PGOOD_POLL_S
+/**
+ * @brief Comparator_A+ ISR: the node's rail came back (CAIFG clears on acceptance).
+ * - Brings the pulse forward to @ref PGOOD_DELAY_S seconds from now.
+ * - @ref EVENT_ONLY: asks for a pulse @ref PGOOD_DELAY_S from now instead, unless one is
+ *   pending or in its holdoff.
+ */
+#pragma vector = COMPARATORA_VECTOR
+__interrupt void COMPARATORA_ISR(void) {
+#if EVENT_ONLY
+    event_start(PGOOD_DELAY_COUNTS);
+    __bic_SR_register_on_exit(LPM4_bits); /* main() picks LPM3 or LPM4 */
+#else
+    pulse_within(sched_now(), PGOOD_DELAY_COUNTS);
+#endif
 }
+#endif
@@ -0,0 +1,161 @@
+/**
+ * @file out.c
+ * @brief Button line outputs (see out.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "out.h"
+
+/* ---------------- Defines ---------------- */
+#if PULSE_OUT == PULSE_OUT_GPIO
+#define OUT_BYTES        (1u) /* P1 pin mask */
+#else
+#define OUT_BYTES        ((unsigned int)EXP_COUNT) /* one byte per chip, line n in bit n % 8 */
+#endif
+
+#if PULSE_OUT == PULSE_OUT_595
+#if (EXP_SER_BIT | EXP_SCK_BIT | EXP_RCK_BIT) & ~0x3F
+#error "EXP_SER_BIT, EXP_SCK_BIT and EXP_RCK_BIT must be P2.0..P2.5"
+#endif
+#if !EXP_SER_BIT || !EXP_SCK_BIT || !EXP_RCK_BIT || (EXP_SER_BIT & (EXP_SCK_BIT | EXP_RCK_BIT)) \
+        || (EXP_SCK_BIT & EXP_RCK_BIT)
+#error "EXP_SER_BIT, EXP_SCK_BIT and EXP_RCK_BIT must be three different pins"
+#endif
+#endif
+
+#if PULSE_OUT == PULSE_OUT_PCF8574
+#if defined(__MSP430__) && !defined(__MSP430_HAS_USCI__)
+#error "PULSE_OUT_PCF8574 needs USCI_B0 (MSP430G2553); use PULSE_OUT_595 on the G2452"
+#endif
+#if EXP_I2C_ADDR < 0x08 || EXP_I2C_ADDR + EXP_COUNT > 0x78
+#error "EXP_I2C_ADDR .. EXP_I2C_ADDR + EXP_COUNT - 1 must be 7-bit I2C addresses"
+#endif
+#if EXP_I2C_KHZ < 10u || EXP_I2C_KHZ > 100u
+#error "EXP_I2C_KHZ must be 10..100 (PCF8574 standard mode, SMCLK 1 MHz)"
+#endif
+#define OUT_I2C_PINS     (BIT6 | BIT7)                          /* UCB0SCL, UCB0SDA */
+#define OUT_I2C_DIV      ((uint8_t)(1000u / EXP_I2C_KHZ))       /* SMCLK 1 MHz */
+/* Polls of a bus flag before a transfer is given up (~20 bytes at 10 kHz): a missing pull-up
+ * or a stuck line must not hang the ISR. Leaves n at 0 if @p ok never came */
+#define OUT_I2C_POLLS    (2000u)
+#define OUT_I2C_WAIT(ok)                                                                          \
+    for (n = OUT_I2C_POLLS; n && !(ok); n--) {                                                    \
+    }
+#endif
+
+/* ---------------- Variables ---------------- */
+static uint8_t out_low[OUT_BYTES];  /* lines to hold LOW at the next write */
+static uint8_t out_sent[OUT_BYTES]; /* ... and at the last one */
+
+/* ---------------- Functions ---------------- */
+
+#if PULSE_OUT == PULSE_OUT_595
+/**
+ * @brief Shift the chain out, last chip and Q7 first, and latch it onto the outputs at once.
+ * - The pins rest LOW afterwards.
+ */
+static void out_shift(void) {
+    unsigned int i = OUT_BYTES;
+    uint8_t      m;
+
+    while (i-- > 0) {
+        for (m = 0x80; m; m >>= 1) {
+            if (out_low[i] & m) {
+                P2OUT |= EXP_SER_BIT;
+            } else {
+                P2OUT &= ~EXP_SER_BIT;
+            }
+            P2OUT |= EXP_SCK_BIT; /* shifts on the rising edge */
+            P2OUT &= ~EXP_SCK_BIT;
+        }
+    }
+    P2OUT |= EXP_RCK_BIT; /* all outputs change together */
+    P2OUT &= ~(EXP_RCK_BIT | EXP_SER_BIT);
+}
+#endif
+
+#if PULSE_OUT == PULSE_OUT_PCF8574
+/**
+ * @brief Send the chips whose lines changed in one transaction, a repeated START for each.
+ * - A chip that does not acknowledge ends the transaction; it and the chips after it keep
+ *   their last sent state and go out with the next write.
+ * - The USCI runs only for the transfer and SCL/SDA are handed back as inputs afterwards.
+ */
+static void out_i2c(void) {
+    unsigned int i, n;
+
+    P1SEL    |= OUT_I2C_PINS;
+    P1SEL2   |= OUT_I2C_PINS;
+    UCB0CTL1 &= ~UCSWRST;
+    for (i = 0; i < OUT_BYTES; i++) {
+        if (out_low[i] == out_sent[i]) {
+            continue;
+        }
+        UCB0I2CSA  = EXP_I2C_ADDR + i;
+        UCB0CTL1  |= UCTR | UCTXSTT; /* (repeated) START and address */
+        OUT_I2C_WAIT(IFG2 & UCB0TXIFG);
+        UCB0TXBUF = (uint8_t)~out_low[i]; /* a 0 pulls the line LOW */
+        OUT_I2C_WAIT(!(UCB0CTL1 & UCTXSTT)); /* address acknowledged, or not */
+        if (!n || (UCB0STAT & UCNACKIFG)) {
+            break;
+        }
+        OUT_I2C_WAIT(IFG2 & UCB0TXIFG); /* data byte under way */
+        out_sent[i] = out_low[i];
+    }
+    UCB0CTL1 |= UCTXSTP;
+    OUT_I2C_WAIT(!(UCB0CTL1 & UCTXSTP));
+    UCB0CTL1 |= UCSWRST; /* clears the flags; SMCLK no longer clocks the USCI */
+    P1SEL    &= ~OUT_I2C_PINS;
+    P1SEL2   &= ~OUT_I2C_PINS;
+}
+#endif
+
+void out_init(void) {
+    unsigned int i;
+
+#if PULSE_OUT == PULSE_OUT_PCF8574
+    UCB0CTL1 = UCSWRST;
+    UCB0CTL0 = UCMST | UCMODE_3 | UCSYNC; /* I2C master */
+    UCB0CTL1 = UCSSEL_2 | UCSWRST;        /* SMCLK, held in reset until a write */
+    UCB0BR0  = OUT_I2C_DIV;
+    UCB0BR1  = 0;
+#endif
+    for (i = 0; i < OUT_BYTES; i++) {
+        out_sent[i] = 0xFF; /* unknown: every chip is written */
+    }
+    out_write();
+}
+
+void out_press(uint8_t pin) {
+#if PULSE_OUT == PULSE_OUT_GPIO
+    out_low[0] |= pin;
+#else
+    out_low[pin >> 3] |= (uint8_t)(1u << (pin & 7u));
+#endif
+}
+
+void out_write(void) {
+    unsigned int i;
+    uint8_t      same = 1;
+
+    for (i = 0; i < OUT_BYTES; i++) {
+        same &= out_low[i] == out_sent[i];
+    }
+    if (!same) {
+#if PULSE_OUT == PULSE_OUT_GPIO
+        P1OUT &= ~out_low[0]; /* ensure LOW when driven */
+        P1DIR  = (uint8_t)((P1DIR & ~CHAN_PINS) | out_low[0]);
+        out_sent[0] = out_low[0];
+#elif PULSE_OUT == PULSE_OUT_595
+        out_shift();
+        for (i = 0; i < OUT_BYTES; i++) {
+            out_sent[i] = out_low[i];
+        }
+#else
+        out_i2c();
+#endif
+    }
+    for (i = 0; i < OUT_BYTES; i++) {
+        out_low[i] = 0;
+    }
+}
@@ -0,0 +1,67 @@
+/**
+ * @file out.h
+ * @brief Button line outputs: a P1 pin per node, or expander chips for racks of nodes.
+ *
+ * main.c collects the lines to hold LOW for a pattern slot with out_press() and applies them
+ * with one out_write(); every other line is released. What a line is depends on
+ * @ref PULSE_OUT:
+ * - @ref PULSE_OUT_GPIO: the P1 pin bit of the channel, LOW as an output and released as an
+ *   input (Hi-Z); a write is one P1DIR store.
+ * - @ref PULSE_OUT_595: line n is output Q(n % 8) of the n / 8-th 74HC595 of a daisy chain. A
+ *   write shifts the whole chain out on @ref EXP_SER_BIT / @ref EXP_SCK_BIT and moves it to the
+ *   outputs with one @ref EXP_RCK_BIT edge. A set output pulls the node's line LOW through an
+ *   N-MOSFET (or a TPIC6B595's open drain).
+ * - @ref PULSE_OUT_PCF8574: line n is P(n % 8) of the PCF8574 at @ref EXP_I2C_ADDR + n / 8 on
+ *   USCI_B0 in I2C mode. The quasi-bidirectional port pulls the node's line LOW directly and
+ *   releases it to the weak pull-up, which is also its power-up state. A write is one bus
+ *   transaction carrying the chips whose lines change; a chip that does not answer is sent
+ *   again with the next write.
+ *
+ * Writes that change nothing cost no transfer. In between, the expanders hold their outputs
+ * with every clock stopped: the 595 pins rest LOW, the USCI is held in reset and SCL/SDA are
+ * inputs idling HIGH on the bus pull-ups, so only the chips' own standby current remains.
+ */
+
+#ifndef OUT_H
+#define OUT_H
+
+#include <stdint.h>
+
+#include "chan.h"
+#include "config.h"
+#include "hal.h"
+
+#if PULSE_OUT == PULSE_OUT_GPIO
+#define OUT_P1_BITS (CHAN_PINS) /* P1 pins of the outputs */
+#define OUT_P2_BITS (0)         /* P2 pins of the outputs */
+#elif PULSE_OUT == PULSE_OUT_595
+#define OUT_P1_BITS (0)
+#define OUT_P2_BITS (EXP_SER_BIT | EXP_SCK_BIT | EXP_RCK_BIT)
+#elif PULSE_OUT == PULSE_OUT_PCF8574
+#define OUT_P1_BITS (BIT6 | BIT7) /* UCB0SCL, UCB0SDA */
+#define OUT_P2_BITS (0)
+#else
+#error "Unknown PULSE_OUT"
+#endif
+
+/**
+ * @brief Release every line; the expanders are written even if they kept their state over a
+ *        reset of the MCU.
+ * - Call after gpio_init_lowpower(), with SMCLK running.
+ */
+void out_init(void);
+
+/**
+ * @brief Hold line @p pin LOW from the next out_write() on.
+ * @param pin P1 pin bit, or expander line (chan.h)
+ */
+void out_press(uint8_t pin);
+
+/**
+ * @brief Drive the lines given to out_press() since the last write LOW, release the others.
+ * - One P1DIR store or one serial transfer; nothing if no line changes. Busy-waits on the
+ *   transfer (about 0.2 ms per chip), so call it from an ISR or with SMCLK running.
+ */
+void out_write(void);
+
+#endif /* OUT_H */
@@ -0,0 +1,61 @@
+/**
+ * @file pgood.c
+ * @brief Power-good detection (see pgood.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "pgood.h"
+
+#include "hal.h"
+
+#if PGOOD_DELAY_S
+
+/* ---------------- Defines ---------------- */
+#if PGOOD_CA < 1 || PGOOD_CA > 7
+#error "PGOOD_CA must be 1..7 (CA0 cannot reach the - terminal)"
+#endif
+
+#define PGOOD_PIN_BIT  (1u << PGOOD_CA)
+/* Rail on the - terminal (P2CA3..1 = x selects CAx) through the output filter */
+#define PGOOD_CTL2     ((uint8_t)((PGOOD_CA << 3) | CAF))
+/* Reference on the + terminal; CAOUT falls as the rail comes up */
+#define PGOOD_CTL1     ((uint8_t)(PGOOD_REF | CAIES))
+
+/* Comparator and reference ladder settling after CAON, with the filter (~2 us), at 1 MHz */
+#define PGOOD_SETTLE_CYCLES (20u)
+
+/* ---------------- Variables ---------------- */
+#if PGOOD_POLL_S
+static uint8_t pgood_up = 1; /* rail present at the last poll; assumed up before the first */
+#endif
+
+/* ---------------- Functions ---------------- */
+
+void pgood_init(void) {
+    CAPD   |= PGOOD_PIN_BIT; /* analog input: no digital buffer current at mid-rail */
+    CACTL2  = PGOOD_CTL2;
+#if PGOOD_POLL_S
+    CACTL1  = PGOOD_CTL1;
+#else
+    CACTL1  = PGOOD_CTL1 | CAON;
+    __delay_cycles(PGOOD_SETTLE_CYCLES);
+    CACTL1 &= ~CAIFG; /* switching on may have latched an edge */
+    CACTL1 |= CAIE;
+#endif
+}
+
+uint8_t pgood_poll(void) {
+#if PGOOD_POLL_S
+    uint8_t was = pgood_up;
+
+    CACTL1 = PGOOD_CTL1 | CAON;
+    __delay_cycles(PGOOD_SETTLE_CYCLES);
+    pgood_up = !(CACTL2 & CAOUT);
+    CACTL1   = PGOOD_CTL1; /* comparator and reference off */
+    return pgood_up && !was;
+#else
+    return 0;
+#endif
+}
+
+#endif /* PGOOD_DELAY_S */
@@ -0,0 +1,37 @@
+/**
+ * @file pgood.h
+ * @brief Power-good detection on the node's rail with Comparator_A+.
+ *
+ * The node's regulated rail (or its battery) reaches comparator input CAx (P1.x,
+ * @ref PGOOD_CA) through a divider that keeps it below the MSP430's VCC. It is compared
+ * against an internal reference (@ref PGOOD_REF) on the other terminal; CAOUT is high while the
+ * rail is below it, i.e. absent.
+ *
+ * The comparator and its reference ladder draw ~90 uA together at 3 V, so they are powered
+ * either
+ * - briefly every @ref PGOOD_POLL_S seconds from a scheduler event (pgood_poll()), or
+ * - all the time with @ref PGOOD_POLL_S = 0, waking the CPU from LPM3 on the CAOUT edge of
+ *   the rail coming back (COMPARATORA_VECTOR; the flag clears on acceptance).
+ */
+
+#ifndef PGOOD_H
+#define PGOOD_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+/**
+ * @brief Route the rail to the comparator and disable the pin's digital input buffer.
+ * - @ref PGOOD_POLL_S = 0: switch the comparator on and enable its interrupt.
+ * - Otherwise the comparator stays off; the first pgood_poll() sees the state at boot.
+ */
+void pgood_init(void);
+
+/**
+ * @brief Power the comparator up, compare once, power it down (@ref PGOOD_POLL_S).
+ * @return 1 if the rail came back since the previous call, 0 otherwise
+ */
+uint8_t pgood_poll(void);
+
+#endif /* PGOOD_H */
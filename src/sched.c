@@ -0,0 +1,191 @@
+/**
+ * @file sched.c
+ * @brief Absolute-time event scheduler on Timer_A (see sched.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "sched.h"
+
+#include "hal.h"
+#include "timebase.h"
+
+/* ---------------- Variables ---------------- */
+static sched_time_t  sched_due[SCHED_EV_COUNT]; /* deadline per slot */
+static unsigned int  sched_armed;               /* bit n set: slot n holds a deadline */
+static unsigned char sched_busy;                /* dispatching; reprogram once at the end */
+static sched_time_t  sched_susp;                /* time at sched_suspend() */
+#if SCHED_TICKLESS
+static uint16_t      sched_hi;                  /* TAIFG rollovers: upper half of the time */
+#else
+static sched_time_t  sched_base;                /* time of the last TACCR0 match */
+#endif
+
+/* ---------------- Functions ---------------- */
+
+/**
+ * @brief Read TAR while it runs.
+ * - TAR is clocked from ACLK, asynchronous to MCLK: read until two samples agree.
+ */
+static uint16_t timer_read(void) {
+    uint16_t a;
+    uint16_t b;
+    do {
+        a = TAR;
+        b = TAR;
+    } while (a != b);
+    return a;
+}
+
+/**
+ * @brief Program TACCR0 for the earliest armed deadline (@ref SCHED_TICKLESS only).
+ * - Deadline in this 65536 count period: TACCR0 compare on its lower half.
+ * - Deadline in a later period: no compare, the next rollover reprograms.
+ * - Deadline already passed: set CCIFG so TIMER0_A0_ISR runs right away.
+ */
+static void sched_program(void) {
+#if SCHED_TICKLESS
+    sched_time_t  now;
+    sched_time_t  t     = 0;
+    int32_t       delta = 0;
+    unsigned char found = 0;
+    unsigned char ev;
+
+    if (sched_busy) {
+        return;
+    }
+    now = sched_now();
+    for (ev = 0; ev < SCHED_EV_COUNT; ev++) {
+        if ((sched_armed & (1u << ev)) && (!found || (int32_t)(sched_due[ev] - now) < delta)) {
+            t     = sched_due[ev];
+            delta = (int32_t)(t - now);
+            found = 1;
+        }
+    }
+
+    if (!found) {
+        TACCTL0 = 0;
+    } else if (delta <= 0) {
+        TACCTL0 = CCIE | CCIFG;
+    } else if ((uint16_t)(t >> 16) != (uint16_t)(now >> 16)) {
+        TACCTL0 = 0; /* full periods left: wait for the rollover */
+    } else {
+        TACCR0  = (uint16_t)t; /* final partial period */
+        TACCTL0 = CCIE;
+        if (!SCHED_BEFORE(sched_now(), t)) {
+            TACCTL0 |= CCIFG; /* TAR passed it while arming */
+        }
+    }
+#endif
+}
+
+void sched_init(void) {
+    sched_armed = 0;
+#if SCHED_TICKLESS
+    sched_hi = 0;
+    TACTL    = TASSEL_1 | TB_ID_BITS | TACLR | TAIE; /* ACLK, /TB_ID_DIV, clear, rollover IRQ */
+    TACCTL0  = 0;                                    /* armed by sched_at() */
+    TACTL   |= MC_2;                                 /* continuous mode */
+#else
+    sched_base  = 0;
+    TACTL       = TASSEL_1 | TB_ID_BITS | TACLR; /* ACLK, /TB_ID_DIV, clear */
+    TACCR0      = TB_CCR0;                       /* one tick */
+    TACCTL0     = CCIE;                          /* enable CCR0 interrupt */
+    TACTL      |= MC_1;                          /* up mode */
+#endif
+}
+
+sched_time_t sched_now(void) {
+    uint16_t r = timer_read();
+#if SCHED_TICKLESS
+    uint16_t hi = sched_hi;
+    if ((TACTL & TAIFG) && r < 0x8000u) {
+        hi++; /* TAR wrapped, rollover not serviced yet */
+    }
+    return ((sched_time_t)hi << 16) | r;
+#else
+    sched_time_t base = sched_base;
+    if ((TACCTL0 & CCIFG) && (r == TB_CCR0 || r < TB_CCR0 / 2u)) {
+        base += TB_PERIOD_COUNTS; /* tick matched, not serviced yet */
+    }
+    return base + (r == TB_CCR0 ? 0u : r + 1u);
+#endif
+}
+
+void sched_at(sched_event_t ev, sched_time_t t) {
+    sched_due[ev]  = t;
+    sched_armed   |= 1u << ev;
+    sched_program();
+}
+
+void sched_cancel(sched_event_t ev) {
+    sched_armed &= ~(1u << ev);
+    sched_program();
+}
+
+uint16_t sched_compare_in(uint16_t counts) {
+#if SCHED_TICKLESS
+    return (uint16_t)(timer_read() + counts); /* wraps with TAR */
+#else
+    uint32_t c = (uint32_t)timer_read() + counts;
+    return (uint16_t)(c >= TB_PERIOD_COUNTS ? c - TB_PERIOD_COUNTS : c);
+#endif
+}
+
+void sched_suspend(void) {
+    sched_susp  = sched_now();
+    TACTL      &= ~MC_3; /* halt */
+}
+
+void sched_resume(uint16_t lost) {
+    sched_time_t t = sched_susp + lost;
+#if SCHED_TICKLESS
+    TACTL     = TASSEL_1 | TB_ID_BITS | TAIE; /* ACLK again, halted, TAIFG clear */
+    TAR       = (uint16_t)t;
+    sched_hi  = (uint16_t)(t >> 16);
+    TACTL    |= MC_2;
+    sched_program();
+#else
+    uint32_t     o    = t - sched_base; /* counts since the last TACCR0 match */
+    unsigned int flag = 0;
+    if (o >= TB_PERIOD_COUNTS) {
+        o    -= TB_PERIOD_COUNTS; /* a match was skipped: leave it pending */
+        flag  = CCIFG;
+    }
+    TACTL    = TASSEL_1 | TB_ID_BITS; /* ACLK again, halted */
+    TAR      = (o == 0) ? TB_CCR0 : (uint16_t)(o - 1u);
+    TACCR0   = TB_CCR0;
+    TACCTL0  = CCIE | flag;
+    TACTL   |= MC_1;
+#endif
+}
+
+void sched_tick(void) {
+    sched_time_t  now;
+    unsigned char ev;
+    unsigned char fired;
+
+#if !SCHED_TICKLESS
+    sched_base += TB_PERIOD_COUNTS;
+#endif
+    sched_busy = 1;
+    do {
+        fired = 0;
+        now   = sched_now();
+        for (ev = 0; ev < SCHED_EV_COUNT; ev++) {
+            if ((sched_armed & (1u << ev)) && !SCHED_BEFORE(now, sched_due[ev])) {
+                sched_armed &= ~(1u << ev);
+                sched_on_event((sched_event_t)ev, sched_due[ev]);
+                fired = 1;
+            }
+        }
+    } while (fired);
+    sched_busy = 0;
+    sched_program();
+}
+
+void sched_rollover(void) {
+#if SCHED_TICKLESS
+    sched_hi++;
+    sched_program();
+#endif
+}
@@ -0,0 +1,121 @@
+/**
+ * @file sched.h
+ * @brief Absolute-time event scheduler on Timer_A.
+ *
+ * Time is the number of Timer_A counts since boot (TB_DIV VLO cycles each, see timebase.h),
+ * kept as a wrapping 32-bit value; compare times with @ref SCHED_BEFORE only. Each event slot
+ * holds at most one deadline; sched_on_event() is called from the timer ISR once it is reached.
+ *
+ * - @ref SCHED_TICKLESS = 1: Timer_A runs in continuous mode. A deadline splits into full 65536
+ *   count periods (the TAIFG rollovers, which also keep the upper half of the time) and a final
+ *   partial TACCR0 compare, so an event costs the rollovers on the way plus one wake.
+ * - @ref SCHED_TICKLESS = 0: Timer_A runs in up mode on the solver tick; events fire on the first
+ *   tick at or after their deadline.
+ *
+ * All functions must run with interrupts disabled: from an ISR or before __enable_interrupt().
+ */
+
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+/** Timer_A counts since boot; wraps after 2^32 counts. */
+typedef uint32_t sched_time_t;
+
+/** True if time a is before time b (valid while they are less than 2^31 counts apart). */
+#define SCHED_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+/** Event slots. */
+typedef enum {
+    SCHED_EV_PULSE = 0, /* earliest channel deadline, or the liveness deadline
+                           (SENSE_TIMEOUT_MIN), or the pulse after a wake-up event (EVENT_ONLY) */
+#if VLO_CAL_HOURS && !EVENT_ONLY
+    SCHED_EV_VLO_CAL, /* periodic VLO calibration */
+#endif
+#if TEMPCOMP_MIN
+    SCHED_EV_TEMPCOMP, /* periodic temperature sample */
+#endif
+#if BATT_SAMPLE_MIN
+    SCHED_EV_BATT, /* periodic supply voltage sample */
+#endif
+#if PGOOD_DELAY_S && PGOOD_POLL_S
+    SCHED_EV_PGOOD, /* periodic power-good compare */
+#endif
+#if SENSE_TIMEOUT_MIN || ADAPT_MIN_MIN
+    SCHED_EV_SENSE, /* poll the sense pin while the node is active */
+#endif
+#if CKPT_MIN
+    SCHED_EV_CKPT, /* periodic schedule checkpoint */
+#endif
+#if LOG_SEGS
+    SCHED_EV_LOG, /* write the full event log batch to flash */
+#endif
+#if EVENT_ONLY
+    SCHED_EV_HOLDOFF, /* end of the holdoff after an event pulse */
+#endif
+#if CONSOLE_BAUD
+    SCHED_EV_CONSOLE, /* close the console session once idle (USCI_A0) */
+#endif
+    SCHED_EV_COUNT
+} sched_event_t;
+
+/**
+ * @brief Configure and start Timer_A from ACLK; time starts at 0.
+ */
+void sched_init(void);
+
+/**
+ * @brief Current time.
+ */
+sched_time_t sched_now(void);
+
+/**
+ * @brief Arm event @p ev for absolute time @p t, replacing any pending deadline.
+ * - A time that already passed fires on the next timer interrupt.
+ */
+void sched_at(sched_event_t ev, sched_time_t t);
+
+/**
+ * @brief Disarm event @p ev.
+ */
+void sched_cancel(sched_event_t ev);
+
+/**
+ * @brief TACCRx value that matches @p counts timer counts from now.
+ * - @p counts must be shorter than one timer period.
+ */
+uint16_t sched_compare_in(uint16_t counts);
+
+/**
+ * @brief Halt Timer_A so it can be borrowed (e.g. clocked from SMCLK for a measurement).
+ * - TACCR1 must be idle; TACCR2 and the clock source are free to use until sched_resume().
+ */
+void sched_suspend(void);
+
+/**
+ * @brief Give Timer_A back after sched_suspend().
+ * @param lost timer counts that elapsed while it was borrowed; time advances by this much
+ */
+void sched_resume(uint16_t lost);
+
+/**
+ * @brief TIMER0_A0_ISR body: TACCR0 match (deadline or tick).
+ */
+void sched_tick(void);
+
+/**
+ * @brief TIMER0_A1_ISR body for TAIFG: counter rollover (@ref SCHED_TICKLESS only).
+ */
+void sched_rollover(void);
+
+/**
+ * @brief Event handler, implemented by the application.
+ * @param ev  event that is due
+ * @param due deadline it was armed for; reschedule relative to it to avoid drift
+ */
+void sched_on_event(sched_event_t ev, sched_time_t due);
+
+#endif /* SCHED_H */
@@ -0,0 +1,79 @@
+/**
+ * @file sense.c
+ * @brief Liveness input (see sense.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "sense.h"
+
+#include "hal.h"
+
+#if SENSE_USED
+
+/* ---------------- Defines ---------------- */
+#if SENSE_PORT == 1
+#define SENSE_DIR  P1DIR
+#define SENSE_OUT  P1OUT
+#define SENSE_REN  P1REN
+#define SENSE_SEL  P1SEL
+#define SENSE_SEL2 P1SEL2
+#define SENSE_IES  P1IES
+#define SENSE_IFG  P1IFG
+#define SENSE_IE   P1IE
+#elif SENSE_PORT == 2
+#define SENSE_DIR  P2DIR
+#define SENSE_OUT  P2OUT
+#define SENSE_REN  P2REN
+#define SENSE_SEL  P2SEL
+#define SENSE_SEL2 P2SEL2
+#define SENSE_IES  P2IES
+#define SENSE_IFG  P2IFG
+#define SENSE_IE   P2IE
+#else
+#error "SENSE_PORT must be 1 or 2"
+#endif
+
+/* ---------------- Functions ---------------- */
+
+void sense_init(void) {
+    SENSE_IE   &= ~SENSE_PIN_BIT;
+    SENSE_SEL  &= ~SENSE_PIN_BIT;
+    SENSE_SEL2 &= ~SENSE_PIN_BIT;
+    SENSE_DIR  &= ~SENSE_PIN_BIT; /* input */
+#if SENSE_PULL == SENSE_PULL_NONE
+    SENSE_REN  &= ~SENSE_PIN_BIT;
+#else
+#if SENSE_PULL == SENSE_PULL_UP
+    SENSE_OUT  |= SENSE_PIN_BIT;
+#else
+    SENSE_OUT  &= ~SENSE_PIN_BIT;
+#endif
+    SENSE_REN  |= SENSE_PIN_BIT;
+#endif
+#if SENSE_EDGE == SENSE_EDGE_FALLING
+    SENSE_IES  |= SENSE_PIN_BIT;
+#else
+    SENSE_IES  &= ~SENSE_PIN_BIT;
+#endif
+    SENSE_IFG  &= ~SENSE_PIN_BIT; /* writing IES may set the flag */
+    SENSE_IE   |= SENSE_PIN_BIT;
+}
+
+uint8_t sense_seen(void) {
+    if (!(SENSE_IFG & SENSE_PIN_BIT)) {
+        return 0;
+    }
+    SENSE_IFG &= ~SENSE_PIN_BIT;
+    return 1;
+}
+
+void sense_arm(void) {
+    SENSE_IE |= SENSE_PIN_BIT;
+}
+
+void sense_disarm(void) {
+    SENSE_IE  &= ~SENSE_PIN_BIT;
+    SENSE_IFG &= ~SENSE_PIN_BIT;
+}
+
+#endif /* SENSE_USED */
@@ -0,0 +1,51 @@
+/**
+ * @file sense.h
+ * @brief Liveness input: edges on a spare port pin tell that the node is running.
+ *
+ * The pin watches a signal the node keeps toggling while its firmware runs, such as the status
+ * LED or a heartbeat GPIO. The port latches the selected edge in PxIFG whether or not its
+ * interrupt is enabled, so activity is never lost: the application takes the port interrupt
+ * once, masks it, and from then on only polls the flag now and then with sense_seen(). A busy
+ * node costs one short wake per poll instead of one per edge; a silent one costs nothing.
+ *
+ * With @ref EVENT_ONLY & @ref EVENT_SENSE the edge itself asks for a pulse instead; the
+ * interrupt then also wakes the MCU from LPM4.
+ *
+ * Input levels must stay within VCC of the MSP430; put a series resistor in a line from a
+ * higher supply.
+ */
+
+#ifndef SENSE_H
+#define SENSE_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+/** The sense pin is in use: liveness timeout, learned interval or an event-only wake source. */
+#define SENSE_USED (SENSE_TIMEOUT_MIN || ADAPT_MIN_MIN || (EVENT_ONLY & EVENT_SENSE))
+
+/**
+ * @brief Configure the sense pin as an input with @ref SENSE_PULL, clear the edge flag and
+ *        enable its interrupt.
+ * - Call after the port defaults are set up (all pins are outputs there).
+ */
+void sense_init(void);
+
+/**
+ * @brief Take the edge flag.
+ * @return 1 if an edge was latched since the last call or sense_disarm(), 0 otherwise
+ */
+uint8_t sense_seen(void);
+
+/**
+ * @brief Enable the interrupt on the next edge; one already latched fires at once.
+ */
+void sense_arm(void);
+
+/**
+ * @brief Mask the interrupt and clear the edge flag (from the port ISR).
+ */
+void sense_disarm(void);
+
+#endif /* SENSE_H */
@@ -0,0 +1,41 @@
+/**
+ * @file strap.c
+ * @brief Resistor straps (see strap.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "strap.h"
+
+#if STRAP_P2_BITS
+
+/* ---------------- Defines ---------------- */
+/* Wait for a pull to charge the pin and a cable on it: 35 kOhm x 100 pF is 3.5 us; 1 MHz DCO */
+#define STRAP_SETTLE_CYCLES (50u)
+
+/* ---------------- Functions ---------------- */
+
+/**
+ * - The pin reads the pull's level only if nothing is tied to it; a tie reads its own level
+ *   against either pull.
+ */
+uint8_t strap_read(uint8_t bits, uint8_t *high) {
+    uint8_t up, down;
+
+    P2SEL  &= ~bits;
+    P2SEL2 &= ~bits;
+    P2DIR  &= ~bits; /* first: a pin tied to GND is never driven HIGH */
+    P2OUT  |= bits;  /* pull-ups */
+    P2REN  |= bits;
+    __delay_cycles(STRAP_SETTLE_CYCLES);
+    up     = P2IN & bits;
+    P2OUT &= ~bits; /* pull-downs */
+    __delay_cycles(STRAP_SETTLE_CYCLES);
+    down   = P2IN & bits;
+    P2OUT |= down;  /* tied to VCC: HIGH */
+    P2REN &= ~bits;
+    P2DIR |= bits;
+    *high  = down;
+    return (uint8_t)((~up | down) & bits);
+}
+
+#endif /* STRAP_P2_BITS */
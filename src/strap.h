@@ -0,0 +1,37 @@
+/**
+ * @file strap.h
+ * @brief Resistor straps on P2: per-site settings read once at boot.
+ *
+ * A strap pin is tied to GND or to VCC, directly or through up to 4.7 kOhm, or left open: three
+ * values per pin, set with a solder jumper instead of a console or a new image. strap_read()
+ * reads each pin twice as an input, with the internal pull-up (~35 kOhm) and then with the
+ * pull-down. A tie wins over the pull both times; an open pin follows it. The read takes ~0.1 ms
+ * with up to ~90 uA through a tie while the pull works against it.
+ *
+ * Afterwards the pins are outputs again, as gpio_init_lowpower() leaves all spare pins, but each
+ * at the level it is tied to: a pin tied to VCC and driven LOW would draw VCC / R for good. No
+ * current flows through a strap until the next boot, and nothing is clocked for it.
+ */
+
+#ifndef STRAP_H
+#define STRAP_H
+
+#include <stdint.h>
+
+#include "config.h"
+#include "hal.h"
+
+/** P2 pins read as straps. */
+#define STRAP_P2_BITS (STRAP_INTERVAL_BIT | STRAP_WIDTH_BIT)
+
+/**
+ * @brief Read the straps on P2 pins @p bits; the pins end up outputs at their tie level, open
+ *        ones LOW.
+ * - Call once after the port defaults are set up (all pins are outputs there), with interrupts
+ *   disabled and the 1 MHz DCO running.
+ * @param high set to the pins tied to VCC
+ * @return the pins tied to GND or VCC; the others are open
+ */
+uint8_t strap_read(uint8_t bits, uint8_t *high);
+
+#endif /* STRAP_H */
@@ -0,0 +1,72 @@
+/**
+ * @file tempcomp.c
+ * @brief VLO temperature compensation (see tempcomp.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "tempcomp.h"
+
+#include "fixed.h"
+#include "hal.h"
+
+/* ---------------- Defines ---------------- */
+#define TEMPCOMP_TABLE ((const struct tempcomp_table *)HAL_FLASH_PTR(TEMPCOMP_TABLE_ADDR))
+
+/* Factors outside this range are table damage; the VLO spans roughly 4..20 kHz */
+#define TEMPCOMP_FACTOR_MIN (FX_ONE / 4u)
+#define TEMPCOMP_FACTOR_MAX (FX_ONE * 3u)
+
+/* 1.5 V reference settling time (t_REFON, 30 us) at the 1 MHz DCO */
+#define TEMPCOMP_REF_CYCLES (30u)
+
+/* ---------------- Functions ---------------- */
+
+/**
+ * - The sensor needs >= 30 us of sample time: 64 ADC10CLK at ADC10OSC / 4 is ~50 us.
+ */
+uint16_t tempcomp_sample(void) {
+    uint16_t code;
+
+    ADC10CTL1 = INCH_10 | ADC10DIV_3;                  /* temperature sensor, ADC10OSC / 4 */
+    ADC10CTL0 = SREF_1 | ADC10SHT_3 | REFON | ADC10ON; /* 1.5 V reference */
+    __delay_cycles(TEMPCOMP_REF_CYCLES);
+    ADC10CTL0 |= ENC | ADC10SC;
+    while (ADC10CTL1 & ADC10BUSY) {
+    }
+    code = ADC10MEM;
+    ADC10CTL0 &= ~ENC;
+    ADC10CTL0  = 0; /* ADC and reference off */
+    return code;
+}
+
+/**
+ * @brief Table lookup with linear interpolation; no range check on the result.
+ */
+static uint16_t table_lookup(const struct tempcomp_table *t, uint16_t code) {
+    uint16_t off, i, frac;
+    int16_t  d;
+
+    if (code <= t->code_first) {
+        return t->factor[0];
+    }
+    off = code - t->code_first;
+    i   = off >> t->step_log2;
+    if (i >= t->count - 1u) {
+        return t->factor[t->count - 1u];
+    }
+    frac = off & ((1u << t->step_log2) - 1u);
+    d    = (int16_t)(t->factor[i + 1u] - t->factor[i]);
+    return (uint16_t)(t->factor[i] + (int16_t)(((int32_t)d * (int16_t)frac) >> t->step_log2));
+}
+
+uint16_t tempcomp_factor(uint16_t code) {
+    const struct tempcomp_table *t = TEMPCOMP_TABLE;
+    uint16_t                     f;
+
+    if (t->magic != TEMPCOMP_MAGIC || t->count < 2 || t->count > TEMPCOMP_MAX_ENTRIES
+        || t->step_log2 > 8) {
+        return FX_ONE;
+    }
+    f = table_lookup(t, code);
+    return (f < TEMPCOMP_FACTOR_MIN || f > TEMPCOMP_FACTOR_MAX) ? FX_ONE : f;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file tempcomp.h
+ * @brief VLO temperature compensation from the ADC10 internal temperature sensor.
+ *
+ * The VLO moves by roughly half a percent per degree. Between calibrations (vlo_cal.h) the die
+ * temperature is sampled every @ref TEMPCOMP_MIN minutes and looked up in a per-device table of
+ * VLO frequency against temperature, kept in Info flash segment D. The ADC10 and its 1.5 V
+ * reference are on only for the sample (~0.1 ms).
+ *
+ * Without a valid table (blank flash) every factor is 1.0 and nothing is compensated.
+ * tools/tempcomp_table.py builds the table from bench measurements.
+ */
+
+#ifndef TEMPCOMP_H
+#define TEMPCOMP_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+#define TEMPCOMP_TABLE_ADDR   (0x1000u) /* Info segment D */
+#define TEMPCOMP_MAGIC        (0x5443u) /* "TC" */
+#define TEMPCOMP_MAX_ENTRIES  (16)
+
+/**
+ * @brief Compensation table layout in Info flash (38 bytes).
+ * - Entry i is for ADC10 code code_first + (i << step_log2); codes in between are interpolated,
+ *   codes outside the table clamp to the first or last entry.
+ */
+struct tempcomp_table {
+    uint16_t magic;                         /* TEMPCOMP_MAGIC */
+    uint16_t code_first;                    /* ADC10 code of entry 0 (1.5 V reference) */
+    uint8_t  step_log2;                     /* codes between entries = 2^step_log2, 0..8 */
+    uint8_t  count;                         /* entries used, 2..TEMPCOMP_MAX_ENTRIES */
+    uint16_t factor[TEMPCOMP_MAX_ENTRIES];  /* VLO frequency / ACLK_VLO_HZ, Q14 */
+};
+
+/**
+ * @brief Sample the internal temperature sensor once.
+ * - Powers the ADC10 and its reference up, converts in active mode, and powers both down.
+ * @return ADC10 code (INCH_10, 1.5 V reference)
+ */
+uint16_t tempcomp_sample(void);
+
+/**
+ * @brief VLO frequency relative to @ref ACLK_VLO_HZ at a sensor reading.
+ * @param code ADC10 code from tempcomp_sample()
+ * @return Q14 factor; 16384 when no valid table is programmed
+ */
+uint16_t tempcomp_factor(uint16_t code);
+
+#endif /* TEMPCOMP_H */
@@ -0,0 +1,113 @@
+/**
+ * @file timebase.h
+ * @brief Compile-time Timer_A configuration solver.
+ *
+ * Picks the ACLK divider (BCSCTL1 DIVA), the Timer_A input divider (TACTL ID) and TACCR0 so one
+ * @ref PULSE_INTERVAL_MIN interval is delivered with the fewest timer wakes, while the rounding
+ * error of the whole interval stays within @ref TIMEBASE_ERR_PPM.
+ *
+ * - The total divider d = DIVA * ID is one of 1, 2, 4 ... 64.
+ * - For each d the interval is split into TB_WAKES(d) equal periods of at most 65536 counts.
+ * - Among the dividers with the fewest wakes the smallest one wins (finest resolution); if none
+ *   of them meets the budget, the next best wake count is tried. No fit fails the build.
+ *
+ * With the defaults (12 h, 11805 Hz) this gives d = 64 and a ~354 s tick: 122 wakes per pulse.
+ * The tickless scheduler (sched.h) uses the same divider; its wakes are the 65536 count rollovers.
+ */
+
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+/* ---------------- Solver ---------------- */
+#define TB_INTERVAL_S   (PULSE_INTERVAL_MIN * 60ULL) /* 64-bit: folded at compile time only */
+#define TB_VLO_CYCLES   (TB_INTERVAL_S * ACLK_VLO_HZ) /* VLO cycles per interval */
+
+/* Timer counts per interval, wakes per interval and counts per wake for a total divider d */
+#define TB_COUNTS(d)    ((TB_VLO_CYCLES + (d) / 2) / (d))
+#define TB_WAKES(d)     ((TB_COUNTS(d) + 0xFFFFULL) / 0x10000ULL)
+#define TB_PERIOD(d)    ((TB_COUNTS(d) + TB_WAKES(d) / 2) / TB_WAKES(d))
+
+/* Interval rounding error in VLO cycles and ppm */
+#define TB_DELIVERED(d) (TB_PERIOD(d) * TB_WAKES(d) * (d))
+#define TB_ERR_CYCLES(d)                                                                          \
+    (TB_DELIVERED(d) > TB_VLO_CYCLES ? TB_DELIVERED(d) - TB_VLO_CYCLES                            \
+                                     : TB_VLO_CYCLES - TB_DELIVERED(d))
+#define TB_ERR_PPM(d)   (TB_ERR_CYCLES(d) * 1000000ULL / TB_VLO_CYCLES)
+
+/* Pulse width in timer counts (rounded); only bounded when a timer times the pulse */
+#define TB_PULSE(d)     ((PULSE_MS * 1ULL * ACLK_VLO_HZ + 500ULL * (d)) / (1000ULL * (d)))
+#if PULSE_MODE == PULSE_MODE_DELAY
+#define TB_PULSE_OK(d)  (1)
+#else
+#define TB_PULSE_OK(d)  (TB_PULSE(d) >= 2 && TB_PULSE(d) <= TB_PERIOD(d))
+#endif
+
+#define TB_FITS(d)      (TB_ERR_PPM(d) <= TIMEBASE_ERR_PPM && TB_PULSE_OK(d))
+#define TB_BEST(d)      (TB_FITS(d) && TB_WAKES(d) == TB_WAKES(64))
+
+#if PULSE_INTERVAL_MIN < 1
+#error "PULSE_INTERVAL_MIN must be at least 1"
+#endif
+
+#if TB_BEST(1)
+#define TB_DIV (1)
+#elif TB_BEST(2)
+#define TB_DIV (2)
+#elif TB_BEST(4)
+#define TB_DIV (4)
+#elif TB_BEST(8)
+#define TB_DIV (8)
+#elif TB_BEST(16)
+#define TB_DIV (16)
+#elif TB_BEST(32)
+#define TB_DIV (32)
+#elif TB_BEST(64)
+#define TB_DIV (64)
+#elif TB_FITS(32)
+#define TB_DIV (32)
+#elif TB_FITS(16)
+#define TB_DIV (16)
+#elif TB_FITS(8)
+#define TB_DIV (8)
+#elif TB_FITS(4)
+#define TB_DIV (4)
+#elif TB_FITS(2)
+#define TB_DIV (2)
+#elif TB_FITS(1)
+#define TB_DIV (1)
+#else
+#error "No Timer_A configuration meets TIMEBASE_ERR_PPM for PULSE_INTERVAL_MIN/PULSE_MS"
+#endif
+
+/* ---------------- Results ---------------- */
+#define TB_ID_DIV       (TB_DIV > 8 ? 8 : TB_DIV) /* Timer_A input divider */
+#define TB_DIVA_DIV     (TB_DIV / TB_ID_DIV)      /* ACLK divider */
+#define TB_ID_BITS      (TB_ID_DIV == 8 ? ID_3 : TB_ID_DIV == 4 ? ID_2 : TB_ID_DIV == 2 ? ID_1 : ID_0)
+#define TB_DIVA_BITS                                                                              \
+    (TB_DIVA_DIV == 8 ? DIVA_3 : TB_DIVA_DIV == 4 ? DIVA_2 : TB_DIVA_DIV == 2 ? DIVA_1 : DIVA_0)
+
+#define TB_CCR0          ((uint16_t)(TB_PERIOD(TB_DIV) - 1u)) /* TACCR0 for one tick */
+#define TB_PERIOD_COUNTS ((uint32_t)TB_PERIOD(TB_DIV))       /* counts per tick */
+#define TB_PULSE_TICKS   ((uint16_t)TB_PULSE(TB_DIV))         /* pulse width in counts */
+
+/* Durations in nominal timer counts (rounded) */
+#define TB_SECONDS(s)    ((uint32_t)(((s) * 1ULL * ACLK_VLO_HZ + TB_DIV / 2) / TB_DIV))
+#define TB_MS(ms)        ((uint32_t)(((ms) * 1ULL * ACLK_VLO_HZ + 500ULL * TB_DIV) / (1000ULL * TB_DIV)))
+#define TB_MS_Q8(ms)                                                                              \
+    ((uint32_t)(((ms) * 256ULL * ACLK_VLO_HZ + 500ULL * TB_DIV) / (1000ULL * TB_DIV))) /* Q8 */
+
+/* One interval in timer counts: exact to a count when tickless, whole ticks otherwise */
+#if SCHED_TICKLESS
+#define TB_INTERVAL_COUNTS ((uint32_t)TB_COUNTS(TB_DIV))
+#else
+#define TB_INTERVAL_COUNTS ((uint32_t)(TB_WAKES(TB_DIV) * TB_PERIOD(TB_DIV)))
+#endif
+
+_Static_assert(TB_PERIOD(TB_DIV) <= 0x10000ULL, "Timer_A period overflows TACCR0");
+_Static_assert(TB_COUNTS(TB_DIV) < 0x80000000ULL, "PULSE_INTERVAL_MIN too long for the scheduler");
+
+#endif /* TIMEBASE_H */
@@ -0,0 +1,121 @@
+/**
+ * @file vlo_cal.c
+ * @brief Runtime VLO calibration against the factory-calibrated 1 MHz DCO (see vlo_cal.h).
+ */
+
+/* ---------------- Includes ---------------- */
+#include "vlo_cal.h"
+
+#include "fixed.h"
+#include "hal.h"
+#include "sched.h"
+#include "timebase.h"
+
+#if VLO_CAL_HOURS
+
+/* ---------------- Defines ---------------- */
+/* ACLK periods per measurement: the most (up to 64) that keep the window near 8 ms, so a VLO
+ * at a quarter of nominal still fits the 16-bit capture difference */
+#define VLO_CAL_US(k)                                                                             \
+    (((k) * 1ULL * TB_DIVA_DIV * 1000000ULL + ACLK_VLO_HZ / 2u) / ACLK_VLO_HZ)
+#define VLO_CAL_PERIODS                                                                           \
+    (VLO_CAL_US(64) <= 8192u   ? 64                                                               \
+     : VLO_CAL_US(32) <= 8192u ? 32                                                               \
+     : VLO_CAL_US(16) <= 8192u ? 16                                                               \
+     : VLO_CAL_US(8) <= 8192u  ? 8                                                                \
+     : VLO_CAL_US(4) <= 8192u  ? 4                                                                \
+     : VLO_CAL_US(2) <= 8192u  ? 2                                                                \
+                               : 1)
+
+/* DCO cycles across VLO_CAL_PERIODS ACLK periods at ACLK_VLO_HZ, in quarters: whole cycles
+ * would bias every calibration by up to 1/2 cycle (~90 ppm) */
+#define VLO_CAL_NOMINAL_Q2 ((uint16_t)VLO_CAL_US(4u * VLO_CAL_PERIODS))
+
+/* Timer counts that pass while Timer_A is borrowed: the captured periods plus on average half
+ * a period waiting for the first edge, rounded */
+#define VLO_CAL_LOST       ((uint16_t)((2u * VLO_CAL_PERIODS + 1u + TB_ID_DIV) / (2u * TB_ID_DIV)))
+
+/* Accepted scale range, Q14: VLO between 1/4 and 2x nominal (datasheet: 4 kHz to 20 kHz) */
+#define VLO_CAL_SCALE_MIN  (16384ul / 4u)
+#define VLO_CAL_SCALE_MAX  (16384ul * 2u)
+
+/* ---------------- Variables ---------------- */
+uint16_t vlo_cal_scale = FX_ONE;
+uint16_t vlo_cal_runs;
+uint16_t vlo_cal_active_us;
+
+/* ---------------- Functions ---------------- */
+
+/**
+ * @brief Wait for the next ACLK capture on TACCR2.
+ * - Gives up after a full SMCLK rollover (65 ms) without an edge.
+ * @return 1 on capture, 0 on timeout
+ */
+static uint8_t capture_wait(void) {
+    TACTL &= ~TAIFG;
+    while (!(TACCTL2 & CCIFG)) {
+        if (TACTL & TAIFG) {
+            return 0;
+        }
+    }
+    TACCTL2 &= ~CCIFG;
+    return 1;
+}
+
+uint8_t vlo_cal_run(void) {
+    uint16_t      t0;
+    uint16_t      c = 0;
+    uint16_t      m;
+    uint32_t      scale;
+    uint32_t      num;
+    unsigned char k = 0;
+    unsigned char i;
+    uint8_t       ok;
+
+    if (CALBC1_1MHZ == 0xFF) {
+        return 0; /* no DCO reference */
+    }
+
+    sched_suspend();
+    TACTL   = TASSEL_2 | TACLR | MC_2;    /* SMCLK = 1 MHz, continuous */
+    TACCTL2 = CM_1 | CCIS_1 | SCS | CAP; /* capture rising ACLK edges (CCI2B) */
+    ok      = capture_wait();
+    t0      = TACCR2;
+    for (i = 0; ok && i < VLO_CAL_PERIODS; i++) {
+        ok = capture_wait();
+    }
+    if (ok) {
+        c = TACCR2 - t0; /* DCO cycles across VLO_CAL_PERIODS ACLK periods */
+    }
+    vlo_cal_active_us = TAR;
+    TACCTL2           = 0;
+    sched_resume(VLO_CAL_LOST);
+
+    if (!ok || c == 0) {
+        return 0;
+    }
+
+    /* scale = VLO_CAL_NOMINAL_Q2 / 4c, estimated via c = m * 2^(16 - k) with m in [0.5, 1) */
+    m = c;
+    while (!(m & 0x8000u)) {
+        m <<= 1;
+        k++;
+    }
+    scale = ((uint32_t)VLO_CAL_NOMINAL_Q2 * fx_recip_mant(m)) >> (18u - k);
+    if (scale < VLO_CAL_SCALE_MIN || scale > VLO_CAL_SCALE_MAX) {
+        return 0;
+    }
+    /* the estimate is within a few LSB; settle on the rounded quotient (no divide on the G2) */
+    num = ((uint32_t)VLO_CAL_NOMINAL_Q2 << 12) + c / 2u;
+    while (scale * c > num) {
+        scale--;
+    }
+    while ((scale + 1u) * c <= num) {
+        scale++;
+    }
+    vlo_cal_scale = (uint16_t)scale;
+    vlo_cal_runs++;
+    return 1;
+}
+
+#endif /* VLO_CAL_HOURS */
@@ -0,0 +1,38 @@
+/**
+ * @file vlo_cal.h
+ * @brief Runtime VLO calibration against the factory-calibrated 1 MHz DCO.
+ *
+ * Borrows Timer_A, clocks it from SMCLK and captures ACLK edges on CCI2B to count DCO cycles
+ * across a few VLO periods. The result is the VLO speed relative to @ref ACLK_VLO_HZ, used to
+ * turn nominal timer counts (timebase.h) into counts of the VLO actually fitted.
+ *
+ * No hardware multiplier on the G2 parts: the ratio is formed with a Newton-Raphson reciprocal
+ * (fixed.h: 16x16 multiplies and shifts only), never a division.
+ */
+
+#ifndef VLO_CAL_H
+#define VLO_CAL_H
+
+#include <stdint.h>
+
+#include "config.h"
+
+/** VLO frequency / ACLK_VLO_HZ in Q14 (16384 = nominal); 16384 until a calibration succeeds. */
+extern uint16_t vlo_cal_scale;
+
+/** Successful calibrations since boot. */
+extern uint16_t vlo_cal_runs;
+
+/** DCO cycles (µs) the CPU spent active in the last calibration, for the energy budget. */
+extern uint16_t vlo_cal_active_us;
+
+/**
+ * @brief Measure the VLO and update @ref vlo_cal_scale.
+ * - Interrupts must be disabled and TACCR1 idle (see sched_suspend()).
+ * - Keeps the previous scale when the DCO has no calibration data, ACLK stalls or the result
+ *   is outside the VLO's datasheet range.
+ * @return 1 if @ref vlo_cal_scale was updated, 0 otherwise
+ */
+uint8_t vlo_cal_run(void);
+
+#endif /* VLO_CAL_H */
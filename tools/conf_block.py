@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Build the site block (src/conf.h) for Info segment D, for firmware built with CONF_BLOCK.
+
+The block sets the interval of the channels at PULSE_INTERVAL_MIN, the pattern slot (PULSE_MS)
+and the VLO frequency (ACLK_VLO_HZ) of one site; a setting left out keeps the compiled value.
+It names the P1 pins of the build's channels (0 with expanders), and the firmware ignores a
+block made for other pins. Segment D also holds the temperature table, and erasing it clears
+both, so load them together:
+
+    tools/conf_block.py --interval 360 --width 300 -o conf.hex
+    mspdebug rf2500 "erase segment 0x1000" "load tempcomp.hex" "load conf.hex"
+"""
+
+import argparse
+import binascii
+import struct
+import sys
+
+BLOCK_ADDR = 0x1030
+MAGIC = 0x4643
+VERSION = 1
+VLO_HZ_MIN = 4000
+VLO_HZ_MAX = 20000
+PINS = 0x10  # PULSE_PIN_BIT, BIT4: keep in step with src/config.h
+
+
+def build(interval, width, vlo_hz, pins):
+    data = struct.pack("<HBBHHH", MAGIC, VERSION, pins, interval, width, vlo_hz)
+    # CRC-16/CCITT from 0xFFFF over the bytes in memory order, as flash_crc()
+    return data + struct.pack("<H", binascii.crc_hqx(data, 0xFFFF))
+
+
+def intel_hex(data, addr):
+    lines = []
+    for off in range(0, len(data), 16):
+        chunk = data[off:off + 16]
+        rec = bytes([len(chunk), (addr + off) >> 8, (addr + off) & 0xFF, 0]) + chunk
+        lines.append(":%s%02X" % (rec.hex().upper(), -sum(rec) & 0xFF))
+    lines.append(":00000001FF")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("--interval", type=int, default=0,
+                    help="minutes, 1 up to PULSE_INTERVAL_MIN (default: compiled)")
+    ap.add_argument("--width", type=int, default=0,
+                    help="pattern slot in ms (default: compiled)")
+    ap.add_argument("--vlo-hz", type=int, default=0,
+                    help="measured VLO frequency, %d..%d (default: compiled)"
+                    % (VLO_HZ_MIN, VLO_HZ_MAX))
+    ap.add_argument("--pins", type=lambda s: int(s, 0), default=PINS,
+                    help="P1 pin bits of the channels, 0 with expanders (default: 0x%02X)" % PINS)
+    ap.add_argument("-o", "--output", help="Intel HEX file (default: stdout)")
+    args = ap.parse_args()
+
+    if not 0 <= args.interval <= 0xFFFF or not 0 <= args.width <= 60000:
+        sys.exit("interval or width out of range")
+    if args.vlo_hz and not VLO_HZ_MIN <= args.vlo_hz <= VLO_HZ_MAX:
+        sys.exit("VLO frequency must be %d..%d Hz" % (VLO_HZ_MIN, VLO_HZ_MAX))
+    if not 0 <= args.pins <= 0xFF:
+        sys.exit("pins must be P1 bits")
+    text = intel_hex(build(args.interval, args.width, args.vlo_hz, args.pins), BLOCK_ADDR)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,555 @@
+#!/usr/bin/env python3
+"""Count MSP430 CPU cycles of the firmware's interrupt and startup paths.
+
+Runs the built ELF in an instruction-level model of the MSP430 CPU (the G2xx core, not CPUX)
+with the cycle counts of the MSP430x2xx Family User's Guide (SLAU144, tables 3-14 to 3-16).
+Peripheral registers are plain memory: each scenario presets the registers and scheduler state
+that select one path, enters it like the hardware does (interrupt: push PC and SR, 6 cycles;
+RETI: 5 cycles) and counts until it returns.
+
+    tools/cycles.py .pio/build/lpmsp430g2553/firmware.elf --env lpmsp430g2553
+    tools/cycles.py ... --update          # record the result as the new baseline
+    tools/cycles.py ... --function sched_now
+
+Results are compared against tools/cycles_baseline.json; a scenario that takes more cycles than
+its baseline fails the run (exit 1), and so does an env with no baseline at all. The baselines
+are recorded with --update from a msp430-gcc build; until they are, the check is not run in CI.
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "cycles_baseline.json")
+
+SENTINEL = 0x0002  # return address that ends a run (SFR space, never code)
+MAX_CYCLES = 5_000_000
+
+VECTOR_PORT1 = 0xFFE4
+VECTOR_PORT2 = 0xFFE6
+VECTOR_TIMER0_A1 = 0xFFF0
+VECTOR_TIMER0_A0 = 0xFFF2
+VECTOR_COMPARATORA = 0xFFF6
+
+# Peripheral registers (msp430g2553.h)
+TACTL = 0x0160
+TACCTL0 = 0x0162
+TACCTL1 = 0x0164
+TACCTL2 = 0x0166
+TAR = 0x0170
+TACCR0 = 0x0172
+TACCR1 = 0x0174
+TAIV = 0x012E
+ADC10CTL1 = 0x01B2
+
+TASSEL_1 = 0x0100
+MC_2 = 0x0020
+TAIE = 0x0002
+TA0IV_TACCR1 = 0x0002
+TA0IV_TAIFG = 0x000A
+
+C, Z, N, GIE, CPUOFF, V = 0x0001, 0x0002, 0x0004, 0x0008, 0x0010, 0x0100
+
+# Format II cycles per source mode: (RRA/RRC/SWPB/SXT, PUSH, CALL)
+FMT2_CYCLES = {"reg": (1, 3, 4), "ind": (3, 4, 4), "inc": (3, 5, 5), "imm": (None, 4, 5),
+               "idx": (4, 5, 5)}
+# Format I cycles per source mode: (dst register, dst PC, dst memory)
+FMT1_CYCLES = {"reg": (1, 2, 4), "ind": (2, 2, 5), "inc": (2, 3, 5), "imm": (2, 3, 5),
+               "idx": (3, 3, 6)}
+
+
+class Elf:
+    """The loadable image and the symbol table of an ELF32 little-endian file."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            sys.exit(f"{path}: not an ELF32 little-endian file")
+        phoff, shoff = struct.unpack_from("<II", data, 0x1C)
+        phentsize, phnum, shentsize, shnum = struct.unpack_from("<HHHH", data, 0x2A)
+        self.memory = bytearray(0x10000)
+        for i in range(phnum):
+            p_type, p_offset, p_vaddr, _, p_filesz, p_memsz = struct.unpack_from(
+                "<IIIIII", data, phoff + i * phentsize)
+            if p_type != 1 or p_memsz == 0 or p_vaddr >= 0x10000:
+                continue
+            self.memory[p_vaddr:p_vaddr + p_filesz] = data[p_offset:p_offset + p_filesz]
+            self.memory[p_vaddr + p_filesz:p_vaddr + p_memsz] = bytes(p_memsz - p_filesz)
+        self.symbols = {}
+        sections = [struct.unpack_from("<IIIIIIIIII", data, shoff + i * shentsize)
+                    for i in range(shnum)]
+        for sh in sections:
+            if sh[1] != 2:  # SHT_SYMTAB
+                continue
+            strtab = sections[sh[6]]
+            for off in range(sh[4], sh[4] + sh[5], 16):
+                st_name, st_value, st_size, st_info, _, st_shndx = struct.unpack_from(
+                    "<IIIBBH", data, off)
+                if st_shndx == 0 or (st_info & 0xF) not in (0, 1, 2):  # NOTYPE, OBJECT, FUNC
+                    continue
+                end = data.index(b"\0", strtab[4] + st_name)
+                name = data[strtab[4] + st_name:end].decode()
+                if name and name not in self.symbols:
+                    self.symbols[name] = (st_value, st_size)
+
+    def addr(self, name):
+        return self.symbols[name][0]
+
+
+class Cpu:
+    """MSP430 CPU: registers, flags and the cycle counter."""
+
+    def __init__(self, memory):
+        self.mem = memory
+        self.r = [0] * 16
+        self.cycles = 0
+
+    # ---------------- Memory ----------------
+
+    def read(self, addr, byte):
+        addr &= 0xFFFF
+        if byte:
+            return self.mem[addr]
+        addr &= 0xFFFE
+        return self.mem[addr] | self.mem[addr + 1] << 8
+
+    def write(self, addr, value, byte):
+        addr &= 0xFFFF
+        if byte:
+            self.mem[addr] = value & 0xFF
+        else:
+            addr &= 0xFFFE
+            self.mem[addr] = value & 0xFF
+            self.mem[addr + 1] = value >> 8 & 0xFF
+
+    def fetch(self):
+        w = self.read(self.r[0], False)
+        self.r[0] = (self.r[0] + 2) & 0xFFFF
+        return w
+
+    def push(self, value):
+        self.r[1] = (self.r[1] - 2) & 0xFFFF
+        self.write(self.r[1], value, False)
+
+    def pop(self):
+        value = self.read(self.r[1], False)
+        self.r[1] = (self.r[1] + 2) & 0xFFFF
+        return value
+
+    def set_reg(self, n, value, byte):
+        if n == 3:
+            return  # constant generator: writes are discarded
+        self.r[n] = value & (0xFF if byte else 0xFFFF)
+
+    # ---------------- Operands ----------------
+
+    def source(self, reg, mode, byte):
+        """Fetch a source operand; returns (value, mode class for the cycle tables)."""
+        if reg == 3:
+            return (0, 1, 2, 0xFFFF)[mode] & (0xFF if byte else 0xFFFF), "reg"
+        if reg == 2 and mode >= 2:
+            return (4, 8)[mode - 2], "reg"
+        if mode == 0:
+            return self.r[reg] & (0xFF if byte else 0xFFFF), "reg"
+        if mode == 1:
+            base = 0 if reg == 2 else self.r[reg]  # &ADDR or X(Rn) / symbolic (PC of the word)
+            x = self.fetch()
+            return self.read(base + x, byte), "idx"
+        if mode == 2:
+            return self.read(self.r[reg], byte), "ind"
+        if reg == 0:
+            return self.fetch() & (0xFF if byte else 0xFFFF), "imm"
+        value = self.read(self.r[reg], byte)
+        step = 1 if byte and reg != 1 else 2
+        self.r[reg] = (self.r[reg] + step) & 0xFFFF
+        return value, "inc"
+
+    def dest(self, reg, mode):
+        """Resolve a destination; returns an address or None for a register."""
+        if mode == 0:
+            return None
+        base = 0 if reg == 2 else self.r[reg]
+        x = self.fetch()
+        return (base + x) & 0xFFFF
+
+    # ---------------- Flags ----------------
+
+    def flags(self, n, z, c, v):
+        sr = self.r[2] & ~(N | Z | C | V)
+        self.r[2] = sr | (N if n else 0) | (Z if z else 0) | (C if c else 0) | (V if v else 0)
+
+    def nz(self, value, byte):
+        msb = 0x80 if byte else 0x8000
+        return bool(value & msb), (value & (0xFF if byte else 0xFFFF)) == 0
+
+    # ---------------- Execution ----------------
+
+    def step(self):
+        op = self.fetch()
+        if op >> 13 == 1:
+            self.jump(op)
+        elif op >> 10 == 0x04:
+            self.format2(op)
+        elif op >> 12 >= 4:
+            self.format1(op)
+        else:
+            raise RuntimeError(f"illegal instruction {op:04x} at {self.r[0] - 2:04x}")
+
+    def jump(self, op):
+        offset = op & 0x3FF
+        if offset & 0x200:
+            offset -= 0x400
+        sr = self.r[2]
+        n, z, c, v = bool(sr & N), bool(sr & Z), bool(sr & C), bool(sr & V)
+        taken = (not z, z, not c, c, n, n == v, n != v, True)[op >> 10 & 7]
+        if taken:
+            self.r[0] = (self.r[0] + 2 * offset) & 0xFFFF
+        self.cycles += 2
+
+    def format2(self, op):
+        code = op >> 7 & 7
+        byte = bool(op & 0x40)
+        mode = op >> 4 & 3
+        reg = op & 0xF
+        if code == 6:  # RETI
+            self.r[2] = self.pop()
+            self.r[0] = self.pop()
+            self.cycles += 5
+            return
+        if code == 7:
+            raise RuntimeError(f"illegal instruction {op:04x} at {self.r[0] - 2:04x}")
+
+        # operand location, for the read-modify-write forms
+        addr = None
+        if reg == 3 or (reg == 2 and mode >= 2) or (reg == 0 and mode == 3):
+            value, cls = self.source(reg, mode, byte)
+        elif mode == 0:
+            value, cls = self.r[reg] & (0xFF if byte else 0xFFFF), "reg"
+        elif mode == 1:
+            base = 0 if reg == 2 else self.r[reg]
+            addr = (base + self.fetch()) & 0xFFFF
+            value, cls = self.read(addr, byte), "idx"
+        else:
+            addr = self.r[reg]
+            value, cls = self.read(addr, byte), ("ind" if mode == 2 else "inc")
+            if mode == 3:
+                self.r[reg] = (self.r[reg] + (1 if byte and reg != 1 else 2)) & 0xFFFF
+
+        if code == 4:  # PUSH
+            self.push(value)
+            self.cycles += FMT2_CYCLES[cls][1]
+            return
+        if code == 5:  # CALL
+            self.push(self.r[0])
+            self.r[0] = value
+            self.cycles += FMT2_CYCLES[cls][2]
+            return
+
+        msb = 0x80 if byte else 0x8000
+        if code == 0:  # RRC
+            result = (value >> 1) | (msb if self.r[2] & C else 0)
+            self.flags(*self.nz(result, byte), value & 1, False)
+        elif code == 1:  # SWPB
+            result = (value >> 8 | value << 8) & 0xFFFF
+        elif code == 2:  # RRA
+            result = (value >> 1) | (value & msb)
+            self.flags(*self.nz(result, byte), value & 1, False)
+        else:  # SXT
+            result = (value & 0xFF) | (0xFF00 if value & 0x80 else 0)
+            n, z = self.nz(result, False)
+            self.flags(n, z, not z, False)
+        if addr is None:
+            self.set_reg(reg, result, byte)
+        else:
+            self.write(addr, result, byte)
+        self.cycles += FMT2_CYCLES[cls][0]
+
+    def format1(self, op):
+        code = op >> 12
+        sreg = op >> 8 & 0xF
+        ad = op >> 7 & 1
+        byte = bool(op & 0x40)
+        smode = op >> 4 & 3
+        dreg = op & 0xF
+        mask = 0xFF if byte else 0xFFFF
+        msb = 0x80 if byte else 0x8000
+
+        src, cls = self.source(sreg, smode, byte)
+        addr = self.dest(dreg, ad)
+        if addr is None:
+            dst = self.r[dreg] & mask
+            self.cycles += FMT1_CYCLES[cls][1 if dreg == 0 else 0]
+        else:
+            dst = self.read(addr, byte) if code != 4 else 0
+            self.cycles += FMT1_CYCLES[cls][2]
+
+        result = None
+        carry = 1 if self.r[2] & C else 0
+        if code == 4:  # MOV
+            result = src
+        elif code in (5, 6, 7, 8, 9):  # ADD, ADDC, SUBC, SUB, CMP
+            if code >= 7:
+                src = ~src & mask
+            cin = (0, carry, carry, 1, 1)[code - 5]
+            total = dst + src + cin
+            value = total & mask
+            n, z = self.nz(value, byte)
+            v = bool(~(dst ^ src) & (dst ^ value) & msb)
+            self.flags(n, z, total > mask, v)
+            if code != 9:
+                result = value
+        elif code == 0xA:  # DADD
+            total, c = 0, carry
+            for shift in range(0, 8 if byte else 16, 4):
+                d = (src >> shift & 0xF) + (dst >> shift & 0xF) + c
+                c = 1 if d > 9 else 0
+                total |= ((d - 10) if c else d) << shift
+            n, z = self.nz(total, byte)
+            self.flags(n, z, c, False)
+            result = total
+        elif code in (0xB, 0xF):  # BIT, AND
+            value = src & dst
+            n, z = self.nz(value, byte)
+            self.flags(n, z, not z, False)
+            if code == 0xF:
+                result = value
+        elif code == 0xC:  # BIC
+            result = dst & ~src & mask
+        elif code == 0xD:  # BIS
+            result = dst | src
+        else:  # XOR
+            value = src ^ dst
+            n, z = self.nz(value, byte)
+            self.flags(n, z, not z, bool(src & dst & msb))
+            result = value
+
+        if result is None:
+            return
+        if addr is None:
+            if dreg == 2:
+                self.r[2] = result & 0xFFFF  # flags from the result do not apply
+            else:
+                self.set_reg(dreg, result, byte)
+        else:
+            self.write(addr, result, byte)
+
+    # ---------------- Runs ----------------
+
+    def run(self, stop=None):
+        """Execute until the sentinel return, @p stop or sleep; returns the reason."""
+        while self.cycles < MAX_CYCLES:
+            if self.r[0] == SENTINEL:
+                return "return"
+            if stop is not None and self.r[0] == stop:
+                return "stop"
+            if self.r[2] & CPUOFF:
+                return "sleep"
+            self.step()
+        raise RuntimeError(f"no return after {MAX_CYCLES} cycles (PC {self.r[0]:04x}); "
+                           "a polling loop waiting for hardware?")
+
+    def interrupt(self, vector):
+        """Take the interrupt through @p vector; counts accept (6) and RETI (5)."""
+        self.push(SENTINEL)
+        self.push(self.r[2])
+        self.r[2] = 0
+        self.r[0] = self.read(vector, False)
+        self.cycles += 6
+        return self.run()
+
+    def call(self, entry, stop=None):
+        """Call @p entry as a function (the CALL itself is not counted)."""
+        self.push(SENTINEL)
+        self.r[0] = entry
+        return self.run(stop)
+
+
+# ---------------- Scenarios ----------------
+
+def stack_top(elf):
+    for name in ("__stack", "_estack", "__StackTop"):
+        if name in elf.symbols:
+            return elf.addr(name)
+    return 0x0400  # top of the G2553 RAM
+
+
+def setup(elf, tar=0x1000):
+    """Fresh CPU with the image loaded and the timer running from ACLK, no flags pending."""
+    cpu = Cpu(bytearray(elf.memory))
+    cpu.r[1] = stack_top(elf)
+    cpu.write(TACTL, TASSEL_1 | MC_2 | TAIE, False)
+    cpu.write(TAR, tar, False)
+    for reg in (TACCTL0, TACCTL1, TACCTL2, TACCR0, TACCR1, TAIV, ADC10CTL1):
+        cpu.write(reg, 0, False)
+    return cpu
+
+
+def arm_pulse(elf, cpu, due, hi=0):
+    """Scheduler state: only the pulse slot armed, due at @p due; time upper half @p hi."""
+    cpu.write(elf.addr("sched_armed"), 1, False)
+    cpu.write(elf.addr("sched_busy"), 0, True)
+    due_addr = elf.addr("sched_due")
+    cpu.write(due_addr, due & 0xFFFF, False)
+    cpu.write(due_addr + 2, due >> 16, False)
+    if "sched_hi" in elf.symbols:
+        cpu.write(elf.addr("sched_hi"), hi, False)
+
+
+def sc_isr_overhead(elf):
+    """TIMER0_A1_ISR with no source pending: entry, TAIV dispatch, exit."""
+    cpu = setup(elf)
+    cpu.interrupt(VECTOR_TIMER0_A1)
+    return cpu.cycles
+
+
+def sc_rollover(elf):
+    """TAIFG rollover, deadline in a later period: time kept, nothing armed."""
+    cpu = setup(elf, tar=0)
+    arm_pulse(elf, cpu, 0x00050000, hi=1)
+    cpu.write(TAIV, TA0IV_TAIFG, False)
+    cpu.interrupt(VECTOR_TIMER0_A1)
+    return cpu.cycles
+
+
+def sc_rollover_arm(elf):
+    """TAIFG rollover into the deadline's period: TACCR0 programmed."""
+    cpu = setup(elf, tar=0)
+    arm_pulse(elf, cpu, 0x00028000, hi=1)
+    cpu.write(TAIV, TA0IV_TAIFG, False)
+    cpu.interrupt(VECTOR_TIMER0_A1)
+    return cpu.cycles
+
+
+def sc_tick_idle(elf):
+    """TIMER0_A0_ISR with nothing due (every tick without SCHED_TICKLESS)."""
+    cpu = setup(elf)
+    arm_pulse(elf, cpu, 0x40000000)
+    cpu.interrupt(VECTOR_TIMER0_A0)
+    return cpu.cycles
+
+
+def sc_pulse(elf):
+    """TIMER0_A0_ISR with the pulse due: re-arm one interval on and start the pulse."""
+    cpu = setup(elf)
+    arm_pulse(elf, cpu, 0x00000800)
+    cpu.interrupt(VECTOR_TIMER0_A0)
+    return cpu.cycles
+
+
+def sc_pulse_end(elf):
+    """TIMER0_A1_ISR on the TACCR1 match that ends the pulse."""
+    cpu = setup(elf)
+    cpu.write(TAIV, TA0IV_TACCR1, False)
+    cpu.interrupt(VECTOR_TIMER0_A1)
+    return cpu.cycles
+
+
+def sc_sense_edge(elf):
+    """Port ISR on the first sense pin edge: mask it, restart the pulse deadline, arm the poll."""
+    cpu = setup(elf)
+    arm_pulse(elf, cpu, 0x00000800)
+    cpu.interrupt(VECTOR_PORT2 if "PORT2_ISR" in elf.symbols else VECTOR_PORT1)
+    return cpu.cycles
+
+
+def sc_pgood_edge(elf):
+    """Comparator_A+ ISR on the rail coming back: bring the pulse forward to PGOOD_DELAY_S."""
+    cpu = setup(elf)
+    arm_pulse(elf, cpu, 0x00400000)
+    cpu.interrupt(VECTOR_COMPARATORA)
+    return cpu.cycles
+
+
+def sc_startup(elf):
+    """main() from entry to the sched_init() call: watchdog, clocks_init, gpio_init_lowpower."""
+    cpu = setup(elf)
+    cpu.write(0x10FF, 0x86, True)  # CALBC1_1MHZ programmed
+    cpu.write(0x10FE, 0xB5, True)  # CALDCO_1MHZ
+    reason = cpu.call(elf.addr("main"), stop=elf.addr("sched_init"))
+    if reason != "stop":
+        raise RuntimeError("main() did not reach sched_init()")
+    return cpu.cycles
+
+
+SCENARIOS = [
+    ("isr_overhead", sc_isr_overhead, None),
+    ("tick_idle", sc_tick_idle, None),
+    ("rollover", sc_rollover, "sched_hi"),
+    ("rollover_arm", sc_rollover_arm, "sched_hi"),
+    ("pulse", sc_pulse, None),
+    ("pulse_end", sc_pulse_end, None),
+    ("sense_edge", sc_sense_edge, "sense_init"),
+    ("pgood_edge", sc_pgood_edge, "COMPARATORA_ISR"),
+    ("startup", sc_startup, "sched_init"),
+]
+
+
+# ---------------- Main ----------------
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("elf", help="firmware ELF (.pio/build/<env>/firmware.elf)")
+    ap.add_argument("--env", default="lpmsp430g2553", help="baseline key (PlatformIO env)")
+    ap.add_argument("--update", action="store_true", help="store the results as the baseline")
+    ap.add_argument("--function", help="time one function called with no setup instead")
+    args = ap.parse_args()
+
+    elf = Elf(args.elf)
+
+    if args.function:
+        cpu = setup(elf)
+        if args.function not in elf.symbols:
+            sys.exit(f"{args.function}: no such symbol")
+        cpu.call(elf.addr(args.function))
+        print(f"{args.function}: {cpu.cycles} cycles")
+        return 0
+
+    results = {}
+    failed = 0
+    for name, fn, needs in SCENARIOS:
+        if needs and needs not in elf.symbols:
+            continue  # not in this configuration
+        try:
+            results[name] = fn(elf)
+        except (KeyError, RuntimeError) as e:
+            print(f"{name}: {e}", file=sys.stderr)
+            failed += 1
+
+    try:
+        with open(BASELINE) as f:
+            baselines = json.load(f)
+    except FileNotFoundError:
+        baselines = {}
+    base = baselines.get(args.env, {})
+
+    worse = 0
+    print(f"{'path':<14} {'cycles':>8} {'baseline':>9} {'delta':>7}")  # 1 cycle = 1 us
+    for name, cycles in results.items():
+        ref = base.get(name)
+        delta = "" if ref is None else f"{cycles - ref:+d}"
+        note = ""
+        if ref is not None and cycles > ref:
+            worse += 1
+            note = "  REGRESSION"
+        print(f"{name:<14} {cycles:>8} {'-' if ref is None else ref:>9} {delta:>7}{note}")
+
+    if failed:
+        return 1
+    if args.update:
+        baselines[args.env] = results
+        with open(BASELINE, "w") as f:
+            json.dump(baselines, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print(f"baseline for {args.env} updated")
+        return 0
+    if not base:
+        print(f"no baseline for {args.env}; record one with --update", file=sys.stderr)
+        return 1
+    return 1 if worse else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,172 @@
+#!/usr/bin/env python3
+"""Decode the event log (src/log.h, format version 3) from a flash dump.
+
+Input is Intel HEX of the flash, as read back from the target or written by the host build:
+
+    mspdebug rf2500 "hexout 0xC000 0xFFFF flash.hex"
+    tools/log_decode.py flash.hex > log.csv
+
+The log segments are found by their magic word on 512-byte boundaries, so the dump only has to
+cover them. Output is one CSV row per record, oldest first: the boot it belongs to (counted
+from 1 at the first boot record in the log; 0 before it), the seconds since that boot (since
+the first record before it), the type, the raw payload and its meaning. Times are logged in
+units of 8192 nominal VLO cycles; each boot record gives the ACLK_VLO_HZ they are turned into
+seconds with. Records torn by a power
+loss are skipped. A calibration's two records are one row, with the whole Q14 VLO scale as its
+payload (16384 = the firmware's nominal ACLK_VLO_HZ).
+"""
+
+import argparse
+import csv
+import json
+import struct
+import sys
+
+VERSION = 3
+MAGIC = 0x4C00 | VERSION
+SEG_SIZE = 512
+UNIT_CYCLES = 8192  # nominal VLO cycles per time unit
+TIME_UNITS = 32768
+DEFAULT_HZ = 11805  # ACLK_VLO_HZ, for records older than any boot record in the dump
+CAL, CAL_LO = 4, 8
+
+TYPES = {1: "boot", 2: "pulse", 3: "sense", 4: "cal", 5: "batt_low", 6: "batt_ok", 7: "lost",
+         14: "time"}
+RESET_FLAGS = [(0x01, "wdt"), (0x04, "por"), (0x08, "rst"), (0x10, "nmi")]
+
+
+def load_hex(path):
+    """Bytes of an Intel HEX file by address."""
+    mem = {}
+    upper = 0
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith(":"):
+                continue
+            rec = bytes.fromhex(line[1:])
+            n, addr, kind = rec[0], rec[1] << 8 | rec[2], rec[3]
+            if kind == 0:
+                for i in range(n):
+                    mem[upper + addr + i] = rec[4 + i]
+            elif kind == 4:
+                upper = (rec[4] << 8 | rec[5]) << 16
+    return mem
+
+
+def parse_segment(data):
+    """(sequence, record words) of a log segment of this version; None if it is not one."""
+    words = struct.unpack("<%dH" % (len(data) // 2), data)
+    if words[0] != MAGIC:
+        return None
+    return words[1], words[2:]
+
+
+def order(found):
+    """Segments oldest first: the newest has the highest sequence number, wrapping."""
+    if not found:
+        return []
+    newest = found[0][0]
+    for seq, _ in found:
+        if (seq - newest) & 0x8000 == 0:
+            newest = seq
+    return sorted(found, key=lambda s: -((newest - s[0]) & 0xFFFF))
+
+
+def segments(mem):
+    """(sequence, words) of every started log segment, oldest first."""
+    found = []
+    for base in sorted({a & ~(SEG_SIZE - 1) for a in mem}):
+        seg = parse_segment(bytes(mem.get(base + i, 0xFF) for i in range(SEG_SIZE)))
+        if seg:
+            found.append(seg)
+    return order(found)
+
+
+def describe(kind, payload):
+    if kind == 1:
+        flags = [name for bit, name in RESET_FLAGS if payload & bit]
+        if payload & 0x100:
+            flags.append("resumed")
+        return "|".join(flags)
+    if kind == 2:
+        return "channel %d" % payload
+    if kind == CAL:
+        return "%.5f x nominal" % (payload / 16384) if payload else "failed"
+    if kind in (5, 6):
+        return "%d mV" % round(payload * 3000 / 1023)
+    if kind == 7:
+        return "%d dropped" % payload
+    return ""
+
+
+def nominal_hz(segs):
+    """ACLK_VLO_HZ of the oldest boot record of the segments, or DEFAULT_HZ without one."""
+    for _, words in segs:
+        for i in range(0, len(words) - 1, 2):
+            if words[i] >> 12 == 1 and words[i + 1] not in (0, 0xFFFF):
+                return words[i + 1]
+    return DEFAULT_HZ
+
+
+def walk(segs):
+    """(boot, t_s, type, payload) of each record of the segments, oldest first.
+
+    A CAL record and the CAL_LO right after it are one CAL with the 16-bit scale.
+    """
+    boot, units, hz = 0, 0, nominal_hz(segs)
+    cal = None
+    for _, words in segs:
+        for i in range(0, len(words) - 1, 2):
+            head, word = words[i], words[i + 1]
+            if head == 0xFFFF and word == 0xFFFF:
+                break
+            hi, cal = cal, None
+            if word == 0xFFFF:
+                continue  # torn
+            kind, payload = head >> 12, head & 0x0FFF
+            if kind == 14:
+                units += payload * TIME_UNITS
+                continue
+            if kind == 1:
+                boot, units, hz = boot + 1, 0, word or hz
+            else:
+                units += word
+            t = units * UNIT_CYCLES / hz
+            if kind == CAL and payload:
+                cal = payload
+                continue
+            if kind == CAL_LO:
+                if hi is not None:
+                    yield boot, t, CAL, hi << 12 | payload
+                continue
+            yield boot, t, kind, payload
+
+
+def records(segs):
+    """Decoded records of the segments, oldest first."""
+    for boot, t, kind, payload in walk(segs):
+        yield {"boot": boot, "t_s": round(t, 1), "type": TYPES.get(kind, str(kind)),
+               "payload": payload, "value": describe(kind, payload)}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("hex", help="Intel HEX flash dump")
+    ap.add_argument("--json", action="store_true", help="JSON lines instead of CSV")
+    args = ap.parse_args()
+
+    segs = segments(load_hex(args.hex))
+    if not segs:
+        sys.exit("no log segments (magic 0x%04X) in %s" % (MAGIC, args.hex))
+    if args.json:
+        for r in records(segs):
+            print(json.dumps(r))
+        return
+    out = csv.DictWriter(sys.stdout, ["boot", "t_s", "type", "payload", "value"])
+    out.writeheader()
+    out.writerows(records(segs))
+
+
+if __name__ == "__main__":
+    main()
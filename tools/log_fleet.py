@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+"""Summarize the event logs (src/log.h) of a fleet of watchers from their flash dumps.
+
+Input is any number of dump files, or directories searched for them: raw flash images
+(``.bin``, starting on a segment boundary) are read through mmap, touching only the log
+segments; Intel HEX (``.hex``) is read into an address image first, which is then scanned on
+segment boundaries. The dumps are spread over all cores, and each file is one device, named
+after it:
+
+    tools/log_fleet.py dumps/ --csv devices.csv
+
+The summary gives, over all devices:
+- success rate: presses followed by a sense pin wake within --window seconds (before the next
+  press), for devices that log wakes;
+- recovery latency: seconds from such a press to the wake, as a histogram;
+- VLO drift: the calibrated frequency (the logged Q14 scale, 61 ppm a step, times the
+  ACLK_VLO_HZ of the boot records) and its trend in ppm per day, fitted within each boot
+  (the log has no time across boots).
+Wakes cannot be told apart by channel, so the first two are meant for one node per watcher.
+"""
+
+import argparse
+import csv
+import functools
+import mmap
+import multiprocessing
+import os
+import statistics
+import struct
+import sys
+
+import log_decode
+
+BOOT, PULSE, SENSE, CAL = 1, 2, 3, 4  # record types (src/log.h)
+BINS = [10, 30, 60, 120, 300, 600, 1800, 3600, 4 * 3600, 24 * 3600]  # upper bounds, s
+FIELDS = ["device", "records", "boots", "presses", "recovered", "success", "latency_median_s",
+          "vlo_hz", "drift_ppm_day", "error"]
+
+
+def read_bin(path):
+    """Log segments of a raw flash image."""
+    found = []
+    magic = struct.pack("<H", log_decode.MAGIC)
+    with open(path, "rb") as f:
+        size = os.fstat(f.fileno()).st_size
+        if size < log_decode.SEG_SIZE:
+            return found
+        with mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ) as mm:
+            for off in range(0, size - log_decode.SEG_SIZE + 1, log_decode.SEG_SIZE):
+                if mm[off:off + 2] == magic:
+                    found.append(log_decode.parse_segment(mm[off:off + log_decode.SEG_SIZE]))
+    return found
+
+
+def read_hex(path):
+    """Log segments of an Intel HEX dump, whatever its record length and alignment."""
+    return log_decode.segments(log_decode.load_hex(path))
+
+
+def drift(cal):
+    """VLO trend in ppm/day from (boot, t_s, Hz) samples, fitted within each boot."""
+    by_boot = {}
+    for boot, t, hz in cal:
+        by_boot.setdefault(boot, []).append((t, hz))
+    sxy = sxx = total = 0.0
+    for pts in by_boot.values():
+        tm = sum(t for t, _ in pts) / len(pts)
+        hm = sum(h for _, h in pts) / len(pts)
+        sxy += sum((t - tm) * (h - hm) for t, h in pts)
+        sxx += sum((t - tm) ** 2 for t, _ in pts)
+        total += hm * len(pts)
+    if not sxx:
+        return None
+    return sxy / sxx * 86400 / (total / len(cal)) * 1e6
+
+
+def analyze(path, window):
+    """Per-device statistics of one dump."""
+    row = {"device": os.path.splitext(os.path.basename(path))[0], "records": 0, "boots": 0,
+           "presses": 0, "recovered": 0, "wakes": 0, "latencies": [],
+           "vlo_hz": None, "drift": None}
+    cal = []
+    try:
+        segs = read_bin(path) if path.endswith(".bin") else read_hex(path)
+    except (OSError, ValueError) as e:
+        row["error"] = str(e)
+        return row
+    segs = log_decode.order([s for s in segs if s])
+    if not segs:
+        row["error"] = "no log"
+        return row
+    pressed = None
+    vlo_hz = log_decode.nominal_hz(segs)
+    for boot, t, kind, payload in log_decode.walk(segs):
+        row["records"] += 1
+        if kind == BOOT:
+            row["boots"] += 1
+            pressed = None
+        elif kind == PULSE:
+            row["presses"] += 1
+            pressed = t
+        elif kind == SENSE:
+            row["wakes"] += 1
+            if pressed is not None and t - pressed <= window:
+                row["recovered"] += 1
+                row["latencies"].append(t - pressed)
+            pressed = None
+        elif kind == CAL and payload:
+            cal.append((boot, t, payload * vlo_hz / 16384))
+    if cal:
+        row["vlo_hz"] = statistics.median(h for _, _, h in cal)
+        row["drift"] = drift(cal)
+    return row
+
+
+def histogram(latencies):
+    counts = [0] * (len(BINS) + 1)
+    for x in latencies:
+        counts[next((i for i, b in enumerate(BINS) if x <= b), len(BINS))] += 1
+    return counts
+
+
+def label(s):
+    return "%d s" % s if s < 60 else "%d min" % (s // 60) if s < 3600 else "%d h" % (s // 3600)
+
+
+def dumps(paths):
+    for p in paths:
+        if os.path.isdir(p):
+            for root, _, files in os.walk(p):
+                for name in sorted(files):
+                    if name.endswith((".bin", ".hex")):
+                        yield os.path.join(root, name)
+        else:
+            yield p
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("paths", nargs="+", help="dump files (.bin, .hex) or directories of them")
+    ap.add_argument("--window", type=int, default=3600,
+                    help="longest press to wake counted as a recovery, s (default: %(default)s)")
+    ap.add_argument("--csv", help="write per-device rows to this file")
+    ap.add_argument("-j", "--jobs", type=int, default=os.cpu_count(),
+                    help="worker processes (default: %(default)s)")
+    args = ap.parse_args()
+
+    devices = errors = presses = recovered = wakes = 0
+    hist = [0] * (len(BINS) + 1)
+    drifts, vlo = [], []
+    out = None
+    if args.csv:
+        f = open(args.csv, "w", newline="")
+        out = csv.DictWriter(f, FIELDS, extrasaction="ignore")
+        out.writeheader()
+    with multiprocessing.Pool(args.jobs) as pool:
+        work = functools.partial(analyze, window=args.window)
+        for row in pool.imap_unordered(work, dumps(args.paths), chunksize=64):
+            devices += 1
+            if "error" in row:
+                errors += 1
+            d, hz = row["drift"], row["vlo_hz"]
+            if d is not None:
+                drifts.append(d)
+            if hz is not None:
+                vlo.append(hz)
+            if row["wakes"]:
+                presses += row["presses"]
+                recovered += row["recovered"]
+                wakes += 1
+                for i, c in enumerate(histogram(row["latencies"])):
+                    hist[i] += c
+            if out:
+                row.update({
+                    "success": "%.3f" % (row["recovered"] / row["presses"])
+                               if row["wakes"] and row["presses"] else "",
+                    "latency_median_s": "%g" % statistics.median(row["latencies"])
+                                        if row["latencies"] else "",
+                    "vlo_hz": "%d" % hz if hz is not None else "",
+                    "drift_ppm_day": "%.1f" % d if d is not None else "",
+                })
+                out.writerow(row)
+    if out:
+        f.close()
+
+    print("devices %d, %d without a readable log" % (devices, errors))
+    if presses:
+        print("presses %d on %d devices that log wakes, %d (%.1f%%) followed by one within %d s"
+              % (presses, wakes, recovered, 100.0 * recovered / presses, args.window))
+    if recovered:
+        print("recovery latency")
+        lo = 0
+        for b, c in zip(BINS + [None], hist):
+            span = "%s..%s" % (label(lo), label(b)) if b else "> %s" % label(lo)
+            print("  %-16s %8d  %5.1f%%" % (span, c, 100.0 * c / recovered))
+            lo = b
+    if vlo:
+        print("VLO %d devices: median %d Hz, %d..%d Hz" % (len(vlo), statistics.median(vlo),
+                                                       min(vlo), max(vlo)))
+    if len(drifts) > 1:
+        q = statistics.quantiles(drifts, n=10)
+        print("VLO drift %d devices: median %.1f ppm/day, 10%%..90%% %.1f..%.1f ppm/day"
+              % (len(drifts), statistics.median(drifts), q[0], q[-1]))
+    return 1 if devices == errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,199 @@
+#!/bin/sh
+# Run the firmware for years of virtual time against the host model (src/host) across a matrix
+# of build configurations and VLO conditions. Every run must deliver each pulse exactly once on
+# every channel, without overlapping another channel's pattern (with liveness sensing: only once
+# the simulated node has gone quiet, then at the escalation gaps; with supply or rail
+# monitoring: also soon after the simulated supply or rail recovers; event-only: once per sense
+# edge or rail recovery outside the holdoff; with PULSE_BATCH, patterns may start together; with
+# a learned interval: within its bounds); exits non-zero if any run reports FAIL. Each line also
+# gives the charge drawn per day. The expander builds drive a rack of 36 nodes. The checkpoint
+# builds then run another month from the Info flash they saved, as after a power loss; the event
+# log builds keep theirs, which tools/log_decode.py must read back; the one with a single-record
+# batch drops records while the supply is low, and its decoded pulse times must still match the
+# model's. The console builds get
+# lines typed on their serial console, which must answer them; the log it dumps is decoded too.
+# The site block build gets a block from tools/conf_block.py with the VLO frequency of each
+# condition, and must follow its interval and width without a calibration. The strap build has
+# one strap to VCC and one to GND, must follow them, and must draw no current through them after
+# boot. Last, the default build must run ten years in under a second of host CPU.
+#
+#   tools/simulate.sh [days]        # default 3652 (10 years)
+#
+# CC, CFLAGS and the HOST_* variables of src/host/hal_host.c can be set from the environment.
+
+set -u
+
+DAYS=${1:-3652}
+CC=${CC:-cc}
+CFLAGS=${CFLAGS:--std=c11 -O2 -Wall -Wno-unknown-pragmas}
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+fail=0
+
+# name | build flags | environment of every run (optional)
+CONFIGS='default|
+tick|-DSCHED_TICKLESS=0
+outmod|-DPULSE_MODE=PULSE_MODE_OUTMOD -DPULSE_PIN_BIT=BIT6 -DDBG_PIN_BIT=BIT0
+delay|-DPULSE_MODE=PULSE_MODE_DELAY
+1h|-DPULSE_INTERVAL_MIN=60
+7min|-DPULSE_INTERVAL_MIN=7 -DPULSE_MS=100
+24h|-DPULSE_INTERVAL_MIN=1440 -DPULSE_MS=2000
+nocal|-DVLO_CAL_HOURS=0 -DTEMPCOMP_MIN=0
+batt|-DBATT_SAMPLE_MIN=5|HOST_DISCHARGE=3:2.0:20
+pgood|-DPGOOD_DELAY_S=30|HOST_RAIL=2:5
+pgood-on|-DPGOOD_DELAY_S=10 -DPGOOD_POLL_S=0 -DPGOOD_CA=6|HOST_RAIL=1.3:0.7
+sense|-DSENSE_TIMEOUT_MIN=30|HOST_HEARTBEAT=1.5:60:7
+sense-p2|-DSENSE_TIMEOUT_MIN=10 -DSENSE_PORT=2 -DSENSE_PIN_BIT=BIT3 -DSENSE_EDGE=SENSE_EDGE_FALLING|HOST_HEARTBEAT=2.3:20:1
+escalate|-DSENSE_TIMEOUT_MIN=30 -DESCALATE_GAP_MIN=5 -DESCALATE_MAX_MIN=120|HOST_HEARTBEAT=1.5:60:3:9
+adapt|-DPULSE_INTERVAL_MIN=1440 -DADAPT_MIN_MIN=60|HOST_HEARTBEAT=1.5:60:0.2
+ckpt|-DCKPT_MIN=10
+ckpt-bat|-DCKPT_MIN=10 -DBATT_SAMPLE_MIN=5|HOST_DISCHARGE=3:2.0:20
+batt-log|-DLOG_SEGS=2 -DBATT_SAMPLE_MIN=5|HOST_DISCHARGE=3:2.0:20
+ckpt-log|-DCKPT_MIN=10 -DLOG_SEGS=4 -DLOG_BATCH=8 -DSENSE_TIMEOUT_MIN=30|HOST_HEARTBEAT=1.5:60:7
+lost-log|-DLOG_SEGS=2 -DLOG_BATCH=1 -DBATT_SAMPLE_MIN=5 -DPULSE_INTERVAL_MIN=60|HOST_DISCHARGE=3:2.0:20
+chans|-DPULSE_CHANNELS(X)=X(BIT4,720,0,1)X(BIT5,720,0,5)X(BIT6,360,90,0x0F)X(BIT7,720,360,0x15)
+chans-dl|-DPULSE_MODE=PULSE_MODE_DELAY -DPULSE_CHANNELS(X)=X(BIT4,720,0,1)X(BIT5,720,0,5)
+event|-DEVENT_ONLY=EVENT_SENSE -DEVENT_HOLDOFF_S=600|HOST_HEARTBEAT=1.5:500
+event-pg|-DEVENT_ONLY=EVENT_PGOOD -DPGOOD_DELAY_S=10 -DPGOOD_CA=6|HOST_RAIL=1.3:0.7
+gesture|-DPULSE_PATTERN=GESTURE_LONG
+gest-om|-DPULSE_MODE=PULSE_MODE_OUTMOD -DPULSE_PIN_BIT=BIT6 -DDBG_PIN_BIT=BIT0 -DPULSE_PATTERN=GESTURE_TRIPLE
+gest-ch|-DPULSE_CHANNELS(X)=X(BIT4,720,0,GESTURE_DOUBLE)X(BIT5,720,0,GESTURE_LONG)X(BIT6,360,90,GESTURE_TRIPLE)X(BIT7,720,360,0x05)
+chans-b|-DPULSE_BATCH=2 -DPULSE_CHANNELS(X)=X(BIT4,720,0,1)X(BIT5,720,0,5)X(BIT6,360,90,0x0F)X(BIT7,720,360,0x15)
+ckpt-ch|-DCKPT_MIN=5 -DPULSE_CHANNELS(X)=X(BIT4,720,0,1)X(BIT5,720,0,5)X(BIT6,360,90,0x0F)X(BIT7,720,360,0x15)
+console|-DCONSOLE_BAUD=9600 -DLOG_SEGS=2|HOST_CONSOLE=60:;62:s;64:i60;66:w300;68:l;200000:;200002:s;200004:i720;200006:l
+con-soft|-DCONSOLE_BAUD=9600 -DCONSOLE_SOFT=1 -DSENSE_TIMEOUT_MIN=30|HOST_HEARTBEAT=1.5:60:7 HOST_CONSOLE=60:s;62:w200;100000:s
+conf|-DCONF_BLOCK=1 -DVLO_CAL_HOURS=0 -DTEMPCOMP_MIN=0
+strap|-DSTRAP_INTERVAL_BIT=BIT3 -DSTRAP_WIDTH_BIT=BIT4|HOST_STRAPS=2.3:H,2.4:L'
+
+# A rack of 36 nodes on expander lines 0..35: four interval/pattern kinds, three phases, so a
+# dozen fall due at once
+RACK=''
+i=0
+while [ $i -lt 36 ]; do
+    set -- 720:1 360:5 240:0x0F 720:0x15
+    shift $((i % 4))
+    RACK="${RACK}X($i,${1%:*},$((i % 3 * 60)),${1#*:})"
+    i=$((i + 1))
+done
+CONFIGS="$CONFIGS
+595|-DPULSE_OUT=PULSE_OUT_595 -DEXP_COUNT=5 -DPULSE_CHANNELS(X)=$RACK
+pcf8574|-DPULSE_OUT=PULSE_OUT_PCF8574 -DEXP_COUNT=5 -DPULSE_CHANNELS(X)=$RACK"
+
+# name | environment
+CONDITIONS='nominal|
+slow|HOST_VLO_HZ=4000
+fast|HOST_VLO_HZ=20000
+swing|HOST_VLO_TC=-3000 HOST_TEMP_SWING=15'
+
+echo "$CONFIGS" | while IFS='|' read -r name flags cfgenv; do
+    # shellcheck disable=SC2086
+    if ! $CC $CFLAGS $flags "$ROOT"/src/*.c "$ROOT"/src/host/*.c -lm -o "$OUT/$name"; then
+        echo "$name: build failed"
+        exit 1
+    fi
+    echo "$CONDITIONS" | while IFS='|' read -r cond env; do
+        case "$name:$cond" in
+        nocal:slow | nocal:fast) continue ;; # uncalibrated: the interval follows the VLO
+        esac
+        info=
+        case "$name" in
+        ckpt* | *log) info="$OUT/info.hex" ;;
+        esac
+        term= want= # the console transcript, and its answer to the last setting
+        block= site= # the site block, and the settings the run must report taking
+        case "$name" in
+        console) term="$OUT/term" want='^interval 720 min' ;;
+        con-soft) term="$OUT/term" want='^width 200 ms' ;;
+        conf)
+            block="$OUT/conf.hex" site='^site .* 90 min, width 250 ms'
+            vlo=$(echo "$env" | sed -n 's/.*HOST_VLO_HZ=\([0-9]*\).*/\1/p')
+            python3 "$ROOT"/tools/conf_block.py --interval 90 --width 250 \
+                --vlo-hz "${vlo:-11805}" -o "$block"
+            ;;
+        strap) site='^straps .* 360 min, width 250 ms' ;;
+        esac
+        # shellcheck disable=SC2086
+        if env $cfgenv $env HOST_DAYS="$DAYS" HOST_PULSES=0 ${info:+HOST_INFO_OUT="$info"} \
+            ${term:+HOST_CONSOLE_OUT="$term"} ${block:+HOST_INFO="$block"} "$OUT/$name" \
+            >"$OUT/log" 2>&1; then
+            result=PASS
+        else
+            result=FAIL
+        fi
+        # shellcheck disable=SC2086
+        if [ -n "$info" ] && [ "$result" = PASS ] && ! env $cfgenv $env HOST_DAYS=30 HOST_PULSES=0 \
+            HOST_INFO="$info" "$OUT/$name" >>"$OUT/log" 2>&1; then
+            result=FAIL
+        fi
+        case "$name" in
+        *log) dump="$info" ;;
+        console) dump="$term" ;; # the "l" command's
+        *) dump= ;;
+        esac
+        if [ -n "$dump" ] && ! python3 "$ROOT"/tools/log_decode.py "$dump" >/dev/null 2>>"$OUT/log"
+        then
+            result=FAIL
+        fi
+        if [ "$name" = lost-log ]; then
+            # Five days with a line per pulse, short enough that the two segments still hold the
+            # boot record the times count from: each pulse in the decoded log must fall on the
+            # next of the model's, within a quarter of the hourly interval (the swinging VLO
+            # strays ~600 s, a dropped gap is a whole interval), and the last on the last.
+            # Records must have been dropped.
+            # shellcheck disable=SC2086
+            env $cfgenv $env HOST_DAYS=5 HOST_INFO_OUT="$OUT/lost.hex" "$OUT/$name" \
+                >"$OUT/pulses" 2>&1
+            python3 "$ROOT"/tools/log_decode.py "$OUT/lost.hex" >"$OUT/lost.csv" 2>>"$OUT/log"
+            if ! awk -F, 'FNR == NR { split($0, f, " "); if (/^pulse /) t[n++] = f[3]; next }
+                $3 == "boot" { boot = 1 }
+                $3 == "lost" { lost = 1 }
+                $3 == "pulse" {
+                    for (i = k++ ? last + 1 : 0; i < n && t[i] < $2 - 900; i++)
+                        ;
+                    if (i == n || t[i] > $2 + 900) {
+                        print "    log: no pulse at " $2 " s"
+                        bad = 1
+                    }
+                    last = i
+                }
+                END { exit bad || !boot || !lost || last != n - 1 }' "$OUT/pulses" "$OUT/lost.csv" \
+                >>"$OUT/log"; then
+                result=FAIL
+            fi
+        fi
+        if [ -n "$term" ] && ! grep -q "$want" "$term"; then
+            sed 's/^/    console: /' "$term" >>"$OUT/log"
+            result=FAIL
+        fi
+        if [ -n "$site" ] && ! grep -q "$site" "$OUT/log"; then
+            result=FAIL
+        fi
+        if ! awk '$1 == "straps" && $3 == "s" && $2 > 0 { exit 1 }' "$OUT/log"; then
+            result=FAIL # a strap pin left driven or pulled against its tie
+        fi
+        printf '%-8s %-8s %s  %s; %s uAh/day (G2553, G2452)\n' "$name" "$cond" "$result" \
+            "$(grep -m 1 '^pulses' "$OUT/log")" \
+            "$(awk '$1 == "total" { print $3 ", " $4; exit }' "$OUT/log")"
+        if [ "$result" = FAIL ]; then
+            sed 's/^/    /' "$OUT/log"
+        fi
+    done
+done | tee "$OUT/summary"
+
+grep -q ' FAIL ' "$OUT/summary" && fail=1
+grep -q 'build failed' "$OUT/summary" && fail=1
+
+# Ten years of the default build in well under a second of host CPU (the "run" line), the best
+# of three runs against a loaded machine
+if [ -x "$OUT/default" ]; then
+    cpu=$(for i in 1 2 3; do
+        HOST_DAYS=3652 HOST_PULSES=0 "$OUT/default" 2>/dev/null | awk '$1 == "run" { print $5 }'
+    done | sort -n | head -n 1)
+    result=PASS
+    awk -v s="${cpu:-99}" 'BEGIN { exit s >= 1 }' || result=FAIL fail=1
+    echo "timing   default  $result  3652 days in ${cpu:-?} s host CPU"
+fi
+
+exit $fail
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+"""Build the VLO temperature compensation table (src/tempcomp.h) for Info segment D.
+
+Input is a CSV of bench measurements, one row per temperature, with a header naming the
+columns: either ``code,vlo_hz`` (ADC10 INCH_10 readings against the 1.5 V reference) or
+``temp_c,vlo_hz`` (converted with the datasheet sensor curve, 3.55 mV/degC, 986 mV at 0 degC).
+The measurements are resampled onto an evenly spaced code grid and written as Intel HEX:
+
+    tools/tempcomp_table.py bench.csv -o tempcomp.hex
+    mspdebug rf2500 "erase segment 0x1000" "load tempcomp.hex"
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+TABLE_ADDR = 0x1000
+MAGIC = 0x5443
+MAX_ENTRIES = 16
+Q14 = 16384
+ACLK_VLO_HZ = 11805  # keep in step with src/config.h
+
+
+def temp_to_code(temp_c):
+    """ADC10 code of the internal sensor at temp_c, 1.5 V reference."""
+    return (0.00355 * temp_c + 0.986) / 1.5 * 1023
+
+
+def load(path):
+    with open(path, newline="") as f:
+        rows = list(csv.DictReader(f))
+    points = []
+    for row in rows:
+        if "code" in row:
+            code = float(row["code"])
+        else:
+            code = temp_to_code(float(row["temp_c"]))
+        points.append((code, float(row["vlo_hz"])))
+    if len(points) < 2:
+        sys.exit("need at least two measurements")
+    return sorted(points)
+
+
+def interpolate(points, code):
+    if code <= points[0][0]:
+        return points[0][1]
+    for (c0, f0), (c1, f1) in zip(points, points[1:]):
+        if code <= c1:
+            return f0 + (f1 - f0) * (code - c0) / (c1 - c0)
+    return points[-1][1]
+
+
+def build(points, vlo_hz):
+    first = int(points[0][0])
+    span = points[-1][0] - first
+    step_log2 = 0
+    while step_log2 < 8 and (MAX_ENTRIES - 1) << step_log2 < span:
+        step_log2 += 1
+    count = min(MAX_ENTRIES, int(span) // (1 << step_log2) + 2)
+    factors = [round(interpolate(points, first + (i << step_log2)) / vlo_hz * Q14)
+               for i in range(count)]
+    factors += [0xFFFF] * (MAX_ENTRIES - count)
+    return struct.pack("<HHBB%dH" % MAX_ENTRIES, MAGIC, first, step_log2, count, *factors)
+
+
+def intel_hex(data, addr):
+    lines = []
+    for off in range(0, len(data), 16):
+        chunk = data[off:off + 16]
+        rec = bytes([len(chunk), (addr + off) >> 8, (addr + off) & 0xFF, 0]) + chunk
+        lines.append(":%s%02X" % (rec.hex().upper(), -sum(rec) & 0xFF))
+    lines.append(":00000001FF")
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("csv", help="bench measurements (code|temp_c, vlo_hz)")
+    ap.add_argument("-o", "--output", help="Intel HEX file (default: stdout)")
+    ap.add_argument("--vlo-hz", type=float, default=ACLK_VLO_HZ,
+                    help="ACLK_VLO_HZ of the firmware build (default: %(default)s)")
+    args = ap.parse_args()
+
+    text = intel_hex(build(load(args.csv), args.vlo_hz), TABLE_ADDR)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+
+
+if __name__ == "__main__":
+    main()